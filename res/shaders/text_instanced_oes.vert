@@ -0,0 +1,38 @@
+#version 300 es
+precision highp float;
+precision highp int;
+
+layout(location = 0) in vec2 iPosition;
+layout(location = 1) in uvec2 iGlyph; //Glyph index, scale in 8.8 fixed point
+layout(location = 2) in vec4 iColor;
+
+uniform mat4 uMVP;
+uniform vec2 uOrigin; //Added to every glyph's position, used by retained text runs
+uniform vec4 uGlyphSize; //Glyph width and height, inverse atlas width and height
+uniform vec4 uGlyphGeometry[64]; //Horizontal offset and width, two glyphs per element
+
+out vec2 vTexCoord;
+out vec4 vColor;
+
+void main() {
+	
+	uint glyph = iGlyph.x;
+	float scale = float(iGlyph.y) / 256.;
+
+	vec4 pair = uGlyphGeometry[glyph >> 1u];
+	vec2 geometry = (glyph & 1u) == 0u ? pair.xy : pair.zw;
+
+	//Same corner order as the index buffer of the non-instanced path
+	vec2 corner = vec2(float(gl_VertexID >> 1), float(gl_VertexID & 1));
+
+	vec2 cell = vec2(float(glyph & 15u), float(glyph >> 4u)) * uGlyphSize.xy;
+	vec2 uv0 = vec2(cell.x + geometry.x, cell.y);
+	vec2 uv1 = vec2(cell.x + geometry.x + geometry.y + 1., cell.y + uGlyphSize.y - 1.);
+
+	vec2 size = vec2(geometry.y + 1., uGlyphSize.y) * scale;
+	vec2 position = uOrigin + iPosition + vec2(geometry.x * scale, 0.) + size * corner;
+
+	vTexCoord = mix(uv0, uv1, corner) * uGlyphSize.zw;
+	vColor = iColor;
+	gl_Position = uMVP * vec4(position, 0., 1.);
+}
@@ -0,0 +1,21 @@
+#version 300 es
+precision highp float;
+
+uniform sampler2D uTexture0;
+
+in vec2 vTexCoord;
+in vec4 vColor;
+
+layout(location = 0) out vec4 ResultColor;
+
+//Atlases made with smol_gl_font_create_sdf hold the distance to the glyph's edge in alpha, the edge being at .5
+void main() {
+
+	float d = texture(uTexture0, vTexCoord).a;
+
+	//Antialias over about a screen pixel, whatever the text's scale is
+	float w = max(fwidth(d) * .5, 1. / 255.);
+
+	ResultColor.rgb = vColor.rgb;
+	ResultColor.a = vColor.a*smoothstep(.5 - w, .5 + w, d);
+}
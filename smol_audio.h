@@ -1169,13 +1169,13 @@ smol_u32 smol_wav_dec_decode_frames(smol_wav_dec_t* dec, float* output, smol_siz
 smol_audiobuffer_t smol_create_audiobuffer_from_qoa_file(const char* filepath) {
 
 	smol_audiobuffer_t buffer = { 0 };
-	smol_size_t size;
-	const void* data = smol_read_entire_file(filepath, &size);
+	smol_file_view_t view;
 
-	if(!data)
+	if(!smol_map_file(filepath, &view))
 		return buffer;
 
-	smol_audio_dec_t qoa_dec = smol_qoa_dec_init((const smol_byte*)data, size).decoder;
+	smol_file_view_advise(&view, 0, 0, SMOL_FILE_VIEW_HINT_SEQUENTIAL);
+	smol_audio_dec_t qoa_dec = smol_qoa_dec_init((const smol_byte*)view.data, view.size).decoder;
 	
 	
 	{
@@ -1194,7 +1194,7 @@ smol_audiobuffer_t smol_create_audiobuffer_from_qoa_file(const char* filepath) {
 			num_samples -= n, buf += n*qoa_dec.num_channels
 		);
 
-		free(data);
+		smol_unmap_file(&view);
 	}
 
 	return buffer;
@@ -1204,15 +1204,15 @@ smol_audiobuffer_t smol_create_audiobuffer_from_qoa_file(const char* filepath) {
 smol_audiobuffer_t smol_create_audiobuffer_from_wav_file(const char* filepath) {
 
 	smol_audiobuffer_t buffer = { 0 };
-	smol_size_t size;
-	const void* data = smol_read_entire_file(filepath, &size);
+	smol_file_view_t view;
 
-	if(!data) {
-		fputs(stderr, "Can't create audiobuffer from wav file!");
+	if(!smol_map_file(filepath, &view)) {
+		fputs("Can't create audiobuffer from wav file!", stderr);
 		return buffer;
 	}
 
-	smol_wav_dec_t wav_dec = smol_wav_dec_init(data, size);
+	smol_file_view_advise(&view, 0, 0, SMOL_FILE_VIEW_HINT_SEQUENTIAL);
+	smol_wav_dec_t wav_dec = smol_wav_dec_init((const smol_byte*)view.data, view.size);
 	smol_audio_dec_t* dec = &wav_dec.decoder;
 	{
 		buffer.num_frames = dec->num_frames;
@@ -1230,7 +1230,7 @@ smol_audiobuffer_t smol_create_audiobuffer_from_wav_file(const char* filepath) {
 			num_samples -= n, buf += n*dec->num_channels
 		);
 
-		free(data);
+		smol_unmap_file(&view);
 	}
 	
 	return buffer;
@@ -137,8 +137,21 @@ typedef struct _smol_image_t {
 	void(*free_func)(void*); //This is optional, smol_image_destroy will call this, if images it's set
 	smol_u32 width;
 	smol_u32 height;
+	struct _smol_image_mips_t* mips; //This is optional, built by smol_image_build_mips and freed by smol_image_destroy
 } smol_image_t;
 
+//Maximum number of mip levels below the image, enough for 32767 pixels
+#ifndef SMOL_IMAGE_MAX_MIPS
+#	define SMOL_IMAGE_MAX_MIPS 15
+#endif 
+
+//Mip chain of an image, level i is the image box filtered down by 2^(i+1), odd sizes round up
+typedef struct _smol_image_mips_t {
+	smol_image_t levels[SMOL_IMAGE_MAX_MIPS];
+	int num_levels;
+	smol_u32 stamp; //Changes every time the chain is built, cached scaled images are keyed by it
+} smol_image_mips_t;
+
 //Contains data for horizontal spacing of a glyph
 typedef struct _smol_font_hor_geometry_t {
 	char offset_x;
@@ -151,14 +164,178 @@ typedef struct _smol_font_t {
 	int glyph_width;
 	int glyph_height;
 	smol_font_hor_geometry_t* geometry;
+	const smol_u32* rows; //Optional 1bpp glyphs, glyph_height rows per glyph with bit x set when pixel x is lit (see smol_font_pack_rows)
 } smol_font_t;
 
+//Header of a precompiled binary font (.pxb), all fields are little endian. It's followed by
+//num_glyphs smol_font_hor_geometry_t entries at geometry_offset (0 if the font is monospaced) and by
+//num_glyphs * glyph_height smol_u32 rows at rows_offset, bit x of a row being pixel x of the glyph.
+typedef struct _smol_pxb_header_t {
+	char magic[4]; //"PXB1"
+	smol_u16 glyph_width;
+	smol_u16 glyph_height;
+	smol_u32 num_glyphs;
+	smol_u32 geometry_offset;
+	smol_u32 rows_offset;
+	smol_u32 file_size;
+	smol_u32 reserved[2];
+} smol_pxb_header_t;
+
 #ifdef __cplusplus
-#define smol_create_font(glyphs, glyph_width, glyph_height, geometry) smol_font_t{ glyphs, glyph_width, glyph_height, geometry }
+#define smol_create_font(glyphs, glyph_width, glyph_height, geometry) smol_font_t{ glyphs, glyph_width, glyph_height, geometry, NULL }
 #else 
-#define smol_create_font(glyphs, glyph_width, glyph_height, geometry) (smol_font_t){ glyphs, glyph_width, glyph_height, geometry }
+#define smol_create_font(glyphs, glyph_width, glyph_height, geometry) (smol_font_t){ glyphs, glyph_width, glyph_height, geometry, NULL }
+#endif 
+
+//A single laid out glyph of a text run, coordinates are relative to the run's origin
+typedef struct _smol_text_glyph_t {
+	int x;
+	int y;
+	int width;    //Width of the glyph in pixels, scale included
+	int source_x; //Horizontal offset into the glyph, scale included
+	int glyph;    //Index of the glyph in the font
+} smol_text_glyph_t;
+
+//A text laid out once for a font and a scale, can be drawn any number of times
+typedef struct _smol_text_run_t {
+	const smol_font_t* font;
+	int scale;
+	smol_u32 hash;
+	char* text;
+	int text_capacity;
+	smol_text_glyph_t* glyphs;
+	int num_glyphs;
+	int glyph_capacity;
+	int width;
+	int height;
+} smol_text_run_t;
+
+//Metrics of a glyph rasterized for the glyph cache
+typedef struct _smol_glyph_metrics_t {
+	int width;    //Width of the glyph's bitmap
+	int height;   //Height of the glyph's bitmap
+	int offset_x; //Offset from the pen position to the bitmap's left edge
+	int offset_y; //Offset from the top of the line to the bitmap's top edge
+	int advance;  //How much the pen moves after the glyph
+} smol_glyph_metrics_t;
+
+//Rasterizes a codepoint for the glyph cache, one coverage byte per pixel with pitch bytes per row, 
+//at most max_width x max_height pixels. Returns 0 when there's no glyph for the codepoint.
+typedef int(*smol_glyph_source_proc)(void* user_data, smol_u32 codepoint, smol_u8* pixels, int pitch, int max_width, int max_height, smol_glyph_metrics_t* metrics);
+
+//A glyph packed into a page of the glyph cache
+typedef struct _smol_glyph_entry_t {
+	smol_u32 codepoint;
+	smol_u16 page; //SMOL_GLYPH_NO_PAGE for glyphs without pixels, like space
+	smol_u16 x;
+	smol_u16 y;
+	smol_u16 width;
+	smol_u16 height;
+	smol_i16 offset_x;
+	smol_i16 offset_y;
+	smol_i16 advance;
+	int next; //Next entry in the same hash bucket, or in the free list
+} smol_glyph_entry_t;
+
+#define SMOL_GLYPH_NO_PAGE 0xFFFF
+
+typedef struct _smol_skyline_node_t {
+	smol_u16 x;
+	smol_u16 y;
+	smol_u16 width;
+} smol_skyline_node_t;
+
+//An atlas page of the glyph cache
+typedef struct _smol_glyph_page_t {
+	smol_u8* pixels; //page_size * page_size coverage bytes
+	smol_skyline_node_t* skyline;
+	int num_nodes;
+	smol_u32 last_used; //The cache's clock when a glyph of this page was last fetched
+	int dirty_x0, dirty_y0, dirty_x1, dirty_y1; //Area changed since the page was last uploaded, empty when x0 >= x1
+} smol_glyph_page_t;
+
+//Caches glyphs by codepoint into atlas pages, the least recently used page is evicted when all of them are full
+typedef struct _smol_glyph_cache_t {
+	int page_size;
+	int max_pages;
+	int num_pages;
+	int cell_width;  //Largest glyph the source may rasterize
+	int cell_height; //Also the line height
+	smol_glyph_page_t* pages;
+	smol_glyph_entry_t* entries;
+	int num_entries;
+	int entry_capacity;
+	int free_entry;
+	int* buckets;
+	int num_buckets;
+	smol_u32 clock;
+	smol_u8* scratch;
+	smol_glyph_source_proc source;
+	void* source_data;
+	void(*evict_func)(void* user_data, int page); //Called before a page is cleared, e.g. to draw batches still sampling it
+	void* evict_data;
+} smol_glyph_cache_t;
+
+//Number of text runs smol_canvas_draw_text caches, the runs are cached by the hash of the text, font and scale
+#ifndef SMOL_CANVAS_TEXT_RUN_CACHE_SIZE
+#	define SMOL_CANVAS_TEXT_RUN_CACHE_SIZE 64
+#endif 
+
+//Number of downscaled images smol_canvas_draw_image_subrect_streched keeps for images with mips, the least recently used gets replaced
+#ifndef SMOL_CANVAS_SCALED_IMAGE_CACHE_SIZE
+#	define SMOL_CANVAS_SCALED_IMAGE_CACHE_SIZE 16
 #endif 
 
+//Largest downscaled image in pixels, that smol_canvas_draw_image_subrect_streched caches
+#ifndef SMOL_CANVAS_SCALED_IMAGE_MAX_PIXELS
+#	define SMOL_CANVAS_SCALED_IMAGE_MAX_PIXELS (256 * 256)
+#endif 
+
+//Rows per band of the batched primitives, items are binned by the bands they touch and drawn band by band
+#ifndef SMOL_CANVAS_BATCH_BAND_HEIGHT
+#	define SMOL_CANVAS_BATCH_BAND_HEIGHT 32
+#endif 
+
+//An item of smol_canvas_fill_rects, same as the arguments of smol_canvas_fill_rect
+typedef struct _smol_canvas_rect_t {
+	int x;
+	int y;
+	int w;
+	int h;
+} smol_canvas_rect_t;
+
+//An item of smol_canvas_draw_lines
+typedef struct _smol_canvas_line_t {
+	int x0;
+	int y0;
+	int x1;
+	int y1;
+} smol_canvas_line_t;
+
+//An item of smol_canvas_fill_circles
+typedef struct _smol_canvas_circle_t {
+	int xc;
+	int yc;
+	int rad;
+} smol_canvas_circle_t;
+
+//A vertex of smol_canvas_fill_polygon and smol_canvas_fill_path, pixel (x, y) covers [x, x + 1) x [y, y + 1)
+typedef struct _smol_canvas_point_t {
+	float x;
+	float y;
+} smol_canvas_point_t;
+
+typedef enum {
+	SMOL_FILL_EVEN_ODD    = 0x00000000U, //Inside where a ray crosses the outline an odd number of times
+	SMOL_FILL_NONZERO     = 0x00000001U, //Inside where the outline winds around the point at all
+	SMOL_FILL_ANTIALIASED = 0x00000002U  //Edges get their exact area coverage instead of sampling the pixel centers
+} smol_fill_flags;
+
+typedef enum {
+	SMOL_IMAGE_FILTER_NEAREST  = 0x00000000U, //Takes the texel the pixel center lands in
+	SMOL_IMAGE_FILTER_BILINEAR = 0x00000001U  //Weighs the four texels nearest to the pixel center
+} smol_image_filter;
+
 //The pixel blending render_callback type
 typedef smol_pixel_t(*smol_pixel_blend_func_proc)(smol_pixel_t, smol_pixel_t, smol_u32, smol_u32);
 
@@ -210,9 +387,63 @@ SMOL_INLINE smol_pixel_t smol_hsva(smol_u16 hue, smol_byte sat, smol_byte val, s
 
 }
 
+//smol_premultiply - Multiplies the color channels of a straight alpha pixel by its alpha
+// Arguments:
+// smol_pixel_t color -- The straight alpha color
+//Returns: smol_pixel_t - The premultiplied color
+SMOL_INLINE smol_pixel_t smol_premultiply(smol_pixel_t color) {
+	color.r = (smol_u8)((color.r * color.a + 127) / 255);
+	color.g = (smol_u8)((color.g * color.a + 127) / 255);
+	color.b = (smol_u8)((color.b * color.a + 127) / 255);
+	return color;
+}
+
+//smol_unpremultiply - Divides the color channels of a premultiplied pixel by its alpha
+// Arguments:
+// smol_pixel_t color -- The premultiplied color
+//Returns: smol_pixel_t - The straight alpha color, fully transparent pixels become transparent black
+SMOL_INLINE smol_pixel_t smol_unpremultiply(smol_pixel_t color) {
+	if(color.a == 0)
+		return color;
+	smol_u32 r = (color.r * 255 + color.a / 2) / color.a;
+	smol_u32 g = (color.g * 255 + color.a / 2) / color.a;
+	smol_u32 b = (color.b * 255 + color.a / 2) / color.a;
+	color.r = (smol_u8)(r > 255 ? 255 : r);
+	color.g = (smol_u8)(g > 255 ? 255 : g);
+	color.b = (smol_u8)(b > 255 ? 255 : b);
+	return color;
+}
+
 
 smol_font_t* smol_load_default_font();
 
+//smol_font_pack_rows - Packs the byte per pixel glyphs of a font into 1bpp rows, text is drawn from those a lot faster
+// Arguments:
+// - smol_font_t* font -- The font, its glyph_width has to be 32 or less
+//Returns: int - 1 if the rows were packed, 0 if the glyphs are too wide or there are no glyphs. Free with smol_font_free_rows.
+int smol_font_pack_rows(smol_font_t* font);
+
+//smol_font_free_rows - Frees the rows packed by smol_font_pack_rows
+// Arguments:
+// - smol_font_t* font -- The font
+void smol_font_free_rows(smol_font_t* font);
+
+//smol_font_from_pxb - Sets up a font from precompiled binary font data, nothing is parsed or copied so the data has to outlive the font
+// Arguments:
+// - const void* data -- The .pxb data, e.g. a file read or mapped to memory, has to be 4 byte aligned
+// - smol_size_t size -- Size of the data in bytes
+// - smol_font_t* font -- The font to be set up, the glyphs are only available as rows
+//Returns: int - 1 on success, 0 if the data isn't a valid .pxb font
+int smol_font_from_pxb(const void* data, smol_size_t size, smol_font_t* font);
+
+//smol_font_load_pxb - Loads a precompiled binary font from a file with a single read. With smol_utils.h the file 
+//can be mapped with smol_map_file instead and the view's data passed straight to smol_font_from_pxb.
+// Arguments:
+// - const char* path -- Path to the .pxb file
+// - smol_font_t* font -- The font to be set up
+//Returns: void* - The file data the font points to, free it with SMOL_FREE after the font isn't used anymore. NULL on failure.
+void* smol_font_load_pxb(const char* path, smol_font_t* font);
+
 //smol_image_create_advanced - Creates an image, allocates buffer if no buffer is provided. Clears also the newly allocated buffer with color.
 // Arguments:
 // - smol_u32 width       -- Width of the new pixel buffer, or or existing one
@@ -252,6 +483,28 @@ void smol_image_blend_pixel(smol_image_t* img, smol_u32 x, smol_u32 y, smol_pixe
 //Returns: smol_pixel_t containing the color within the image
 smol_pixel_t smol_image_getpixel(smol_image_t* img, smol_u32 x, smol_u32 y);
 
+//smol_image_build_mips - Builds the mip chain of an image, downscaled draws of the image then sample the closest level.
+//                        Build it again after the pixels have changed, it also invalidates the cached scaled images.
+// Arguments:
+// - smol_image_t* image -- Pointer to the image
+//Returns: int - The number of levels below the image
+int smol_image_build_mips(smol_image_t* image);
+
+//smol_image_free_mips - Frees the mip chain of an image, if it has one
+// Arguments:
+// - smol_image_t* image -- Pointer to the image
+void smol_image_free_mips(smol_image_t* image);
+
+//smol_image_premultiply - Converts the pixels of an image from straight to premultiplied alpha, e.g. right after loading it for a premultiplied canvas
+// Arguments:
+// - smol_image_t* image -- Pointer to the image
+void smol_image_premultiply(smol_image_t* image);
+
+//smol_image_unpremultiply - Converts the pixels of an image from premultiplied to straight alpha
+// Arguments:
+// - smol_image_t* image -- Pointer to the image
+void smol_image_unpremultiply(smol_image_t* image);
+
 //smol_canvas_create - Creates a new canvas 
 // Arguments:
 // - smol_u32 width  -- Width of the canvas
@@ -337,6 +590,16 @@ void smol_canvas_push_blend(smol_canvas_t* canvas);
 // - smol_canvas_t* canvas -- A pointer to the canvas
 void smol_canvas_pop_blend(smol_canvas_t* canvas);
 
+//smol_canvas_set_premultiplied - Switches the canvas between straight and premultiplied alpha. The surface and the color stack are converted,
+//                                and smol_pixel_blend_mix becomes smol_pixel_blend_over_premultiplied (and back) in the blend stack.
+//                                Colors given to the canvas stay straight alpha and get premultiplied when set, images drawn into
+//                                a premultiplied canvas should be converted once with smol_image_premultiply.
+//                                Presenting needs no conversion, premultiplied pixels are already composited over black.
+// Arguments:
+// - smol_canvas_t* canvas -- A pointer to the canvas
+// - int premultiplied     -- Nonzero for premultiplied alpha
+void smol_canvas_set_premultiplied(smol_canvas_t* canvas, int premultiplied);
+
 //smol_canvas_set_font - Sets the current font for the canvas
 // Arguments:
 // - smol_canvas_t* canvas -- The target canvas
@@ -371,6 +634,48 @@ void smol_canvas_set_scissor(smol_canvas_t* canvas, int x, int y, int w, int h);
 // - int h
 void smol_cavas_set_scissor_cascaded(smol_canvas_t* canvas, int x, int y, int w, int h);
 
+//smol_canvas_set_transform - Sets the current transform of the canvas, it maps image space into canvas space
+// Arguments:
+// - smol_canvas_t* canvas      -- A pointer to the canvas
+// - const smol_m3_t* transform -- Row major affine matrix, the translation is in m[2] and m[5]
+void smol_canvas_set_transform(smol_canvas_t* canvas, const smol_m3_t* transform);
+
+//smol_canvas_apply_transform - Multiplies the current transform by another one, which gets applied first
+// Arguments:
+// - smol_canvas_t* canvas      -- A pointer to the canvas
+// - const smol_m3_t* transform -- Row major affine matrix
+void smol_canvas_apply_transform(smol_canvas_t* canvas, const smol_m3_t* transform);
+
+//smol_canvas_translate - Translates the current transform
+// Arguments:
+// - smol_canvas_t* canvas -- A pointer to the canvas
+// - float x               -- Offset on X-axis
+// - float y               -- Offset on Y-axis
+void smol_canvas_translate(smol_canvas_t* canvas, float x, float y);
+
+//smol_canvas_rotate - Rotates the current transform around its origin
+// Arguments:
+// - smol_canvas_t* canvas -- A pointer to the canvas
+// - float angle           -- Angle in radians, clockwise on screen
+void smol_canvas_rotate(smol_canvas_t* canvas, float angle);
+
+//smol_canvas_scale - Scales the current transform
+// Arguments:
+// - smol_canvas_t* canvas -- A pointer to the canvas
+// - float x               -- Scale on X-axis
+// - float y               -- Scale on Y-axis
+void smol_canvas_scale(smol_canvas_t* canvas, float x, float y);
+
+//smol_canvas_push_transform - Pushes the current transform into the transform stack
+// Arguments:
+// - smol_canvas_t* canvas -- A pointer to the canvas
+void smol_canvas_push_transform(smol_canvas_t* canvas);
+
+//smol_canvas_pop_transform - Pops the current transform from the t of the transform stack
+// Arguments:
+// - smol_canvas_t* canvas -- A pointer to the canvas
+void smol_canvas_pop_transform(smol_canvas_t* canvas);
+
 //smol_canvas_draw_pixel - Draws a pixel into the canvas with current color
 // Arguments:
 // - smol_canvas_t* canvas -- A pointer to the canvas
@@ -394,7 +699,9 @@ void smol_canvas_draw_line(smol_canvas_t* canvas, int x0, int y0, int x1, int y1
 // - int y0                -- Line starting point on Y-Axis
 // - int x1                -- Line ending point on X-Axis
 // - int y1                -- Line ending point on Y-Axis
-void smol_canvas_draw_arrow(smol_canvas_t* canvas, int x0, int y0, int x1, int y1, int tip_size);
+// - int tip_width         -- Length of the tip along the line
+// - int tip_height        -- Half of the tip's width across the line
+void smol_canvas_draw_arrow(smol_canvas_t* canvas, int x0, int y0, int x1, int y1, int tip_width, int tip_height);
 
 //smol_canvas_draw_image - Draws image into the canvas 
 // Arguments:
@@ -418,6 +725,24 @@ void smol_canvas_draw_image(smol_canvas_t* canvas, smol_image_t* image, int x, i
 // - int src_h             -- The vertical number of pixels within the image
 void smol_canvas_draw_image_subrect_streched(smol_canvas_t* canvas, smol_image_t* image, int x, int y, int dst_w, int dst_h, int src_x, int src_y, int src_w, int src_h);
 
+//smol_canvas_draw_image_transformed - Draws image through the current transform, its t l corner lands on the transformed origin
+// Arguments:
+// - smol_canvas_t* canvas    -- A pointer to the canvas
+// - smol_image_t* image      -- A pointer to the image
+// - smol_image_filter filter -- Nearest or bilinear sampling
+void smol_canvas_draw_image_transformed(smol_canvas_t* canvas, smol_image_t* image, smol_image_filter filter);
+
+//smol_canvas_draw_image_subrect_transformed - Draws subrect of an image through the current transform
+// Arguments:
+// - smol_canvas_t* canvas    -- A pointer to the canvas
+// - smol_image_t* image      -- A pointer to the image
+// - int src_x                -- The source location on X-axis within the image
+// - int src_y                -- The source location on Y-axis within the image
+// - int src_w                -- The horizontal number of pixels within the image
+// - int src_h                -- The vertical number of pixels within the image
+// - smol_image_filter filter -- Nearest or bilinear sampling, bilinear clamps to the subrect edges
+void smol_canvas_draw_image_subrect_transformed(smol_canvas_t* canvas, smol_image_t* image, int src_x, int src_y, int src_w, int src_h, smol_image_filter filter);
+
 //smol_canvas_draw_circle - Draw a circle into the canvas
 // Arguments:
 // - smol_canvas_t* canvas -- A pointer to the canvas
@@ -452,7 +777,48 @@ void smol_canvas_draw_rect(smol_canvas_t* canvas, int x, int y, int w, int h);
 // - int h                 -- Height of the rectangle
 void smol_canvas_fill_rect(smol_canvas_t* canvas, int x, int y, int w, int h);
 
-//smol_canvas_fill_triangle - Fills a triangle into the canvas (FIXME: not working, fix ples)
+//smol_canvas_fill_rects - Fills many rectangles into the canvas, the color, blend and scissor are fetched once for all of them
+// Arguments:
+// - smol_canvas_t* canvas            -- A pointer to the canvas
+// - const smol_canvas_rect_t* rects  -- The rectangles
+// - const smol_pixel_t* colors       -- Color of each rectangle, NULL to fill all of them with the current color
+// - int count                        -- Number of rectangles
+void smol_canvas_fill_rects(smol_canvas_t* canvas, const smol_canvas_rect_t* rects, const smol_pixel_t* colors, int count);
+
+//smol_canvas_draw_lines - Draws many lines into the canvas, the color, blend and scissor are fetched once for all of them
+// Arguments:
+// - smol_canvas_t* canvas            -- A pointer to the canvas
+// - const smol_canvas_line_t* lines  -- The lines
+// - const smol_pixel_t* colors       -- Color of each line, NULL to draw all of them with the current color
+// - int count                        -- Number of lines
+void smol_canvas_draw_lines(smol_canvas_t* canvas, const smol_canvas_line_t* lines, const smol_pixel_t* colors, int count);
+
+//smol_canvas_fill_circles - Fills many circles into the canvas, the color, blend and scissor are fetched once for all of them
+// Arguments:
+// - smol_canvas_t* canvas                -- A pointer to the canvas
+// - const smol_canvas_circle_t* circles  -- The circles
+// - const smol_pixel_t* colors           -- Color of each circle, NULL to fill all of them with the current color
+// - int count                            -- Number of circles
+void smol_canvas_fill_circles(smol_canvas_t* canvas, const smol_canvas_circle_t* circles, const smol_pixel_t* colors, int count);
+
+//smol_canvas_fill_path - Fills an outline made of one or more closed contours, clipped to the scissor
+// Arguments:
+// - smol_canvas_t* canvas              -- A pointer to the canvas
+// - const smol_canvas_point_t* points  -- Vertices of all contours, one contour after another
+// - const int* contour_sizes           -- Number of vertices in each contour, every contour is closed implicitly
+// - int num_contours                   -- Number of contours
+// - smol_fill_flags flags              -- Fill rule, optionally or'd with SMOL_FILL_ANTIALIASED
+void smol_canvas_fill_path(smol_canvas_t* canvas, const smol_canvas_point_t* points, const int* contour_sizes, int num_contours, smol_fill_flags flags);
+
+//smol_canvas_fill_polygon - Fills a polygon, clipped to the scissor
+// Arguments:
+// - smol_canvas_t* canvas              -- A pointer to the canvas
+// - const smol_canvas_point_t* points  -- Vertices of the polygon, the last one connects back to the first
+// - int num_points                     -- Number of vertices
+// - smol_fill_flags flags              -- Fill rule, optionally or'd with SMOL_FILL_ANTIALIASED
+void smol_canvas_fill_polygon(smol_canvas_t* canvas, const smol_canvas_point_t* points, int num_points, smol_fill_flags flags);
+
+//smol_canvas_fill_triangle - Fills a triangle into the canvas
 // Arguments:
 // - smol_canvas_t* canvas -- A pointer to the canvas  
 // - int x0                -- Vertex 1's location on X-axis
@@ -491,6 +857,74 @@ void smol_canvas_draw_text_formated(smol_canvas_t* canvas, int tx, int ty, int s
 // - int* h           -- Return value for bounding box height
 void smol_text_size(smol_canvas_t* font, int scale, const char* str, int* w, int* h);
 
+//smol_text_run_update - Lays out a text run, unless it already holds the same text, font and scale
+// Arguments:
+// - smol_text_run_t* run    -- Pointer to the text run, a zero initialized run is empty
+// - const smol_font_t* font -- The font used for the layout
+// - int scale               -- Scale of the text
+// - const char* str         -- The text to be laid out
+//Returns: int - 1 if the run was laid out again, 0 if it was up to date
+int smol_text_run_update(smol_text_run_t* run, const smol_font_t* font, int scale, const char* str);
+
+//smol_text_run_free - Frees the memory of a text run
+// Arguments:
+// - smol_text_run_t* run -- Pointer to the text run
+void smol_text_run_free(smol_text_run_t* run);
+
+//smol_canvas_draw_text_run - Draws a laid out text run into the canvas using canvas' current color
+// Arguments:
+// - smol_canvas_t* canvas      -- A pointer to the canvas
+// - int tx                     -- Top left coordinate on X axis of the text 
+// - int ty                     -- Top left coordinate on Y axis of the text
+// - const smol_text_run_t* run -- The text run to be drawn
+void smol_canvas_draw_text_run(smol_canvas_t* canvas, int tx, int ty, const smol_text_run_t* run);
+
+//smol_glyph_cache_create - Creates a glyph cache
+// Arguments:
+// - int page_size                 -- Width and height of an atlas page in pixels
+// - int max_pages                 -- Amount of pages before the least recently used one gets evicted
+// - int cell_width                -- Maximum width of a glyph
+// - int cell_height               -- Maximum height of a glyph, and the line height
+// - smol_glyph_source_proc source -- The callback rasterizing glyphs
+// - void* source_data             -- User data passed to the callback
+//Returns: smol_glyph_cache_t - The glyph cache
+smol_glyph_cache_t smol_glyph_cache_create(int page_size, int max_pages, int cell_width, int cell_height, smol_glyph_source_proc source, void* source_data);
+
+//smol_glyph_cache_destroy - Frees the glyph cache
+// Arguments:
+// - smol_glyph_cache_t* cache -- Pointer to the glyph cache
+void smol_glyph_cache_destroy(smol_glyph_cache_t* cache);
+
+//smol_glyph_cache_get - Fetches a glyph, rasterizes and packs it first if it isn't cached
+// Arguments:
+// - smol_glyph_cache_t* cache -- Pointer to the glyph cache
+// - smol_u32 codepoint        -- Unicode codepoint of the glyph
+//Returns: const smol_glyph_entry_t* - The glyph, valid until the next call, or NULL if it doesn't fit in a page
+const smol_glyph_entry_t* smol_glyph_cache_get(smol_glyph_cache_t* cache, smol_u32 codepoint);
+
+//smol_glyph_cache_decode_utf8 - Decodes a codepoint from utf8, with smol_utf8_to_utf32 when smol_utils.h is included
+// Arguments:
+// - const char* str      -- utf8 encoded bytes
+// - smol_u32* codepoint  -- The codepoint
+//Returns: int - Number of bytes consumed, at least one. Invalid or truncated sequences decode to U+FFFD
+int smol_glyph_cache_decode_utf8(const char* str, smol_u32* codepoint);
+
+//smol_glyph_source_font - Glyph source for the first 128 codepoints of a smol_font_t
+// Arguments:
+// - void* user_data -- Pointer to the smol_font_t
+//Returns: int - 0 when there's no glyph for the codepoint
+int smol_glyph_source_font(void* user_data, smol_u32 codepoint, smol_u8* pixels, int pitch, int max_width, int max_height, smol_glyph_metrics_t* metrics);
+
+//smol_canvas_draw_text_utf8 - Draws an utf8 text into the canvas using a glyph cache
+// Arguments:
+// - smol_canvas_t* canvas     -- A pointer to the canvas
+// - smol_glyph_cache_t* cache -- The glyph cache
+// - int tx                    -- Top left coordinate on X axis of the text 
+// - int ty                    -- Top left coordinate on Y axis of the text
+// - int scale                 -- Scale of the resulting text
+// - const char* str           -- The utf8 text to be drawn
+void smol_canvas_draw_text_utf8(smol_canvas_t* canvas, smol_glyph_cache_t* cache, int tx, int ty, int scale, const char* str);
+
 
 #ifdef SMOL_FRAME_H
 //smol_canvas_present - Presents canvas in the smol frame, requires smol frame to be included in the code before this file
@@ -559,6 +993,15 @@ smol_pixel_t smol_pixel_blend_mix(smol_pixel_t dst, smol_pixel_t src, smol_u32 x
 //Returns: smol_pixel_t  - The Result pixel of this blend function
 smol_pixel_t smol_pixel_blend_alpha_clip(smol_pixel_t dst, smol_pixel_t src, smol_u32 x, smol_u32 y);
 
+//smol_pixel_blend_over_premultiplied - Composites premultiplied source over premultiplied destination, src + dst * (1 - src.a)
+// Arguments:
+// - smol_pixel_t dst -- Destination pixel color
+// - smol_pixel_t src -- Source pixel color
+// - smol_u32 x       -- Location X
+// - smol_u32 y       -- Location Y
+//Returns: smol_pixel_t  - The Result pixel of this blend function
+smol_pixel_t smol_pixel_blend_over_premultiplied(smol_pixel_t dst, smol_pixel_t src, smol_u32 x, smol_u32 y);
+
 //Create image from existing buffer
 #define smol_image_create_from_buffer(width, height, buffer) smol_image_create_advanced(width, height, buffer, SMOLC_BLANK)
 
@@ -570,6 +1013,27 @@ smol_pixel_t smol_pixel_blend_alpha_clip(smol_pixel_t dst, smol_pixel_t src, smo
 
 #ifdef SMOL_CANVAS_IMPLEMENTATION
 
+#ifndef SMOL_ALLOC
+#define SMOL_ALLOC( size ) malloc(size)
+#endif 
+
+#ifndef SMOL_FREE
+#define SMOL_FREE( ptr ) free(ptr)
+#endif 
+
+#ifndef SMOL_REALLOC
+#define SMOL_REALLOC( old_ptr, new_size ) realloc(old_ptr, new_size)
+#endif 
+
+//Define SMOL_CANVAS_SIMD before including the implementation to enable the SSE2 kernels.
+//The scalar paths round the same way, so the results do not depend on it.
+#if defined(SMOL_CANVAS_SIMD) && !defined(SMOL_CANVAS_NO_SIMD)
+#	if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		include <emmintrin.h>
+#		define SMOL_CANVAS_SSE2
+#	endif
+#endif 
+
 #ifndef SMOL_MATH_H
 typedef union _smol_m3_t {
 	float m[9];
@@ -621,7 +1085,7 @@ smol_pixel_t smol_pixel_blend_mix(smol_pixel_t dst, smol_pixel_t src, smol_u32 x
 	smol_u32 isa = 0xFF - src.a;
 	smol_u32 sa =  0x00 + src.a;
 
-	smol_u8 r = (sa * src.r + isa * dst.a) / 255U;
+	smol_u8 r = (sa * src.r + isa * dst.r) / 255U;
 	smol_u8 g = (sa * src.g + isa * dst.g) / 255U;
 	smol_u8 b = (sa * src.b + isa * dst.b) / 255U;
 	smol_u8 a = (sa * src.a + isa * dst.a) / 255U;
@@ -636,6 +1100,51 @@ smol_pixel_t smol_pixel_blend_alpha_clip(smol_pixel_t dst, smol_pixel_t src, smo
 	return dst;
 }
 
+//Multiplies all four channels by s / 255 rounded, two channels at a time
+static SMOL_INLINE smol_u32 smol__scale_texel(smol_u32 c, smol_u32 s) {
+	smol_u32 rb = (c & 0x00FF00FFU) * s + 0x00800080U;
+	smol_u32 ga = ((c >> 8) & 0x00FF00FFU) * s + 0x00800080U;
+	rb = ((rb + ((rb >> 8) & 0x00FF00FFU)) >> 8) & 0x00FF00FFU;
+	ga = (ga + ((ga >> 8) & 0x00FF00FFU)) & 0xFF00FF00U;
+	return rb | ga;
+}
+
+//src + dst * (1 - src.a), the channels wrap like the SSE2 kernel instead of carrying into each other
+static SMOL_INLINE smol_u32 smol__over_premultiplied(smol_u32 dst, smol_u32 src) {
+	smol_u32 d = smol__scale_texel(dst, 255 - (src >> 24));
+	return (((d & 0x00FF00FFU) + (src & 0x00FF00FFU)) & 0x00FF00FFU) | (((d & 0xFF00FF00U) + (src & 0xFF00FF00U)) & 0xFF00FF00U);
+}
+
+smol_pixel_t smol_pixel_blend_over_premultiplied(smol_pixel_t dst, smol_pixel_t src, smol_u32 x, smol_u32 y) {
+	dst.pixel = smol__over_premultiplied(dst.pixel, src.pixel);
+	return dst;
+}
+
+//Composites a premultiplied color over a row of pixels
+static void smol__over_premultiplied_span(smol_pixel_t* row, int count, smol_pixel_t color) {
+
+	int x = 0;
+
+#ifdef SMOL_CANVAS_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi16(128);
+	const __m128i isa = _mm_set1_epi16((short)(255 - color.a));
+	const __m128i src = _mm_set1_epi32((int)color.pixel);
+
+	for(; x + 4 <= count; x += 4) {
+		__m128i d = _mm_loadu_si128((const __m128i*)(row + x));
+		__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), isa), bias);
+		__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), isa), bias);
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+		_mm_storeu_si128((__m128i*)(row + x), _mm_add_epi8(_mm_packus_epi16(lo, hi), src));
+	}
+#endif 
+
+	for(; x < count; x++)
+		row[x].pixel = smol__over_premultiplied(row[x].pixel, color.pixel);
+}
+
 smol_image_t smol_image_create_advanced(smol_u32 width, smol_u32 height, smol_pixel_t* buffer, smol_pixel_t color) {
 
 	smol_image_t image = { 0 };
@@ -666,6 +1175,7 @@ SMOL_INLINE void smol_image_destroy(smol_image_t* image) {
 	if(image->free_func) {
 		image->free_func(image->pixel_data);
 	}
+	smol_image_free_mips(image);
 	image->pixel_data = NULL;
 	image->width = 0;
 	image->height = 0;
@@ -683,6 +1193,142 @@ SMOL_INLINE smol_pixel_t smol_image_getpixel(smol_image_t* img, smol_u32 x, smol
 	return img->pixel_data[x + y * img->width];
 }
 
+static smol_u32 smol__mip_stamp;
+
+//Rounded average of four pixels, two channels at a time
+static SMOL_INLINE smol_u32 smol__average_texels(smol_u32 a, smol_u32 b, smol_u32 c, smol_u32 d) {
+	smol_u32 rb = (a & 0x00FF00FFU) + (b & 0x00FF00FFU) + (c & 0x00FF00FFU) + (d & 0x00FF00FFU) + 0x00020002U;
+	smol_u32 ga = ((a >> 8) & 0x00FF00FFU) + ((b >> 8) & 0x00FF00FFU) + ((c >> 8) & 0x00FF00FFU) + ((d >> 8) & 0x00FF00FFU) + 0x00020002U;
+	return ((rb >> 2) & 0x00FF00FFU) | (((ga >> 2) & 0x00FF00FFU) << 8);
+}
+
+//2x2 box filters src into dst, dst is src halved rounding up, the last row and column repeat on odd sizes
+static void smol__image_box_halve(const smol_image_t* src, smol_image_t* dst) {
+
+	int sw = src->width;
+	int sh = src->height;
+	int pairs = sw / 2; //Outputs with both source columns inside
+
+	for(int y = 0; y < (int)dst->height; y++) {
+
+		const smol_pixel_t* r0 = src->pixel_data + (2 * y) * sw;
+		const smol_pixel_t* r1 = src->pixel_data + (2 * y + 1 < sh ? 2 * y + 1 : sh - 1) * sw;
+		smol_pixel_t* out = dst->pixel_data + y * dst->width;
+
+		int x = 0;
+
+#ifdef SMOL_CANVAS_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i bias = _mm_set1_epi16(2);
+
+		for(; x + 4 <= pairs; x += 4) {
+
+			__m128 a0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(r0 + 2 * x)));
+			__m128 a1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(r0 + 2 * x + 4)));
+			__m128 b0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(r1 + 2 * x)));
+			__m128 b1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(r1 + 2 * x + 4)));
+
+			//Even and odd columns of both rows
+			__m128i ae = _mm_castps_si128(_mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0)));
+			__m128i ao = _mm_castps_si128(_mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1)));
+			__m128i be = _mm_castps_si128(_mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0)));
+			__m128i bo = _mm_castps_si128(_mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+			__m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(ae, zero), _mm_unpacklo_epi8(ao, zero)), _mm_add_epi16(_mm_unpacklo_epi8(be, zero), _mm_unpacklo_epi8(bo, zero)));
+			__m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(ae, zero), _mm_unpackhi_epi8(ao, zero)), _mm_add_epi16(_mm_unpackhi_epi8(be, zero), _mm_unpackhi_epi8(bo, zero)));
+
+			lo = _mm_srli_epi16(_mm_add_epi16(lo, bias), 2);
+			hi = _mm_srli_epi16(_mm_add_epi16(hi, bias), 2);
+
+			_mm_storeu_si128((__m128i*)(out + x), _mm_packus_epi16(lo, hi));
+		}
+#endif 
+
+		for(; x < (int)dst->width; x++) {
+			int x0 = 2 * x;
+			int x1 = x < pairs ? x0 + 1 : x0;
+			out[x].pixel = smol__average_texels(r0[x0].pixel, r0[x1].pixel, r1[x0].pixel, r1[x1].pixel);
+		}
+
+	}
+
+}
+
+int smol_image_build_mips(smol_image_t* image) {
+
+	smol_u32 widths[SMOL_IMAGE_MAX_MIPS];
+	smol_u32 heights[SMOL_IMAGE_MAX_MIPS];
+	smol_size_t total = 0;
+	int num_levels = 0;
+
+	smol_u32 w = image->width;
+	smol_u32 h = image->height;
+	while((w > 1 || h > 1) && num_levels < SMOL_IMAGE_MAX_MIPS) {
+		w = (w + 1) / 2;
+		h = (h + 1) / 2;
+		widths[num_levels] = w;
+		heights[num_levels] = h;
+		total += (smol_size_t)w * h;
+		num_levels++;
+	}
+
+	smol_image_mips_t* mips = image->mips;
+
+	//The sizes only change with the image, so an existing chain is rebuilt in place
+	if(mips && (mips->num_levels != num_levels || (num_levels && (mips->levels[0].width != widths[0] || mips->levels[0].height != heights[0])))) {
+		smol_image_free_mips(image);
+		mips = NULL;
+	}
+
+	if(num_levels == 0 || !image->pixel_data)
+		return 0;
+
+	if(!mips) {
+		mips = (smol_image_mips_t*)SMOL_ALLOC(sizeof(smol_image_mips_t));
+		memset(mips, 0, sizeof(smol_image_mips_t));
+
+		smol_pixel_t* pixels = (smol_pixel_t*)SMOL_ALLOC(total * sizeof(smol_pixel_t));
+		for(int i = 0; i < num_levels; i++) {
+			mips->levels[i].pixel_data = pixels;
+			mips->levels[i].width = widths[i];
+			mips->levels[i].height = heights[i];
+			pixels += (smol_size_t)widths[i] * heights[i];
+		}
+		mips->num_levels = num_levels;
+		image->mips = mips;
+	}
+
+	smol__image_box_halve(image, &mips->levels[0]);
+	for(int i = 1; i < num_levels; i++)
+		smol__image_box_halve(&mips->levels[i - 1], &mips->levels[i]);
+
+	mips->stamp = ++smol__mip_stamp;
+
+	return num_levels;
+}
+
+void smol_image_free_mips(smol_image_t* image) {
+	if(image->mips) {
+		SMOL_FREE(image->mips->levels[0].pixel_data);
+		SMOL_FREE(image->mips);
+		image->mips = NULL;
+	}
+}
+
+void smol_image_premultiply(smol_image_t* image) {
+	smol_size_t count = (smol_size_t)image->width * image->height;
+	for(smol_size_t i = 0; i < count; i++) {
+		smol_u32 c = image->pixel_data[i].pixel;
+		image->pixel_data[i].pixel = (smol__scale_texel(c, c >> 24) & 0x00FFFFFFU) | (c & 0xFF000000U);
+	}
+}
+
+void smol_image_unpremultiply(smol_image_t* image) {
+	smol_size_t count = (smol_size_t)image->width * image->height;
+	for(smol_size_t i = 0; i < count; i++)
+		image->pixel_data[i] = smol_unpremultiply(image->pixel_data[i]);
+}
+
 typedef struct _smol_stack_t {
 	void* data;
 	smol_u32 element_size;
@@ -698,8 +1344,21 @@ typedef struct _smol_canvas_t {
 	smol_stack_t blend_funcs;
 	smol_stack_t font_stack;
 	smol_stack_t scissor_stack;
+	smol_text_run_t* text_runs; //Direct mapped cache of SMOL_CANVAS_TEXT_RUN_CACHE_SIZE runs for smol_canvas_draw_text
+	struct _smol_scaled_image_t* scaled_images; //LRU cache of SMOL_CANVAS_SCALED_IMAGE_CACHE_SIZE images for smol_canvas_draw_image_subrect_streched
+	smol_u32 scaled_clock;
+	int premultiplied; //The surface and the colors are premultiplied by alpha, see smol_canvas_set_premultiplied
 } smol_canvas_t;
 
+//A downscaled subrect of an image with mips
+typedef struct _smol_scaled_image_t {
+	const smol_pixel_t* source;
+	smol_u32 stamp;
+	int src_x, src_y, src_w, src_h;
+	smol_u32 last_use; //Zero when empty
+	smol_image_t image;
+} smol_scaled_image_t;
+
 smol_stack_t smol_stack_create(smol_u32 element_size, smol_u32 element_count) {
 	
 	smol_stack_t stack = { 0 };
@@ -753,37 +1412,148 @@ void smol_stack_clear(smol_stack_t* stack) {
 
 
 static smol_font_t smol__default_font = { 0 };
-#define PXF_NUM_PRINTABLE_GLYPHS 94
-#define SMOL_BUILTIN_FONT_WIDTH 9
-#define SMOL_BUILTIN_FONT_HEIGHT 13
-static char* smol__builtin_font_data;
-static char* smol__builtin_geom_data;
 static int smol__builtin_font_refs;
 
-static const char SMOL_BUILTIN_FONT_BLOB[] = 
-"AAACAQCAQCAQCAACAAAAAAAoFAoAAAAAAAAAAAAAAACgUPwoFAofhQKAAAAAAAQHBEIA4AhEHAQAAAAAAICiIgICAgIiKAgAAAAAAAAAAAAAAAAAAAAAAAAACAQCAAAAAAAA"
-"AAAAAAAAICAQEAgEAgEAQCAIAAAEAQCAIBAIBAICAQEAAAAAABsHD+HBsAAAAAAAAAAAACAQCD+CAQCAAAAAAAAAAAAAAAAAAAQEAAAAAAAAAAAAD+AAAAAAAAAAAAAA"
-"AAAAAAAAAQAAAAAAAACAgICAgICAAAAAAAAA4IhEIhEIhEIg4AAAAAACBwCAQCAQCAQPgAAAAAA4IgEAgICAgIB8AAAAAAHBEAgEDAEAhEHAAAAAAAIDAYFAoJB8BAcA"
-"AAAAAPhAIBAPAEAhEHAAAAAAAYEBAIB4IhEIg4AAAAAAPhEAgIBAQCAgEAAAAAAA4IhEIg4IhEIg4AAAAAAHBEIhEHgEAgIGAAAAAAAAAAACAAAAAAAQAAAAAAAAAAAQ"
-"AAAAAACAgAAAAAAAAICAgIAgCAIAAAAAAAAAAB8AB8AAAAAAAAAAAAAAgCAIAgICAgAAAAAAHBEAgEBAQCAACAAAAAAA8ISaVSqVScIA4AAAAAAGAQCAoFBEPhEdwAAA"
-"AAD8IRCIR8IRCIT8AAAAAAHhCQCAQCAQBCHgAAAAAD4IhCIRCIRCIj4AAAAAAfxCIBIPBIIBCfwAAAAAD+IRAJB4JBAIDwAAAAAAHhCQCAQCOQRCHgAAAAADuIhEIh8I"
-"hEIjuAAAAAAPgQCAQCAQCAQPgAAAAAA8BAIBAIBCIRBwAAAAAAcxEJBIKBwJBEcwAAAAAD4EAgEAgEAgET+AAAAAAYxENhsKhUIhEdwAAAAADOIhkMhUJhMIjkAAAAAA"
-"HBEQSCQSCQREHAAAAAAD8IRCIR8IBAIDwAAAAAAHBEQSCQSCQREHA2AAAAD8IRCIR8JBIIjmAAAAAAPiCQCAPgCASCPgAAAAAD+SQQCAQCAQCA4AAAAAAdxEIhEIhEIh"
-"EHAAAAAADuIhEIgoFAoCAQAAAAAAdxEIhEKhUKgoFAAAAAADuIgoFAQFAoIjuAAAAAAdxEIgoFAQCAQHAAAAAAD+QgIBAQEAgIT+AAAAAAHAgEAgEAgEAgEAgHAAAAAQ"
-"BAEAQBAEAQAAAAAAAHAIBAIBAIBAIBAIHAACAoIgAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA/wAAAgCAAAAAAAAAAAAAAAAAAAAAB4Ah8QiEPQAAAAADAIBAPhCIRCIT8"
-"AAAAAAAAAAB8QSAQCCPgAAAAAAMAgEPiEQiEQh+AAAAAAAAAAB8QT+QCCPgAAAAAAYEAgPAgEAgEB4AAAAAAAAAAB+QiEQh8AgEPAAADAIBALBkIhEIjuAAAAAACAAAB"
-"wCAQCAQPgAAAAAAIAAAPAIBAIBAIBBwAAAYBAIBMJBQOBIYwAAAAAAwCAQCAQCAQCB8AAAAAAAAAADoKhUKhUawAAAAAAAAAAbBkIhEIjuAAAAAAAAAAB8QSCQSCPgAA"
-"AAAAAAAAfhCIRCIR8IDgAAAAAAAB+QiEQiEPgEBwAAAAAAAdgyEAgED4AAAAAAAAAAB8QRwBiCPgAAAAAAAEAgPAgEAgEgYAAAAAAAAAADMIhEIhMGwAAAAAAAAAAdxE"
-"IgoFAQAAAAAAAAAADuIhUKgoFAAAAAAAAAAAdxEHA4IjuAAAAAAAAAADuIhEFAoCAQMAAAAAAAAfiICAgIj8AAAAAABgQCAQCBgCAQCAQBgACAQCAQCAQCAQCAQCAQAA"
-"AMAQCAQCAMCAQCAQMAAAAAMSSRgAAAAAAAAA=";
-
-static const char BUILTIN_FONT_GEOM_BLOB[] =
-"BAEDAwEHAgUBBwAABAEDAwMDAQcBBwMCAQcEAQEHAgUCBQIFAgUCBQIFAgUCBQIFAgUEAQMCAgQCBQMEAgUBBwEHAQcBBwEHAQcBBwEHAQcCBQEGAQcBBwEHAQcBBwEHAQcB"
-"BwEHAQcBBwEHAQcBBwEHAQcDAwEHAwMCBQAIAwIBBwEHAQcBBwEHAgQBBwEHAgUCBAEHAgUBBwEHAQcBBwEHAQcBBwIFAQcBBwEHAQcBBwEGAgUEAQIFAQf9=";
-
-
-#define FIRST_VISIBLE_SYMBOL '!'
-
+//The default 9x13 font as a precompiled .pxb image
+static const smol_u32 SMOL_BUILTIN_FONT_PXB[] = {
+	0x31425850, /* "PXB1" */ 0x000D0009, /* 9 x 13 */ 128, 32, 288, 6944, 0, 0,
+	0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+	0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+	0x01040000, 0x07010303, 0x07010502, 0x01040000, 0x03030303, 0x07010701, 0x07010203, 0x07010104,
+	0x05020502, 0x05020502, 0x05020502, 0x05020502, 0x05020502, 0x02030104, 0x05020402, 0x05020403,
+	0x07010701, 0x07010701, 0x07010701, 0x07010701, 0x05020701, 0x07010601, 0x07010701, 0x07010701,
+	0x07010701, 0x07010701, 0x07010701, 0x07010701, 0x07010701, 0x03030701, 0x03030701, 0x08000502,
+	0x07010203, 0x07010701, 0x07010701, 0x07010402, 0x05020701, 0x07010402, 0x07010502, 0x07010701,
+	0x07010701, 0x07010701, 0x07010502, 0x07010701, 0x07010701, 0x05020601, 0x05020104, 0x00000701,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0, 0x010, 0, 0, /* ! */
+	0, 0, 0x028, 0x028, 0x028, 0, 0, 0, 0, 0, 0, 0, 0, /* " */
+	0, 0, 0x050, 0x050, 0x0FC, 0x028, 0x028, 0x028, 0x07E, 0x014, 0x014, 0, 0, /* # */
+	0, 0, 0x010, 0x038, 0x044, 0x004, 0x038, 0x040, 0x044, 0x038, 0x010, 0, 0, /* $ */
+	0, 0, 0x004, 0x08A, 0x044, 0x020, 0x010, 0x008, 0x044, 0x0A2, 0x040, 0, 0, /* % */
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* & */
+	0, 0, 0x010, 0x010, 0x010, 0, 0, 0, 0, 0, 0, 0, 0, /* ' */
+	0, 0, 0x020, 0x010, 0x010, 0x008, 0x008, 0x008, 0x008, 0x008, 0x010, 0x010, 0x020, /* ( */
+	0, 0, 0x008, 0x010, 0x010, 0x020, 0x020, 0x020, 0x020, 0x020, 0x010, 0x010, 0x008, /* ) */
+	0, 0, 0, 0, 0x06C, 0x038, 0x0FE, 0x038, 0x06C, 0, 0, 0, 0, /* * */
+	0, 0, 0, 0, 0x010, 0x010, 0x010, 0x0FE, 0x010, 0x010, 0x010, 0, 0, /* + */
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x010, 0x008, 0, /* , */
+	0, 0, 0, 0, 0, 0, 0, 0x0FE, 0, 0, 0, 0, 0, /* - */
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x010, 0, 0, /* . */
+	0, 0, 0, 0x080, 0x040, 0x020, 0x010, 0x008, 0x004, 0x002, 0, 0, 0, /* / */
+	0, 0, 0x038, 0x044, 0x044, 0x044, 0x044, 0x044, 0x044, 0x044, 0x038, 0, 0, /* 0 */
+	0, 0, 0x010, 0x01C, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x07C, 0, 0, /* 1 */
+	0, 0, 0x038, 0x044, 0x040, 0x040, 0x020, 0x010, 0x008, 0x004, 0x07C, 0, 0, /* 2 */
+	0, 0, 0x038, 0x044, 0x040, 0x040, 0x030, 0x040, 0x040, 0x044, 0x038, 0, 0, /* 3 */
+	0, 0, 0x020, 0x030, 0x030, 0x028, 0x028, 0x024, 0x07C, 0x020, 0x070, 0, 0, /* 4 */
+	0, 0, 0x07C, 0x004, 0x004, 0x004, 0x03C, 0x040, 0x040, 0x044, 0x038, 0, 0, /* 5 */
+	0, 0, 0x030, 0x008, 0x004, 0x004, 0x03C, 0x044, 0x044, 0x044, 0x038, 0, 0, /* 6 */
+	0, 0, 0x07C, 0x044, 0x040, 0x020, 0x020, 0x010, 0x010, 0x008, 0x008, 0, 0, /* 7 */
+	0, 0, 0x038, 0x044, 0x044, 0x044, 0x038, 0x044, 0x044, 0x044, 0x038, 0, 0, /* 8 */
+	0, 0, 0x038, 0x044, 0x044, 0x044, 0x078, 0x040, 0x040, 0x020, 0x018, 0, 0, /* 9 */
+	0, 0, 0, 0, 0, 0x010, 0, 0, 0, 0, 0x010, 0, 0, /* : */
+	0, 0, 0, 0, 0, 0x010, 0, 0, 0, 0, 0x010, 0x008, 0, /* ; */
+	0, 0, 0, 0, 0x020, 0x010, 0x008, 0x004, 0x008, 0x010, 0x020, 0, 0, /* < */
+	0, 0, 0, 0, 0, 0x07C, 0, 0x07C, 0, 0, 0, 0, 0, /* = */
+	0, 0, 0, 0, 0x008, 0x010, 0x020, 0x040, 0x020, 0x010, 0x008, 0, 0, /* > */
+	0, 0, 0x038, 0x044, 0x040, 0x040, 0x020, 0x010, 0x010, 0, 0x010, 0, 0, /* ? */
+	0, 0, 0x078, 0x084, 0x0B2, 0x0AA, 0x0AA, 0x0AA, 0x072, 0x004, 0x038, 0, 0, /* @ */
+	0, 0, 0x018, 0x010, 0x010, 0x028, 0x028, 0x044, 0x07C, 0x044, 0x0EE, 0, 0, /* A */
+	0, 0, 0x07E, 0x084, 0x084, 0x084, 0x07C, 0x084, 0x084, 0x084, 0x07E, 0, 0, /* B */
+	0, 0, 0x078, 0x084, 0x002, 0x002, 0x002, 0x002, 0x002, 0x084, 0x078, 0, 0, /* C */
+	0, 0, 0x03E, 0x044, 0x084, 0x084, 0x084, 0x084, 0x084, 0x044, 0x03E, 0, 0, /* D */
+	0, 0, 0x0FE, 0x084, 0x004, 0x024, 0x03C, 0x024, 0x004, 0x084, 0x0FE, 0, 0, /* E */
+	0, 0, 0x0FE, 0x084, 0x004, 0x024, 0x03C, 0x024, 0x004, 0x004, 0x01E, 0, 0, /* F */
+	0, 0, 0x078, 0x084, 0x002, 0x002, 0x002, 0x0E2, 0x082, 0x084, 0x078, 0, 0, /* G */
+	0, 0, 0x0EE, 0x044, 0x044, 0x044, 0x07C, 0x044, 0x044, 0x044, 0x0EE, 0, 0, /* H */
+	0, 0, 0x07C, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x07C, 0, 0, /* I */
+	0, 0, 0x078, 0x020, 0x020, 0x020, 0x020, 0x020, 0x022, 0x022, 0x01C, 0, 0, /* J */
+	0, 0, 0x0CE, 0x044, 0x024, 0x024, 0x014, 0x01C, 0x024, 0x044, 0x0CE, 0, 0, /* K */
+	0, 0, 0x03E, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x088, 0x0FE, 0, 0, /* L */
+	0, 0, 0x0C6, 0x044, 0x06C, 0x06C, 0x054, 0x054, 0x044, 0x044, 0x0EE, 0, 0, /* M */
+	0, 0, 0x0E6, 0x044, 0x04C, 0x04C, 0x054, 0x064, 0x064, 0x044, 0x04E, 0, 0, /* N */
+	0, 0, 0x038, 0x044, 0x082, 0x082, 0x082, 0x082, 0x082, 0x044, 0x038, 0, 0, /* O */
+	0, 0, 0x07E, 0x084, 0x084, 0x084, 0x07C, 0x004, 0x004, 0x004, 0x01E, 0, 0, /* P */
+	0, 0, 0x038, 0x044, 0x082, 0x082, 0x082, 0x082, 0x082, 0x044, 0x038, 0x0D8, 0, /* Q */
+	0, 0, 0x07E, 0x084, 0x084, 0x084, 0x07C, 0x024, 0x024, 0x044, 0x0CE, 0, 0, /* R */
+	0, 0, 0x07C, 0x082, 0x002, 0x002, 0x07C, 0x080, 0x080, 0x082, 0x07C, 0, 0, /* S */
+	0, 0, 0x0FE, 0x092, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x038, 0, 0, /* T */
+	0, 0, 0x0EE, 0x044, 0x044, 0x044, 0x044, 0x044, 0x044, 0x044, 0x038, 0, 0, /* U */
+	0, 0, 0x0EE, 0x044, 0x044, 0x044, 0x028, 0x028, 0x028, 0x010, 0x010, 0, 0, /* V */
+	0, 0, 0x0EE, 0x044, 0x044, 0x044, 0x054, 0x054, 0x054, 0x028, 0x028, 0, 0, /* W */
+	0, 0, 0x0EE, 0x044, 0x028, 0x028, 0x010, 0x028, 0x028, 0x044, 0x0EE, 0, 0, /* X */
+	0, 0, 0x0EE, 0x044, 0x044, 0x028, 0x028, 0x010, 0x010, 0x010, 0x038, 0, 0, /* Y */
+	0, 0, 0x0FE, 0x042, 0x020, 0x020, 0x010, 0x008, 0x008, 0x084, 0x0FE, 0, 0, /* Z */
+	0, 0, 0x038, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x008, 0x038, /* [ */
+	0, 0, 0, 0x002, 0x004, 0x008, 0x010, 0x020, 0x040, 0x080, 0, 0, 0, /* \ */
+	0, 0, 0x038, 0x020, 0x020, 0x020, 0x020, 0x020, 0x020, 0x020, 0x020, 0x020, 0x038, /* ] */
+	0, 0x010, 0x028, 0x044, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* ^ */
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x0FF, /* _ */
+	0, 0, 0x008, 0x010, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* ` */
+	0, 0, 0, 0, 0, 0x03C, 0x040, 0x07C, 0x042, 0x042, 0x0BC, 0, 0, /* a */
+	0, 0, 0x006, 0x004, 0x004, 0x07C, 0x084, 0x084, 0x084, 0x084, 0x07E, 0, 0, /* b */
+	0, 0, 0, 0, 0, 0x07C, 0x082, 0x002, 0x002, 0x082, 0x07C, 0, 0, /* c */
+	0, 0, 0x060, 0x040, 0x040, 0x07C, 0x042, 0x042, 0x042, 0x042, 0x0FC, 0, 0, /* d */
+	0, 0, 0, 0, 0, 0x07C, 0x082, 0x0FE, 0x002, 0x082, 0x07C, 0, 0, /* e */
+	0, 0, 0x030, 0x008, 0x008, 0x03C, 0x008, 0x008, 0x008, 0x008, 0x03C, 0, 0, /* f */
+	0, 0, 0, 0, 0, 0x0FC, 0x042, 0x042, 0x042, 0x07C, 0x040, 0x040, 0x03C, /* g */
+	0, 0, 0x006, 0x004, 0x004, 0x034, 0x04C, 0x044, 0x044, 0x044, 0x0EE, 0, 0, /* h */
+	0, 0, 0x010, 0, 0, 0x01C, 0x010, 0x010, 0x010, 0x010, 0x07C, 0, 0, /* i */
+	0, 0, 0x020, 0, 0, 0x03C, 0x020, 0x020, 0x020, 0x020, 0x020, 0x020, 0x01C, /* j */
+	0, 0, 0x006, 0x004, 0x004, 0x064, 0x024, 0x014, 0x01C, 0x024, 0x0C6, 0, 0, /* k */
+	0, 0, 0x018, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x07C, 0, 0, /* l */
+	0, 0, 0, 0, 0, 0x02E, 0x054, 0x054, 0x054, 0x054, 0x0D6, 0, 0, /* m */
+	0, 0, 0, 0, 0, 0x036, 0x04C, 0x044, 0x044, 0x044, 0x0EE, 0, 0, /* n */
+	0, 0, 0, 0, 0, 0x07C, 0x082, 0x082, 0x082, 0x082, 0x07C, 0, 0, /* o */
+	0, 0, 0, 0, 0, 0x07E, 0x084, 0x084, 0x084, 0x084, 0x07C, 0x004, 0x00E, /* p */
+	0, 0, 0, 0, 0, 0x0FC, 0x042, 0x042, 0x042, 0x042, 0x07C, 0x040, 0x0E0, /* q */
+	0, 0, 0, 0, 0, 0x06E, 0x098, 0x008, 0x008, 0x008, 0x03E, 0, 0, /* r */
+	0, 0, 0, 0, 0, 0x07C, 0x082, 0x01C, 0x060, 0x082, 0x07C, 0, 0, /* s */
+	0, 0, 0, 0x008, 0x008, 0x03C, 0x008, 0x008, 0x008, 0x048, 0x030, 0, 0, /* t */
+	0, 0, 0, 0, 0, 0x066, 0x044, 0x044, 0x044, 0x064, 0x0D8, 0, 0, /* u */
+	0, 0, 0, 0, 0, 0x0EE, 0x044, 0x044, 0x028, 0x028, 0x010, 0, 0, /* v */
+	0, 0, 0, 0, 0, 0x0EE, 0x044, 0x054, 0x054, 0x028, 0x028, 0, 0, /* w */
+	0, 0, 0, 0, 0, 0x0EE, 0x044, 0x038, 0x038, 0x044, 0x0EE, 0, 0, /* x */
+	0, 0, 0, 0, 0, 0x0EE, 0x044, 0x044, 0x028, 0x028, 0x010, 0x010, 0x00C, /* y */
+	0, 0, 0, 0, 0, 0x07E, 0x022, 0x010, 0x008, 0x044, 0x07E, 0, 0, /* z */
+	0, 0, 0x060, 0x010, 0x010, 0x010, 0x010, 0x00C, 0x010, 0x010, 0x010, 0x010, 0x060, /* { */
+	0, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, /* | */
+	0, 0, 0x00C, 0x010, 0x010, 0x010, 0x010, 0x060, 0x010, 0x010, 0x010, 0x010, 0x00C, /* } */
+	0, 0, 0, 0x08C, 0x092, 0x062, 0, 0, 0, 0, 0, 0, 0, /* ~ */
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
 
 #define smol_from_base64(c) ( \
 	(((c) >= 'A' && (c) <= 'Z')*(0  + ((c) - 'A'))) + \
@@ -809,6 +1579,15 @@ smol_size_t smol_base64_decode(const char* input, smol_size_t input_length, char
 	return decoded;
 }
 
+//Builds the affine m3 with rows { a, b, c }, { d, e, f }, { 0, 0, 1 }, smol_m3_t is either the one from smol_math.h or the fallback
+static smol_m3_t smol__m3_affine(float a, float b, float c, float d, float e, float f) {
+	smol_m3_t res;
+	res.m[0] = a; res.m[1] = b; res.m[2] = c;
+	res.m[3] = d; res.m[4] = e; res.m[5] = f;
+	res.m[6] = 0.f; res.m[7] = 0.f; res.m[8] = 1.f;
+	return res;
+}
+
 smol_canvas_t smol_canvas_create(smol_u32 width, smol_u32 height) {
 
 	smol_canvas_t canvas = { 0 };
@@ -828,9 +1607,17 @@ smol_canvas_t smol_canvas_create(smol_u32 width, smol_u32 height) {
 	smol_rect_t scissor = { 0, 0, width, height };
 	smol_stack_push_immediate(&canvas.scissor_stack, scissor);
 
+	smol_m3_t transform = smol__m3_affine(1.f, 0.f, 0.f, 0.f, 1.f, 0.f);
+	smol_stack_push(&canvas.transform_stack, &transform);
+
 	smol_font_t* font = smol_load_default_font();
 	smol_stack_push(&canvas.font_stack, &font);
 
+	canvas.text_runs = (smol_text_run_t*)SMOL_ALLOC(sizeof(smol_text_run_t) * SMOL_CANVAS_TEXT_RUN_CACHE_SIZE);
+	memset(canvas.text_runs, 0, sizeof(smol_text_run_t) * SMOL_CANVAS_TEXT_RUN_CACHE_SIZE);
+
+	canvas.scaled_images = (smol_scaled_image_t*)SMOL_ALLOC(sizeof(smol_scaled_image_t) * SMOL_CANVAS_SCALED_IMAGE_CACHE_SIZE);
+	memset(canvas.scaled_images, 0, sizeof(smol_scaled_image_t) * SMOL_CANVAS_SCALED_IMAGE_CACHE_SIZE);
 
 	return canvas;
 }
@@ -842,65 +1629,127 @@ void smol_canvas_destroy(smol_canvas_t* canvas) {
 	smol_stack_free(&canvas->blend_funcs);
 	smol_stack_free(&canvas->font_stack);
 	smol_stack_free(&canvas->scissor_stack);
+
+	if(canvas->text_runs) {
+		for(int i = 0; i < SMOL_CANVAS_TEXT_RUN_CACHE_SIZE; i++)
+			smol_text_run_free(&canvas->text_runs[i]);
+		SMOL_FREE(canvas->text_runs);
+		canvas->text_runs = NULL;
+	}
+
+	if(canvas->scaled_images) {
+		for(int i = 0; i < SMOL_CANVAS_SCALED_IMAGE_CACHE_SIZE; i++)
+			smol_image_destroy(&canvas->scaled_images[i].image);
+		SMOL_FREE(canvas->scaled_images);
+		canvas->scaled_images = NULL;
+	}
 }
 
 smol_font_t* smol_load_default_font() {
 
 	if(smol__builtin_font_refs)
 		return &smol__default_font;
-	char bitstream[(94 * SMOL_BUILTIN_FONT_WIDTH * SMOL_BUILTIN_FONT_HEIGHT) / 8] = { 0 };
 
-	smol__default_font.glyph_width = SMOL_BUILTIN_FONT_WIDTH;
-	smol__default_font.glyph_height = SMOL_BUILTIN_FONT_HEIGHT;
-	
-	int num_glyph_pixels = smol__default_font.glyph_width * smol__default_font.glyph_height;;
+	smol_font_from_pxb(SMOL_BUILTIN_FONT_PXB, sizeof(SMOL_BUILTIN_FONT_PXB), &smol__default_font);
+	smol__builtin_font_refs++;
+
+	return &smol__default_font;
+}
 
-	int data_size = smol__default_font.glyph_width * smol__default_font.glyph_height * PXF_NUM_PRINTABLE_GLYPHS;
-	int alloc_size = smol__default_font.glyph_width * smol__default_font.glyph_height * 128;
+int smol_font_from_pxb(const void* data, smol_size_t size, smol_font_t* font) {
 
-	int size = 128 * SMOL_BUILTIN_FONT_WIDTH * SMOL_BUILTIN_FONT_HEIGHT;
-	smol__builtin_font_data = memset(malloc(size), 0, size);
-	smol__builtin_geom_data = memset(malloc(128 * 2), 0, 128*2);
+	const smol_pxb_header_t* header = (const smol_pxb_header_t*)data;
 
-	char* glyph_data = smol__builtin_font_data;
-	smol__default_font.glyphs = smol__builtin_font_data;
+	if(!data || ((smol_size_t)data & 3) || size < sizeof(smol_pxb_header_t))
+		return 0;
 
-		
+	if(memcmp(header->magic, "PXB1", 4) || header->num_glyphs != 128 || header->file_size > size)
+		return 0;
 
-	int offset = FIRST_VISIBLE_SYMBOL * SMOL_BUILTIN_FONT_WIDTH * SMOL_BUILTIN_FONT_HEIGHT;
-	{
-		smol_size_t s = smol_base64_decode(SMOL_BUILTIN_FONT_BLOB, sizeof(SMOL_BUILTIN_FONT_BLOB) - 1, bitstream, sizeof(bitstream));
-		static const int data_offset = FIRST_VISIBLE_SYMBOL * SMOL_BUILTIN_FONT_WIDTH * SMOL_BUILTIN_FONT_HEIGHT;
-
-		int index = 0;
-		for(int i = 0; i < PXF_NUM_PRINTABLE_GLYPHS; i++) {
-			for(int j = 0; j < SMOL_BUILTIN_FONT_HEIGHT; j++)
-			for(int k = 0; k < SMOL_BUILTIN_FONT_WIDTH; k++)
-			{
-				smol_u8 mask = 0x80 >> (index % 8);
-				smol__builtin_font_data[data_offset + index] = ((bitstream[index / 8] & mask) != 0);
-				index++;
-			}
-		}
+	if(header->glyph_width == 0 || header->glyph_width > 32 || header->glyph_height == 0 || (header->rows_offset & 3))
+		return 0;
+
+	smol_size_t rows_size = (smol_size_t)header->num_glyphs * header->glyph_height * sizeof(smol_u32);
+	if(header->rows_offset > header->file_size || rows_size > header->file_size - header->rows_offset)
+		return 0;
+
+	smol_size_t geometry_size = header->num_glyphs * sizeof(smol_font_hor_geometry_t);
+	if(header->geometry_offset && (header->geometry_offset > header->file_size || geometry_size > header->file_size - header->geometry_offset))
+		return 0;
+
+	const char* bytes = (const char*)data;
+
+	font->glyphs = NULL;
+	font->glyph_width = header->glyph_width;
+	font->glyph_height = header->glyph_height;
+	font->geometry = header->geometry_offset ? (smol_font_hor_geometry_t*)(bytes + header->geometry_offset) : NULL;
+	font->rows = (const smol_u32*)(bytes + header->rows_offset);
+
+	return 1;
+}
+
+void* smol_font_load_pxb(const char* path, smol_font_t* font) {
+
+#ifdef _CRT_SECURE_NO_WARNINGS
+	FILE* file = fopen(path, "rb");
+#else 
+	FILE* file = NULL;
+	fopen_s(&file, path, "rb");
+#endif 
+	if(!file)
+		return NULL;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	void* data = size > 0 ? SMOL_ALLOC(size) : NULL;
+	int ok = data && fread(data, 1, size, file) == (smol_size_t)size;
+	fclose(file);
+
+	if(!ok || !smol_font_from_pxb(data, size, font)) {
+		if(data) SMOL_FREE(data);
+		return NULL;
 	}
 
-	{
-		smol_size_t s = smol_base64_decode(BUILTIN_FONT_GEOM_BLOB, sizeof(BUILTIN_FONT_GEOM_BLOB) - 1, bitstream, PXF_NUM_PRINTABLE_GLYPHS * 2);
-		static const int data_offset = FIRST_VISIBLE_SYMBOL * 2;
+	return data;
+}
 
-		for(int i = 0; i < PXF_NUM_PRINTABLE_GLYPHS; i++) {
-			smol__builtin_geom_data[data_offset + i*2] = bitstream[i * 2];
-			smol__builtin_geom_data[data_offset + i*2+1] = bitstream[i * 2 + 1];
-		}
-		smol__default_font.geometry = (smol_font_hor_geometry_t*)smol__builtin_geom_data;
-		
+int smol_font_pack_rows(smol_font_t* font) {
+
+	if(!font->glyphs || font->glyph_width > 32)
+		return 0;
+
+	smol_u32* rows = (smol_u32*)SMOL_ALLOC(128 * font->glyph_height * sizeof(smol_u32));
+	const char* pixels = font->glyphs;
+
+	for(int i = 0; i < 128 * font->glyph_height; i++) {
+		smol_u32 row = 0;
+		for(int x = 0; x < font->glyph_width; x++) 
+			row |= (smol_u32)(pixels[x] != 0) << x;
+		rows[i] = row;
+		pixels += font->glyph_width;
 	}
 
-	return &smol__default_font;
+	font->rows = rows;
+	return 1;
+
+}
+
+void smol_font_free_rows(smol_font_t* font) {
+	//Rows without glyphs point into .pxb data, those aren't owned by the font
+	if(font->rows && font->glyphs) 
+		SMOL_FREE((void*)font->rows);
+	font->rows = NULL;
+}
+
+//Straight alpha color given to the canvas, in the format of the canvas
+static SMOL_INLINE smol_pixel_t smol__canvas_color(const smol_canvas_t* canvas, smol_pixel_t color) {
+	return canvas->premultiplied ? smol_premultiply(color) : color;
 }
 
 void smol_canvas_set_color(smol_canvas_t* canvas, smol_pixel_t color) {
-	smol_stack_back(canvas->color_stack, smol_pixel_t) = color;
+	smol_stack_back(canvas->color_stack, smol_pixel_t) = smol__canvas_color(canvas, color);
 }
 
 void smol_canvas_set_color_rgb(smol_canvas_t* canvas, smol_byte r, smol_byte g, smol_byte b) {
@@ -908,7 +1757,7 @@ void smol_canvas_set_color_rgb(smol_canvas_t* canvas, smol_byte r, smol_byte g,
 }
 
 void smol_canvas_set_color_rgba(smol_canvas_t* canvas, smol_byte r, smol_byte g, smol_byte b, smol_byte a) {
-	smol_stack_back(canvas->color_stack, smol_pixel_t) = smol_rgba(r, g, b, a);
+	smol_stack_back(canvas->color_stack, smol_pixel_t) = smol__canvas_color(canvas, smol_rgba(r, g, b, a));
 }
 
 void smol_canvas_set_color_hsv(smol_canvas_t* canvas, smol_u16 h, smol_byte s, smol_byte v) {
@@ -916,7 +1765,7 @@ void smol_canvas_set_color_hsv(smol_canvas_t* canvas, smol_u16 h, smol_byte s, s
 }
 
 void smol_canvas_set_color_hsva(smol_canvas_t* canvas, smol_u16 h, smol_byte s, smol_byte v, smol_byte a) {
-	smol_stack_back(canvas->color_stack, smol_pixel_t) = smol_hsva(h, s, v, a);
+	smol_stack_back(canvas->color_stack, smol_pixel_t) = smol__canvas_color(canvas, smol_hsva(h, s, v, a));
 }
 
 void smol_canvas_darken_color(smol_canvas_t* canvas, smol_u16 percentage) {
@@ -951,10 +1800,18 @@ void smol_canvas_lighten_color(smol_canvas_t* canvas, smol_u16 percentage) {
 	if(cg > 255) cg = 255;
 	if(cb > 255) cb = 255;
 
+	//A premultiplied channel can't exceed alpha
+	if(canvas->premultiplied) {
+		if(cr > color.a) cr = color.a;
+		if(cg > color.a) cg = color.a;
+		if(cb > color.a) cb = color.a;
+	}
+
 	smol_stack_back(canvas->color_stack, smol_pixel_t) = smol_rgba(cr, cg, cb, color.a);
 }
 
 void smol_canvas_clear(smol_canvas_t* canvas, smol_pixel_t color) {
+	color = smol__canvas_color(canvas, color);
 	for(smol_size_t i = 0; i < canvas->draw_surface.width * canvas->draw_surface.height; i++) {
 		canvas->draw_surface.pixel_data[i] = color;
 	}
@@ -969,7 +1826,10 @@ void smol_canvas_pop_color(smol_canvas_t* canvas) {
 }
 
 void smol_canvas_set_blend(smol_canvas_t* canvas, smol_pixel_blend_func_proc* blend_func) {
-	smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc) = blend_func;
+	smol_pixel_blend_func_proc proc = (smol_pixel_blend_func_proc)blend_func;
+	if(canvas->premultiplied && proc == smol_pixel_blend_mix)
+		proc = smol_pixel_blend_over_premultiplied;
+	smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc) = proc;
 }
 
 
@@ -981,6 +1841,33 @@ void smol_canvas_pop_blend(smol_canvas_t* canvas) {
 	smol_stack_pop(&canvas->color_stack);
 }
 
+void smol_canvas_set_premultiplied(smol_canvas_t* canvas, int premultiplied) {
+
+	premultiplied = premultiplied != 0;
+	if(canvas->premultiplied == premultiplied)
+		return;
+
+	canvas->premultiplied = premultiplied;
+
+	if(premultiplied)
+		smol_image_premultiply(&canvas->draw_surface);
+	else 
+		smol_image_unpremultiply(&canvas->draw_surface);
+
+	smol_pixel_t* colors = (smol_pixel_t*)canvas->color_stack.data;
+	for(smol_u32 i = 0; i < canvas->color_stack.element_count; i++)
+		colors[i] = premultiplied ? smol_premultiply(colors[i]) : smol_unpremultiply(colors[i]);
+
+	smol_pixel_blend_func_proc* blends = (smol_pixel_blend_func_proc*)canvas->blend_funcs.data;
+	for(smol_u32 i = 0; i < canvas->blend_funcs.element_count; i++) {
+		if(premultiplied && blends[i] == smol_pixel_blend_mix)
+			blends[i] = smol_pixel_blend_over_premultiplied;
+		else if(!premultiplied && blends[i] == smol_pixel_blend_over_premultiplied)
+			blends[i] = smol_pixel_blend_mix;
+	}
+
+}
+
 void smol_canvas_set_font(smol_canvas_t* canvas, smol_font_t* font) {
 	if(canvas->font_stack.element_count == 0)
 		smol_stack_push(&canvas->font_stack, &font);
@@ -1046,6 +1933,46 @@ void smol_cavas_set_scissor_cascaded(smol_canvas_t* canvas, int x, int y, int w,
 
 }
 
+void smol_canvas_set_transform(smol_canvas_t* canvas, const smol_m3_t* transform) {
+	smol_stack_back(canvas->transform_stack, smol_m3_t) = *transform;
+}
+
+void smol_canvas_apply_transform(smol_canvas_t* canvas, const smol_m3_t* transform) {
+
+	const float* a = smol_stack_back(canvas->transform_stack, smol_m3_t).m;
+	const float* b = transform->m;
+
+	smol_stack_back(canvas->transform_stack, smol_m3_t) = smol__m3_affine(
+		a[0] * b[0] + a[1] * b[3], a[0] * b[1] + a[1] * b[4], a[0] * b[2] + a[1] * b[5] + a[2],
+		a[3] * b[0] + a[4] * b[3], a[3] * b[1] + a[4] * b[4], a[3] * b[2] + a[4] * b[5] + a[5]
+	);
+}
+
+void smol_canvas_translate(smol_canvas_t* canvas, float x, float y) {
+	smol_m3_t transform = smol__m3_affine(1.f, 0.f, x, 0.f, 1.f, y);
+	smol_canvas_apply_transform(canvas, &transform);
+}
+
+void smol_canvas_rotate(smol_canvas_t* canvas, float angle) {
+	float c = cosf(angle);
+	float s = sinf(angle);
+	smol_m3_t transform = smol__m3_affine(c, -s, 0.f, s, c, 0.f);
+	smol_canvas_apply_transform(canvas, &transform);
+}
+
+void smol_canvas_scale(smol_canvas_t* canvas, float x, float y) {
+	smol_m3_t transform = smol__m3_affine(x, 0.f, 0.f, 0.f, y, 0.f);
+	smol_canvas_apply_transform(canvas, &transform);
+}
+
+void smol_canvas_push_transform(smol_canvas_t* canvas) {
+	smol_stack_push(&canvas->transform_stack, &smol_stack_back(canvas->transform_stack, smol_m3_t));
+}
+
+void smol_canvas_pop_transform(smol_canvas_t* canvas) {
+	smol_stack_pop(&canvas->transform_stack);
+}
+
 
 void smol_canvas_draw_pixel(smol_canvas_t* canvas, int x, int y) {
 	
@@ -1088,9 +2015,7 @@ SMOL_INLINE void smol_clip_line(int* x0, int* y0, int* x1, int* y1, int edge, in
 
 }
 
-void smol_canvas_draw_line(smol_canvas_t* canvas, int x0, int y0, int x1, int y1) {
-
-	smol_rect_t rect = smol_stack_back(canvas->scissor_stack, smol_rect_t);
+static void smol__canvas_draw_line(smol_image_t* surface, smol_rect_t rect, smol_pixel_t color, smol_pixel_blend_func_proc blendfunc, int x0, int y0, int x1, int y1) {
 
 	int left = rect.left;
 	int top = rect.top;
@@ -1123,19 +2048,26 @@ void smol_canvas_draw_line(smol_canvas_t* canvas, int x0, int y0, int x1, int y1
 
 
 #if 1
-	//Clip against l edge
-	CLIP_LINE_X(x0, y0, x1, y1, left, < );
-	CLIP_LINE_Y(x0, y0, x1, y1, top, < );
-
-	CLIP_LINE_X(x1, y1, x0, y0, left, < );
-	CLIP_LINE_Y(x1, y1, x0, y0, top, < );
-
-	//Clip against r edge
-	CLIP_LINE_X(x0, y0, x1, y1, right-1, > );
-	CLIP_LINE_Y(x0, y0, x1, y1, bottom-1, > );
+	//Clipping against one edge can push the end point past the next one near the corners, 
+	//so there's a second pass and lines that still end outside miss the rect altogether
+	for(int pass = 0; pass < 2; pass++) {
+		//Clip against l edge
+		CLIP_LINE_X(x0, y0, x1, y1, left, < );
+		CLIP_LINE_Y(x0, y0, x1, y1, top, < );
+
+		CLIP_LINE_X(x1, y1, x0, y0, left, < );
+		CLIP_LINE_Y(x1, y1, x0, y0, top, < );
+
+		//Clip against r edge
+		CLIP_LINE_X(x0, y0, x1, y1, right-1, > );
+		CLIP_LINE_Y(x0, y0, x1, y1, bottom-1, > );
+
+		CLIP_LINE_X(x1, y1, x0, y0, right-1, > );
+		CLIP_LINE_Y(x1, y1, x0, y0, bottom-1, > );
+	}
 
-	CLIP_LINE_X(x1, y1, x0, y0, right-1, > );
-	CLIP_LINE_Y(x1, y1, x0, y0, bottom-1, > );
+	if(x0 < left || x0 >= right || y0 < top || y0 >= bottom || x1 < left || x1 >= right || y1 < top || y1 >= bottom)
+		return;
 
 	//smol_clip_line(&x0, &y0, &x1, &y1, left, 0, 0);
 	//smol_clip_line(&x0, &y0, &x1, &y1, top, 0, 1);
@@ -1157,6 +2089,25 @@ void smol_canvas_draw_line(smol_canvas_t* canvas, int x0, int y0, int x1, int y1
 #endif 
 #undef CLIP_LINE_X
 #undef CLIP_LINE_Y
+
+	//Grid and axis lines are drawn as a single span, the same pixels Bresenham's would step through
+	if(y0 == y1) {
+		smol_pixel_t* row = &surface->pixel_data[y0 * surface->width];
+		int l = x0 < x1 ? x0 : x1;
+		int r = x0 < x1 ? x1 : x0;
+		for(int x = l; x <= r; x++) 
+			row[x] = blendfunc(row[x], color, x, y0);
+		return;
+	}
+
+	if(x0 == x1) {
+		int t = y0 < y1 ? y0 : y1;
+		int b = y0 < y1 ? y1 : y0;
+		smol_pixel_t* pixel = &surface->pixel_data[t * surface->width + x0];
+		for(int y = t; y <= b; y++, pixel += surface->width) 
+			*pixel = blendfunc(*pixel, color, x0, y);
+		return;
+	}
 	
 	int dx = (x1 - x0);
 	int dy = (y1 - y0);
@@ -1177,11 +2128,8 @@ void smol_canvas_draw_line(smol_canvas_t* canvas, int x0, int y0, int x1, int y1
 	int err = dx + dy;
 	int err2 = 0;
 
-	smol_pixel_t color = smol_stack_back(canvas->color_stack, smol_pixel_t);
-	smol_pixel_blend_func_proc blendfunc = smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc);
-
 	for(;;) {
-		smol_image_blend_pixel(&canvas->draw_surface, x0, y0, color, blendfunc);
+		smol_image_blend_pixel(surface, x0, y0, color, blendfunc);
 		err2 = 2 * err;
 		if(err2 >= dy) {
 			if(x0 == x1) break;
@@ -1197,7 +2145,19 @@ void smol_canvas_draw_line(smol_canvas_t* canvas, int x0, int y0, int x1, int y1
 
 }
 
-void smol_canvas_draw_arrow(smol_canvas_t* canvas, int x0, int y0, int x1, int y1, int tip_width, int tip_height) {
+void smol_canvas_draw_line(smol_canvas_t* canvas, int x0, int y0, int x1, int y1) {
+
+	smol__canvas_draw_line(
+		&canvas->draw_surface, 
+		smol_stack_back(canvas->scissor_stack, smol_rect_t), 
+		smol_stack_back(canvas->color_stack, smol_pixel_t),
+		smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc),
+		x0, y0, x1, y1
+	);
+
+}
+
+void smol_canvas_draw_arrow(smol_canvas_t* canvas, int x0, int y0, int x1, int y1, int tip_width, int tip_height) {
 
 
 
@@ -1215,6 +2175,226 @@ void smol_canvas_draw_arrow(smol_canvas_t* canvas, int x0, int y0, int x1, int y
 	}
 }
 
+//Clip rect of the batched primitives, the scissor clamped to the surface
+static smol_rect_t smol__canvas_batch_clip(smol_canvas_t* canvas) {
+
+	smol_rect_t rect = smol_stack_back(canvas->scissor_stack, smol_rect_t);
+
+	if(rect.left < 0) rect.left = 0;
+	if(rect.top < 0) rect.top = 0;
+	if(rect.right > (int)canvas->draw_surface.width) rect.right = canvas->draw_surface.width;
+	if(rect.bottom > (int)canvas->draw_surface.height) rect.bottom = canvas->draw_surface.height;
+
+	return rect;
+}
+
+//Interpolates two pixels by f / 256, two channels at a time
+static SMOL_INLINE smol_u32 smol__lerp_texel(smol_u32 a, smol_u32 b, smol_u32 f) {
+	smol_u32 rb = (((a & 0x00FF00FFU) * (256 - f) + (b & 0x00FF00FFU) * f) >> 8) & 0x00FF00FFU;
+	smol_u32 ga = (((a >> 8) & 0x00FF00FFU) * (256 - f) + ((b >> 8) & 0x00FF00FFU) * f) & 0xFF00FF00U;
+	return rb | ga;
+}
+
+//Narrows [*lo, *hi) to where the pixel centers px give 0 <= base + step * px < size
+static int smol__blit_span_limit(float base, float step, float size, float* lo, float* hi) {
+
+	if(step == 0.f) 
+		return base >= 0.f && base < size;
+
+	float t0 = -base / step;
+	float t1 = (size - base) / step;
+
+	if(step < 0.f) {
+		float t = t0; t0 = t1; t1 = t;
+	}
+
+	if(t0 > *lo) *lo = t0;
+	if(t1 < *hi) *hi = t1;
+
+	return *lo < *hi;
+}
+
+//Draws the src rect of the image mapped by the affine m (the t two rows of a row major m3) into the surface.
+//Every row is walked only over the span whose pixel centers map into the src rect, with 16.16 uv steps.
+//Images with mips are sampled from the level where a pixel steps at most two texels.
+static void smol__image_blit_affine(smol_image_t* surface, smol_rect_t clip, smol_pixel_blend_func_proc blend, const float* m, smol_image_t* image, int src_x, int src_y, int src_w, int src_h, smol_image_filter filter) {
+
+	if(src_x < 0) src_w += src_x, src_x = 0;
+	if(src_y < 0) src_h += src_y, src_y = 0;
+	if(src_x + src_w > (int)image->width) src_w = image->width - src_x;
+	if(src_y + src_h > (int)image->height) src_h = image->height - src_y;
+
+	//The 16.16 coordinates need to fit into an int
+	if(src_w <= 0 || src_h <= 0 || src_w > 0x7FFF || src_h > 0x7FFF)
+		return;
+
+	float det = m[0] * m[4] - m[1] * m[3];
+	if(!(fabsf(det) > 1e-12f))
+		return;
+
+	float w = (float)src_w;
+	float h = (float)src_h;
+
+	float cx[4] = { m[2], m[0] * w + m[2], m[0] * w + m[1] * h + m[2], m[1] * h + m[2] };
+	float cy[4] = { m[5], m[3] * w + m[5], m[3] * w + m[4] * h + m[5], m[4] * h + m[5] };
+
+	float min_x = cx[0], max_x = cx[0];
+	float min_y = cy[0], max_y = cy[0];
+	for(int i = 1; i < 4; i++) {
+		if(cx[i] < min_x) min_x = cx[i];
+		if(cx[i] > max_x) max_x = cx[i];
+		if(cy[i] < min_y) min_y = cy[i];
+		if(cy[i] > max_y) max_y = cy[i];
+	}
+
+	if(min_x < (float)clip.left) min_x = (float)clip.left;
+	if(max_x > (float)clip.right) max_x = (float)clip.right;
+	if(min_y < (float)clip.top) min_y = (float)clip.top;
+	if(max_y > (float)clip.bottom) max_y = (float)clip.bottom;
+
+	if(!(min_x < max_x && min_y < max_y))
+		return;
+
+	//Canvas to image space
+	float ia = m[4] / det;
+	float ib = -m[1] / det;
+	float id = -m[3] / det;
+	float ie = m[0] / det;
+	float ic = -(ia * m[2] + ib * m[5]);
+	float ig = -(id * m[2] + ie * m[5]);
+
+	//The sampled rect, on mip level n the texel coordinates are (uv + off) * scale
+	smol_image_t* tex = image;
+	int tex_x = src_x, tex_y = src_y, tex_w = src_w, tex_h = src_h;
+	float off_u = 0.f, off_v = 0.f, scale = 1.f;
+
+	if(image->mips) {
+
+		//Squared texels per pixel along the steeper canvas axis
+		float rho = ia * ia + id * id;
+		if(ib * ib + ie * ie > rho) rho = ib * ib + ie * ie;
+
+		int level = 0;
+		while(rho >= 4.f && level < image->mips->num_levels) {
+			rho *= .25f;
+			level++;
+		}
+
+		if(level) {
+			tex = &image->mips->levels[level - 1];
+			tex_x = src_x >> level;
+			tex_y = src_y >> level;
+			tex_w = ((src_x + src_w + (1 << level) - 1) >> level) - tex_x;
+			tex_h = ((src_y + src_h + (1 << level) - 1) >> level) - tex_y;
+			off_u = (float)(src_x - (tex_x << level));
+			off_v = (float)(src_y - (tex_y << level));
+			scale = 1.f / (float)(1 << level);
+		}
+
+	}
+
+	int overwrite = blend == smol_pixel_blend_overwrite;
+	int over = blend == smol_pixel_blend_over_premultiplied;
+
+	int stride = tex->width;
+	const smol_pixel_t* texels = tex->pixel_data + tex_x + tex_y * stride;
+	int surface_w = surface->width;
+
+	smol_i32 max_u = (tex_w << 16) - 1;
+	smol_i32 max_v = (tex_h << 16) - 1;
+	float fixed_scale = scale * 65536.f;
+
+	int y0 = (int)floorf(min_y);
+	int y1 = (int)ceilf(max_y);
+
+	for(int y = y0; y < y1; y++) {
+
+		float py = y + .5f;
+		float u_row = ib * py + ic;
+		float v_row = ie * py + ig;
+
+		float lo = min_x;
+		float hi = max_x;
+
+		if(!smol__blit_span_limit(u_row, ia, w, &lo, &hi) || !smol__blit_span_limit(v_row, id, h, &lo, &hi))
+			continue;
+
+		int xs = (int)ceilf(lo - .5f);
+		int xe = (int)ceilf(hi - .5f);
+		if(xe <= xs) 
+			continue;
+
+		//Fixed point uvs of the first and last pixel, clamped into the rect against rounding, and the steps between them.
+		float uv[4] = { 
+			(ia * (xs + .5f) + u_row + off_u) * fixed_scale, (id * (xs + .5f) + v_row + off_v) * fixed_scale,
+			(ia * (xe - .5f) + u_row + off_u) * fixed_scale, (id * (xe - .5f) + v_row + off_v) * fixed_scale
+		};
+		smol_i32 fixed[4];
+		for(int i = 0; i < 4; i++) {
+			smol_i32 limit = (i & 1) ? max_v : max_u;
+			float f = uv[i];
+			if(f < 0.f) f = 0.f;
+			if(f > (float)limit) f = (float)limit;
+			fixed[i] = (smol_i32)f;
+			if(fixed[i] > limit) fixed[i] = limit;
+		}
+
+		int n = xe - xs;
+		smol_i32 u = fixed[0];
+		smol_i32 v = fixed[1];
+		smol_i32 du = n > 1 ? (fixed[2] - fixed[0]) / (n - 1) : 0;
+		smol_i32 dv = n > 1 ? (fixed[3] - fixed[1]) / (n - 1) : 0;
+
+		smol_pixel_t* dst = surface->pixel_data + y * surface_w;
+
+		if(filter == SMOL_IMAGE_FILTER_BILINEAR) {
+			for(int x = xs; x < xe; x++, u += du, v += dv) {
+
+				//Sample at uv - .5, biased by +.5 so the shifts stay on positive numbers
+				smol_i32 bu = u + 0x8000;
+				smol_i32 bv = v + 0x8000;
+				int tx1 = bu >> 16, tx0 = tx1 - 1;
+				int ty1 = bv >> 16, ty0 = ty1 - 1;
+				smol_u32 fx = (bu >> 8) & 0xFF;
+				smol_u32 fy = (bv >> 8) & 0xFF;
+
+				if(tx0 < 0) tx0 = 0;
+				if(ty0 < 0) ty0 = 0;
+				if(tx1 >= tex_w) tx1 = tex_w - 1;
+				if(ty1 >= tex_h) ty1 = tex_h - 1;
+
+				const smol_pixel_t* row0 = texels + ty0 * stride;
+				const smol_pixel_t* row1 = texels + ty1 * stride;
+
+				smol_pixel_t texel;
+				texel.pixel = smol__lerp_texel(
+					smol__lerp_texel(row0[tx0].pixel, row0[tx1].pixel, fx), 
+					smol__lerp_texel(row1[tx0].pixel, row1[tx1].pixel, fx), 
+					fy
+				);
+
+				if(overwrite)
+					dst[x] = texel;
+				else if(over)
+					dst[x].pixel = smol__over_premultiplied(dst[x].pixel, texel.pixel);
+				else
+					dst[x] = blend(dst[x], texel, x, y);
+			}
+		} else if(overwrite) {
+			for(int x = xs; x < xe; x++, u += du, v += dv)
+				dst[x] = texels[(u >> 16) + (v >> 16) * stride];
+		} else if(over) {
+			for(int x = xs; x < xe; x++, u += du, v += dv)
+				dst[x].pixel = smol__over_premultiplied(dst[x].pixel, texels[(u >> 16) + (v >> 16) * stride].pixel);
+		} else {
+			for(int x = xs; x < xe; x++, u += du, v += dv)
+				dst[x] = blend(dst[x], texels[(u >> 16) + (v >> 16) * stride], x, y);
+		}
+
+	}
+
+}
+
 void smol_canvas_draw_image(smol_canvas_t* canvas, smol_image_t* image, int x, int y) {
 
 	smol_rect_t rect = smol_stack_back(canvas->scissor_stack, smol_rect_t);
@@ -1262,48 +2442,88 @@ void smol_canvas_draw_image(smol_canvas_t* canvas, smol_image_t* image, int x, i
 	}
 }
 
-void smol_canvas_draw_image_subrect_streched(smol_canvas_t* canvas, smol_image_t* image, int x, int y, int dst_w, int dst_h, int src_x, int src_y, int src_w, int src_h) {
-	
-	smol_rect_t rect = smol_stack_back(canvas->scissor_stack, smol_rect_t);
-	smol_pixel_blend_func_proc blend = smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc);
+//Finds or makes the dst_w x dst_h downscale of the src rect of an image with mips
+static smol_image_t* smol__canvas_scaled_image(smol_canvas_t* canvas, smol_image_t* image, int src_x, int src_y, int src_w, int src_h, int dst_w, int dst_h) {
+
+	smol_scaled_image_t* victim = &canvas->scaled_images[0];
+	smol_u32 now = ++canvas->scaled_clock;
+
+	for(int i = 0; i < SMOL_CANVAS_SCALED_IMAGE_CACHE_SIZE; i++) {
+		smol_scaled_image_t* entry = &canvas->scaled_images[i];
+		if(
+			entry->last_use && entry->source == image->pixel_data && entry->stamp == image->mips->stamp &&
+			entry->src_x == src_x && entry->src_y == src_y && entry->src_w == src_w && entry->src_h == src_h &&
+			entry->image.width == (smol_u32)dst_w && entry->image.height == (smol_u32)dst_h
+		) {
+			entry->last_use = now;
+			return &entry->image;
+		}
+		if(entry->last_use < victim->last_use)
+			victim = entry;
+	}
 
-	int left = rect.left;
-	int top = rect.top;
-	int right = rect.right;
-	int bottom = rect.bottom;
+	if(victim->image.width * victim->image.height != (smol_u32)(dst_w * dst_h))
+		smol_image_destroy(&victim->image);
 
-	int l = x;
-	int r = x + dst_w;
-	int t = y;
-	int b = y + dst_h;
+	if(!victim->image.pixel_data)
+		victim->image = smol_image_create(dst_w, dst_h);
 
-	if(l < left) {
-		src_x += left-l;
-		l += left-l;
-	}
+	victim->image.width = dst_w;
+	victim->image.height = dst_h;
+	memset(victim->image.pixel_data, 0, dst_w * dst_h * sizeof(smol_pixel_t));
 
-	if(t < top) {
-		src_y += top-t;
-		t += top-t;
-	}
+	float m[6] = {
+		(float)dst_w / (float)src_w, 0.f, 0.f,
+		0.f, (float)dst_h / (float)src_h, 0.f
+	};
+	smol_rect_t rect = { 0, 0, dst_w, dst_h };
+	smol__image_blit_affine(&victim->image, rect, smol_pixel_blend_overwrite, m, image, src_x, src_y, src_w, src_h, SMOL_IMAGE_FILTER_BILINEAR);
 
-	if(r > right) {
-		//src_w -= (r - cw);
-		r -= right;
-	}
+	victim->source = image->pixel_data;
+	victim->stamp = image->mips->stamp;
+	victim->src_x = src_x;
+	victim->src_y = src_y;
+	victim->src_w = src_w;
+	victim->src_h = src_h;
+	victim->last_use = now;
+
+	return &victim->image;
+}
+
+void smol_canvas_draw_image_subrect_streched(smol_canvas_t* canvas, smol_image_t* image, int x, int y, int dst_w, int dst_h, int src_x, int src_y, int src_w, int src_h) {
 	
-	if(b > bottom) {
-		//src_h -= (b - ch);
-		b -= bottom;
-	}
+	if(src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0)
+		return;
 
+	smol_rect_t clip = smol__canvas_batch_clip(canvas);
+	smol_pixel_blend_func_proc blend = smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc);
 
-	for(int py = t, iy = 0; py < b; py++, iy++)
-	for(int px = l, ix = 0; px < r; px++, ix++) 
-	{
-		smol_image_blend_pixel(&canvas->draw_surface, px, py, smol_image_getpixel(image, src_x+ix*src_w/dst_w, src_y+iy*src_h/dst_h), blend);
+	//Downscales of images with mips are filtered once and then copied
+	if(image->mips && (dst_w < src_w || dst_h < src_h) && dst_w * dst_h <= SMOL_CANVAS_SCALED_IMAGE_MAX_PIXELS) {
+		float m[6] = { 1.f, 0.f, (float)x, 0.f, 1.f, (float)y };
+		smol_image_t* scaled = smol__canvas_scaled_image(canvas, image, src_x, src_y, src_w, src_h, dst_w, dst_h);
+		smol__image_blit_affine(&canvas->draw_surface, clip, blend, m, scaled, 0, 0, dst_w, dst_h, SMOL_IMAGE_FILTER_NEAREST);
+		return;
 	}
 
+	float m[6] = {
+		(float)dst_w / (float)src_w, 0.f, (float)x,
+		0.f, (float)dst_h / (float)src_h, (float)y
+	};
+
+	smol__image_blit_affine(&canvas->draw_surface, clip, blend, m, image, src_x, src_y, src_w, src_h, SMOL_IMAGE_FILTER_NEAREST);
+
+}
+
+void smol_canvas_draw_image_transformed(smol_canvas_t* canvas, smol_image_t* image, smol_image_filter filter) {
+	smol_canvas_draw_image_subrect_transformed(canvas, image, 0, 0, image->width, image->height, filter);
+}
+
+void smol_canvas_draw_image_subrect_transformed(smol_canvas_t* canvas, smol_image_t* image, int src_x, int src_y, int src_w, int src_h, smol_image_filter filter) {
+	smol__image_blit_affine(
+		&canvas->draw_surface, smol__canvas_batch_clip(canvas), smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc), 
+		smol_stack_back(canvas->transform_stack, smol_m3_t).m, image, src_x, src_y, src_w, src_h, filter
+	);
 }
 
 void smol_canvas_draw_circle(smol_canvas_t* canvas, int xc, int yc, int rad) {
@@ -1449,170 +2669,713 @@ void smol_canvas_fill_rect(smol_canvas_t* canvas, int x, int y, int w, int h) {
 
 }
 
-void smol_canvas_fill_triangle(smol_canvas_t* canvas, int x0, int y0, int x1, int y1, int x2, int y2) {
+//Items of a batch binned by SMOL_CANVAS_BATCH_BAND_HEIGHT row bands, each band lists the items touching it in 
+//submission order. A pixel lies in exactly one band, so the bands can be drawn in any order (or in parallel) 
+//and the result still blends like the items were drawn one by one.
+typedef struct _smol__canvas_bins_t {
+	int top;
+	int num_bands;
+	int* offsets; //num_bands + 1 offsets into items
+	int* items;
+} smol__canvas_bins_t;
 
-	
-	smol_pixel_t color = smol_stack_back(canvas->color_stack, smol_pixel_t);
-	smol_pixel_blend_func_proc blend = smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc);
+//Bins the items by the rows of their bounds, bounds have to be clipped to clip already, empty bounds are skipped
+static int smol__canvas_bin_rows(smol__canvas_bins_t* bins, const smol_rect_t* bounds, int count, smol_rect_t clip) {
 
-#define TMP_SWAP(a, b) { tmp = a; a = b; b = tmp; }
+	const int band = SMOL_CANVAS_BATCH_BAND_HEIGHT;
 
-#define INIT_X(dx, sx) if(dx < 0) sx = -sx, dx = -dx
-#define INIT_Y(dy, sy) if(dy > 0) sy = -sy, dy = -dy
+	bins->top = clip.top;
+	bins->num_bands = (clip.bottom - clip.top + band - 1) / band;
+	bins->offsets = NULL;
+	bins->items = NULL;
 
-#define ITER_X(error, error2, xc, xt, delx, dely, sx) \
-	error2 = error+error; \
-	if(error2 >= dely) { \
-		if(xc == xt) break; \
-		error += dely; \
-		xc += sx; \
+	if(bins->num_bands <= 0)
+		return 0;
+
+	bins->offsets = (int*)SMOL_ALLOC((bins->num_bands + 1) * sizeof(int));
+	memset(bins->offsets, 0, (bins->num_bands + 1) * sizeof(int));
+
+	int total = 0;
+	for(int i = 0; i < count; i++) {
+		if(bounds[i].top >= bounds[i].bottom || bounds[i].left >= bounds[i].right) 
+			continue;
+		int first = (bounds[i].top - clip.top) / band;
+		int last = (bounds[i].bottom - 1 - clip.top) / band;
+		for(int b = first; b <= last; b++)
+			bins->offsets[b + 1]++;
+		total += last - first + 1;
 	}
 
-#define ITER_Y(error, error2, yc, yt, delx, dely, sy) \
-	if(error2 <= dely) { \
-		if(yc == yt) break; \
-		error += delx; \
-		yc += sy; \
-	}	
+	for(int b = 0; b < bins->num_bands; b++)
+		bins->offsets[b + 1] += bins->offsets[b];
 
-	int tmp;
+	bins->items = (int*)SMOL_ALLOC((total ? total : 1) * sizeof(int));
 
-	if(y0 > y1) {
-		TMP_SWAP(x0, x1);
-		TMP_SWAP(y0, y1);
+	//Offsets are used as cursors, after this offsets[b] holds the end of band b
+	for(int i = 0; i < count; i++) {
+		if(bounds[i].top >= bounds[i].bottom || bounds[i].left >= bounds[i].right) 
+			continue;
+		int first = (bounds[i].top - clip.top) / band;
+		int last = (bounds[i].bottom - 1 - clip.top) / band;
+		for(int b = first; b <= last; b++)
+			bins->items[bins->offsets[b]++] = i;
 	}
 
-	if(y1 > y2) {
-		TMP_SWAP(x1, x2);
-		TMP_SWAP(y1, y2);
+	for(int b = bins->num_bands; b > 0; b--)
+		bins->offsets[b] = bins->offsets[b - 1];
+	bins->offsets[0] = 0;
+
+	return total;
+}
+
+static void smol__canvas_free_bins(smol__canvas_bins_t* bins) {
+	if(bins->offsets) SMOL_FREE(bins->offsets);
+	if(bins->items) SMOL_FREE(bins->items);
+	bins->offsets = NULL;
+	bins->items = NULL;
+}
+
+static void smol__canvas_fill_span(smol_image_t* surface, int y, int x0, int x1, smol_pixel_t color, smol_pixel_blend_func_proc blend) {
+
+	smol_pixel_t* row = &surface->pixel_data[y * surface->width];
+
+	if(blend == smol_pixel_blend_overwrite) {
+		for(int x = x0; x < x1; x++) 
+			row[x] = color;
+	} else if(blend == smol_pixel_blend_over_premultiplied) {
+		if(x1 > x0)
+			smol__over_premultiplied_span(row + x0, x1 - x0, color);
+	} else {
+		for(int x = x0; x < x1; x++) 
+			row[x] = blend(row[x], color, x, y);
 	}
 
-	if(y0 > y1) {
-		TMP_SWAP(x0, x1);
-		TMP_SWAP(y0, y1);
+}
+
+void smol_canvas_fill_rects(smol_canvas_t* canvas, const smol_canvas_rect_t* rects, const smol_pixel_t* colors, int count) {
+
+	smol_pixel_t color = smol_stack_back(canvas->color_stack, smol_pixel_t);
+	smol_pixel_blend_func_proc blend = smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc);
+	smol_rect_t clip = smol__canvas_batch_clip(canvas);
+
+	if(count <= 0)
+		return;
+
+	smol_rect_t* bounds = (smol_rect_t*)SMOL_ALLOC(count * sizeof(smol_rect_t));
+	for(int i = 0; i < count; i++) {
+		smol_rect_t r = { rects[i].x, rects[i].y, rects[i].x + rects[i].w, rects[i].y + rects[i].h };
+		if(r.left < clip.left) r.left = clip.left;
+		if(r.top < clip.top) r.top = clip.top;
+		if(r.right > clip.right) r.right = clip.right;
+		if(r.bottom > clip.bottom) r.bottom = clip.bottom;
+		bounds[i] = r;
 	}
 
-	{
+	smol__canvas_bins_t bins;
+	smol__canvas_bin_rows(&bins, bounds, count, clip);
 
-		int px[2] = { x0, x0 };
-		int py[2] = { y0, y0 };
-		int dx[2] = { x1 - px[0], x2 - px[0] };
-		int dy[2] = { y1 - py[0], y2 - py[0] };
-		int stpx[2] = { 1, 1 };
-		int stpy[2] = { -1, -1 };
-		int err[2] = { dx[0] + dy[0], dx[1] + dy[1] };
-		int err_dbl[2] = { err[0] + err[0], err[1] + err[1] };
+	for(int band = 0; band < bins.num_bands; band++) {
 
-		if(x1 > x2) {
+		int band_top = bins.top + band * SMOL_CANVAS_BATCH_BAND_HEIGHT;
+		int band_bottom = band_top + SMOL_CANVAS_BATCH_BAND_HEIGHT;
 
-			TMP_SWAP(dx[0], dx[1]);
-			TMP_SWAP(dy[0], dy[1]);
+		for(int i = bins.offsets[band]; i < bins.offsets[band + 1]; i++) {
 
-			TMP_SWAP(stpx[0], stpx[1]);
-			TMP_SWAP(stpy[0], stpy[1]);
+			int item = bins.items[i];
+			smol_rect_t r = bounds[item];
+			smol_pixel_t c = colors ? smol__canvas_color(canvas, colors[item]) : color;
 
-			TMP_SWAP(err[0], err[1]);
-			TMP_SWAP(err_dbl[0], err_dbl[1]);
+			int t = r.top > band_top ? r.top : band_top;
+			int b = r.bottom < band_bottom ? r.bottom : band_bottom;
 
+			for(int y = t; y < b; y++)
+				smol__canvas_fill_span(&canvas->draw_surface, y, r.left, r.right, c, blend);
 		}
 
+	}
 
+	smol__canvas_free_bins(&bins);
+	SMOL_FREE(bounds);
 
-		INIT_X(dx[0], stpx[0]);
-		INIT_Y(dy[0], stpy[0]);
+}
 
-		INIT_X(dx[1], stpx[1]);
-		INIT_Y(dy[1], stpy[1]);
+void smol_canvas_draw_lines(smol_canvas_t* canvas, const smol_canvas_line_t* lines, const smol_pixel_t* colors, int count) {
 
+	//Lines are thin and long, binning would split every one of them so they're drawn in order instead
+	smol_pixel_t color = smol_stack_back(canvas->color_stack, smol_pixel_t);
+	smol_pixel_blend_func_proc blend = smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc);
+	smol_rect_t clip = smol__canvas_batch_clip(canvas);
 
+	for(int i = 0; i < count; i++) {
+		const smol_canvas_line_t* l = &lines[i];
+		smol__canvas_draw_line(&canvas->draw_surface, clip, colors ? smol__canvas_color(canvas, colors[i]) : color, blend, l->x0, l->y0, l->x1, l->y1);
+	}
 
+}
 
+void smol_canvas_fill_circles(smol_canvas_t* canvas, const smol_canvas_circle_t* circles, const smol_pixel_t* colors, int count) {
 
-		for(;;) {
+	smol_pixel_t color = smol_stack_back(canvas->color_stack, smol_pixel_t);
+	smol_pixel_blend_func_proc blend = smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc);
+	smol_rect_t clip = smol__canvas_batch_clip(canvas);
 
-			for(int i = px[0]; i <= px[1]; i++) {
-				smol_image_blend_pixel(&canvas->draw_surface, i, py[0], color, blend);
-			}
+	if(count <= 0)
+		return;
 
-			ITER_X(err[0], err_dbl[0], px[0], x1, dx[0], dy[0], stpx[0])
-			ITER_Y(err[0], err_dbl[0], py[0], y1, dx[0], dy[0], stpy[0])
+	//Half widths of each circle's rows, from the same midpoint walk as smol_canvas_fill_circle
+	int total_rows = 0;
+	for(int i = 0; i < count; i++)
+		total_rows += (circles[i].rad > 0 ? circles[i].rad : 0) + 1;
 
-			ITER_X(err[1], err_dbl[1], px[1], x2, dx[1], dy[1], stpx[1])
-			ITER_Y(err[1], err_dbl[1], py[1], y2, dx[1], dy[1], stpy[1])
-		}
+	int* offsets = (int*)SMOL_ALLOC(count * sizeof(int));
+	int* half_widths = (int*)SMOL_ALLOC(total_rows * sizeof(int));
+	smol_rect_t* bounds = (smol_rect_t*)SMOL_ALLOC(count * sizeof(smol_rect_t));
+
+	for(int i = 0, offset = 0; i < count; i++) {
+
+		int xc = circles[i].xc;
+		int yc = circles[i].yc;
+		int rad = circles[i].rad > 0 ? circles[i].rad : 0;
+		int* rows = &half_widths[offset];
+
+		offsets[i] = offset;
+		offset += rad + 1;
+
+		//Outside of the clip the circle isn't walked at all
+		smol_rect_t r = { xc - rad, yc - rad, xc + rad, yc + rad + 1 };
+		if(r.left < clip.left) r.left = clip.left;
+		if(r.top < clip.top) r.top = clip.top;
+		if(r.right > clip.right) r.right = clip.right;
+		if(r.bottom > clip.bottom) r.bottom = clip.bottom;
+		bounds[i] = r;
+
+		if(r.left >= r.right || r.top >= r.bottom)
+			continue;
+
+		memset(rows, 0, (rad + 1) * sizeof(int));
+
+		int x = -rad;
+		int y = 0;
+		int err = 2 - 2 * rad;
+		int last_y = -1;
+
+		//x only grows, so the first step on a row is the widest one
+		do {
+			if(y != last_y) {
+				rows[y] = -x;
+				last_y = y;
+			}
+
+			int e = err;
+			if(e <= y) err += 2 * ++y + 1;
+			if(e > x || err > y)
+				err += 2 * ++x + 1;
+		} while(x < 0);
 
 	}
 
-	{
+	smol__canvas_bins_t bins;
+	smol__canvas_bin_rows(&bins, bounds, count, clip);
+
+	for(int band = 0; band < bins.num_bands; band++) {
 
-		int px[2] = { x2, x2 };
-		int py[2] = { y2, y2 };
-		int dx[2] = { x0 - px[0], x1 - px[0] };
-		int dy[2] = { y0 - py[0], y1 - py[0] };
-		int stpx[2] = { 1, 1 };
-		int stpy[2] = { -1, -1 };
-		int err[2] = { dx[0] + dy[0], dx[1] + dy[1] };
-		int err_dbl[2] = { err[0] + err[0], err[1] + err[1] };
+		int band_top = bins.top + band * SMOL_CANVAS_BATCH_BAND_HEIGHT;
+		int band_bottom = band_top + SMOL_CANVAS_BATCH_BAND_HEIGHT;
 
+		for(int i = bins.offsets[band]; i < bins.offsets[band + 1]; i++) {
 
-		if(x0 > x1) {
+			int item = bins.items[i];
+			smol_rect_t r = bounds[item];
+			const int* rows = &half_widths[offsets[item]];
+			smol_pixel_t c = colors ? smol__canvas_color(canvas, colors[item]) : color;
+			int xc = circles[item].xc;
+			int yc = circles[item].yc;
 
-			TMP_SWAP(dx[0], dx[1]);
-			TMP_SWAP(dy[0], dy[1]);
+			int t = r.top > band_top ? r.top : band_top;
+			int b = r.bottom < band_bottom ? r.bottom : band_bottom;
 
-			TMP_SWAP(stpx[0], stpx[1]);
-			TMP_SWAP(stpy[0], stpy[1]);
+			for(int y = t; y < b; y++) {
 
-			TMP_SWAP(err[0], err[1]);
-			TMP_SWAP(err_dbl[0], err_dbl[1]);
+				int half_width = rows[y < yc ? yc - y : y - yc];
+				int x0 = xc - half_width;
+				int x1 = xc + half_width;
 
+				if(x0 < r.left) x0 = r.left;
+				if(x1 > r.right) x1 = r.right;
+
+				smol__canvas_fill_span(&canvas->draw_surface, y, x0, x1, c, blend);
+			}
 		}
 
+	}
+
+	smol__canvas_free_bins(&bins);
+	SMOL_FREE(bounds);
+	SMOL_FREE(half_widths);
+	SMOL_FREE(offsets);
 
+}
+
+//An edge of the scanline filler, x is where the edge crosses the center of the current scanline
+typedef struct _smol__fill_edge_t {
+	float x;
+	float dxdy;
+	int y_start; //First scanline whose center the edge crosses
+	int y_end;   //The scanline after the last one
+	int winding; //+1 going down, -1 going up
+} smol__fill_edge_t;
+
+//A piece of the outline for the coverage accumulation, already split at the scissor's left and right edges
+typedef struct _smol__fill_segment_t {
+	float x0, y0;
+	float x1, y1;
+} smol__fill_segment_t;
+
+static smol_pixel_t smol__canvas_blend_coverage(smol_pixel_t dst, smol_pixel_t color, smol_u32 coverage, smol_pixel_blend_func_proc blend, smol_u32 x, smol_u32 y) {
+
+	//Overwriting a partly covered pixel would make the edge jagged again, so it's mixed instead
+	if(blend == smol_pixel_blend_overwrite) {
+		smol_pixel_t res;
+		res.r = (smol_u8)(dst.r + (((int)color.r - (int)dst.r) * (int)coverage) / 255);
+		res.g = (smol_u8)(dst.g + (((int)color.g - (int)dst.g) * (int)coverage) / 255);
+		res.b = (smol_u8)(dst.b + (((int)color.b - (int)dst.b) * (int)coverage) / 255);
+		res.a = (smol_u8)(dst.a + (((int)color.a - (int)dst.a) * (int)coverage) / 255);
+		return res;
+	}
 
-		INIT_X(dx[0], stpx[0]);
-		INIT_Y(dy[0], stpy[0]);
+	//Premultiplied colors scale as a whole
+	if(blend == smol_pixel_blend_over_premultiplied) {
+		dst.pixel = smol__over_premultiplied(dst.pixel, smol__scale_texel(color.pixel, coverage));
+		return dst;
+	}
+
+	color.a = (smol_u8)((color.a * coverage) / 255);
+	return blend(dst, color, x, y);
+}
+
+static void smol__canvas_fill_path_scanline(smol_canvas_t* canvas, smol_rect_t clip, const smol_canvas_point_t* points, const int* contour_sizes, int num_contours, int nonzero) {
+
+	smol_pixel_t color = smol_stack_back(canvas->color_stack, smol_pixel_t);
+	smol_pixel_blend_func_proc blend = smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc);
 
-		INIT_X(dx[1], stpx[1]);
-		INIT_Y(dy[1], stpy[1]);
+	int num_points = 0;
+	for(int c = 0; c < num_contours; c++)
+		num_points += contour_sizes[c];
 
+	smol__fill_edge_t* edges = (smol__fill_edge_t*)SMOL_ALLOC(num_points * sizeof(smol__fill_edge_t));
+	int num_edges = 0;
+	int y_min = clip.bottom;
+	int y_max = clip.top;
 
-		for(;;) {
+	for(int c = 0, base = 0; c < num_contours; base += contour_sizes[c++]) {
+		for(int i = 0; i < contour_sizes[c]; i++) {
 
-			for(int i = px[0]; i <= px[1]; i++) {
-				smol_image_blend_pixel(&canvas->draw_surface, i, py[0], color, blend);
+			smol_canvas_point_t p0 = points[base + i];
+			smol_canvas_point_t p1 = points[base + (i + 1) % contour_sizes[c]];
+			int winding = 1;
+
+			if(p0.y > p1.y) {
+				smol_canvas_point_t tmp = p0;
+				p0 = p1;
+				p1 = tmp;
+				winding = -1;
 			}
 
-			ITER_X(err[0], err_dbl[0], px[0], x1, dx[0], dy[0], stpx[0])
-			ITER_Y(err[0], err_dbl[0], py[0], y1, dx[0], dy[0], stpy[0])
+			//Scanline y is sampled at y + .5, the edges are clipped to the scissor's rows right away
+			float fy0 = ceilf(p0.y - .5f);
+			float fy1 = ceilf(p1.y - .5f);
+			int y_start = fy0 < (float)clip.top ? clip.top : fy0 > (float)clip.bottom ? clip.bottom : (int)fy0;
+			int y_end = fy1 < (float)clip.top ? clip.top : fy1 > (float)clip.bottom ? clip.bottom : (int)fy1;
+
+			if(y_start >= y_end)
+				continue;
 
-			ITER_X(err[1], err_dbl[1], px[1], x2, dx[1], dy[1], stpx[1])
-			ITER_Y(err[1], err_dbl[1], py[1], y2, dx[1], dy[1], stpy[1])
+			smol__fill_edge_t* e = &edges[num_edges++];
+			e->dxdy = (p1.x - p0.x) / (p1.y - p0.y);
+			e->x = p0.x + ((float)y_start + .5f - p0.y) * e->dxdy;
+			e->y_start = y_start;
+			e->y_end = y_end;
+			e->winding = winding;
+
+			if(y_start < y_min) y_min = y_start;
+			if(y_end > y_max) y_max = y_end;
 		}
+	}
 
+	if(!num_edges) {
+		SMOL_FREE(edges);
+		return;
 	}
 
+	//Edge table, the edges bucketed by the scanline they start on
+	int num_rows = y_max - y_min;
+	int* table = (int*)SMOL_ALLOC((num_rows + 1) * sizeof(int));
+	int* order = (int*)SMOL_ALLOC(num_edges * sizeof(int));
+	smol__fill_edge_t** active = (smol__fill_edge_t**)SMOL_ALLOC(num_edges * sizeof(smol__fill_edge_t*));
+	int num_active = 0;
+
+	memset(table, 0, (num_rows + 1) * sizeof(int));
+	for(int i = 0; i < num_edges; i++)
+		table[edges[i].y_start - y_min + 1]++;
+	for(int r = 0; r < num_rows; r++)
+		table[r + 1] += table[r];
+	for(int i = 0; i < num_edges; i++)
+		order[table[edges[i].y_start - y_min]++] = i;
+	for(int r = num_rows; r > 0; r--)
+		table[r] = table[r - 1];
+	table[0] = 0;
+
+	for(int y = y_min; y < y_max; y++) {
+
+		int kept = 0;
+		for(int i = 0; i < num_active; i++)
+			if(active[i]->y_end > y) 
+				active[kept++] = active[i];
+		num_active = kept;
+
+		for(int k = table[y - y_min]; k < table[y - y_min + 1]; k++)
+			active[num_active++] = &edges[order[k]];
+
+		//The edges move little from one scanline to the next, so they're nearly sorted already
+		for(int i = 1; i < num_active; i++) {
+			smol__fill_edge_t* e = active[i];
+			int j = i - 1;
+			for(; j >= 0 && active[j]->x > e->x; j--)
+				active[j + 1] = active[j];
+			active[j + 1] = e;
+		}
+
+		int winding = 0;
+		float span_start = 0.f;
+
+		for(int i = 0; i < num_active; i++) {
+
+			int was_inside = nonzero ? (winding != 0) : (winding & 1);
+			winding += active[i]->winding;
+			int inside = nonzero ? (winding != 0) : (winding & 1);
+
+			if(!was_inside && inside) {
+				span_start = active[i]->x;
+			} else if(was_inside && !inside) {
+				//Pixels whose centers lie within [span_start, x)
+				float fx0 = ceilf(span_start - .5f);
+				float fx1 = ceilf(active[i]->x - .5f);
+				int x0 = fx0 < (float)clip.left ? clip.left : fx0 > (float)clip.right ? clip.right : (int)fx0;
+				int x1 = fx1 < (float)clip.left ? clip.left : fx1 > (float)clip.right ? clip.right : (int)fx1;
+				if(x0 < x1)
+					smol__canvas_fill_span(&canvas->draw_surface, y, x0, x1, color, blend);
+			}
+		}
 
-#undef ITER_X
-#undef ITER_Y
+		for(int i = 0; i < num_active; i++)
+			active[i]->x += active[i]->dxdy;
+	}
 
-#undef INIT_X
-#undef INIT_Y
+	SMOL_FREE(active);
+	SMOL_FREE(order);
+	SMOL_FREE(table);
+	SMOL_FREE(edges);
 
-#undef TMP_SWAP
 }
 
-void smol_canvas_draw_text(smol_canvas_t* canvas, int tx, int ty, int scale, const char* str) {
+//Adds the signed area a segment covers to each cell of the rows it crosses, a prefix sum over a row then gives the 
+//coverage of each pixel. Coordinates are relative to the buffer, x within [0, width].
+static void smol__fill_accumulate(float* acc, int stride, int num_rows, float width, float x0, float y0, float x1, float y1) {
+
+	float dir = 1.f;
+
+	if(y0 == y1)
+		return;
+
+	if(y0 > y1) {
+		float tmp;
+		tmp = x0; x0 = x1; x1 = tmp;
+		tmp = y0; y0 = y1; y1 = tmp;
+		dir = -1.f;
+	}
+
+	float dxdy = (x1 - x0) / (y1 - y0);
+	float x = x0;
+	int y_first = (int)floorf(y0);
+	int y_last = (int)ceilf(y1);
+
+	if(y0 < 0.f) {
+		x -= y0 * dxdy;
+		y_first = 0;
+	}
+	if(y_last > num_rows) 
+		y_last = num_rows;
+
+	for(int y = y_first; y < y_last; y++) {
+
+		float* row = &acc[y * stride];
+		float dy = (y1 < (float)(y + 1) ? y1 : (float)(y + 1)) - (y0 > (float)y ? y0 : (float)y);
+		float x_next = x + dxdy * dy;
+		float d = dy * dir;
+
+		//The stepping can drift a hair past the clamped edges
+		float xs = x < 0.f ? 0.f : x > width ? width : x;
+		float xe = x_next < 0.f ? 0.f : x_next > width ? width : x_next;
+		float xa = xs < xe ? xs : xe;
+		float xb = xs < xe ? xe : xs;
+
+		float xa_floor = floorf(xa);
+		float xb_ceil = ceilf(xb);
+		int xai = (int)xa_floor;
+		int xbi = (int)xb_ceil;
+
+		if(xbi <= xai + 1) {
+			float xmf = .5f * (xs + xe) - xa_floor;
+			row[xai] += d - d * xmf;
+			row[xai + 1] += d * xmf;
+		} else {
+			float s = 1.f / (xb - xa);
+			float xaf = xa - xa_floor;
+			float a0 = .5f * s * (1.f - xaf) * (1.f - xaf);
+			float xbf = xb - xb_ceil + 1.f;
+			float am = .5f * s * xbf * xbf;
+
+			row[xai] += d * a0;
+			if(xbi == xai + 2) {
+				row[xai + 1] += d * (1.f - a0 - am);
+			} else {
+				float a1 = s * (1.5f - xaf);
+				row[xai + 1] += d * (a1 - a0);
+				for(int xi = xai + 2; xi < xbi - 1; xi++)
+					row[xi] += d * s;
+				float a2 = a1 + (float)(xbi - xai - 3) * s;
+				row[xbi - 1] += d * (1.f - a2 - am);
+			}
+			row[xbi] += d * am;
+		}
+
+		x = x_next;
+	}
+
+}
+
+static void smol__canvas_fill_path_coverage(smol_canvas_t* canvas, smol_rect_t clip, const smol_canvas_point_t* points, const int* contour_sizes, int num_contours, int nonzero) {
 
-	smol_font_t* font = smol_stack_back(canvas->font_stack, smol_font_t*);
 	smol_pixel_t color = smol_stack_back(canvas->color_stack, smol_pixel_t);
 	smol_pixel_blend_func_proc blend = smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc);
-	smol_rect_t rect = smol_stack_back(canvas->scissor_stack, smol_rect_t);
+	smol_image_t* surface = &canvas->draw_surface;
+
+	int num_points = 0;
+	for(int c = 0; c < num_contours; c++)
+		num_points += contour_sizes[c];
+
+	//Everything left of the scissor only adds winding, and everything right of it isn't seen at all, so 
+	//the outline is split at both edges and the outside pieces are flattened onto them
+	smol__fill_segment_t* segments = (smol__fill_segment_t*)SMOL_ALLOC(3 * num_points * sizeof(smol__fill_segment_t));
+	int num_segments = 0;
+	float left = (float)clip.left;
+	float right = (float)clip.right;
+
+	for(int c = 0, base = 0; c < num_contours; base += contour_sizes[c++]) {
+		for(int i = 0; i < contour_sizes[c]; i++) {
+
+			smol_canvas_point_t p0 = points[base + i];
+			smol_canvas_point_t p1 = points[base + (i + 1) % contour_sizes[c]];
+
+			if(p0.y == p1.y || (p0.y < (float)clip.top && p1.y < (float)clip.top) || (p0.y >= (float)clip.bottom && p1.y >= (float)clip.bottom))
+				continue;
+
+			float cuts[4] = { 0.f, 0.f, 0.f, 1.f };
+			int num_cuts = 1;
+			float tl = (left - p0.x) / (p1.x - p0.x);
+			float tr = (right - p0.x) / (p1.x - p0.x);
+			if(tl > tr) { float tmp = tl; tl = tr; tr = tmp; }
+			if(tl > 0.f && tl < 1.f) cuts[num_cuts++] = tl;
+			if(tr > 0.f && tr < 1.f) cuts[num_cuts++] = tr;
+			cuts[num_cuts] = 1.f;
+
+			for(int k = 0; k < num_cuts; k++) {
+				smol__fill_segment_t* s = &segments[num_segments++];
+				float xa = p0.x + (p1.x - p0.x) * cuts[k];
+				float xb = p0.x + (p1.x - p0.x) * cuts[k + 1];
+				s->x0 = (xa < left ? left : xa > right ? right : xa) - left;
+				s->x1 = (xb < left ? left : xb > right ? right : xb) - left;
+				s->y0 = p0.y + (p1.y - p0.y) * cuts[k];
+				s->y1 = p0.y + (p1.y - p0.y) * cuts[k + 1];
+			}
+		}
+	}
+
+	//Segments are binned by the bands they touch, the accumulation buffer only has to hold one band
+	smol_rect_t* bounds = (smol_rect_t*)SMOL_ALLOC((num_segments ? num_segments : 1) * sizeof(smol_rect_t));
+	for(int i = 0; i < num_segments; i++) {
+		float t = floorf(segments[i].y0 < segments[i].y1 ? segments[i].y0 : segments[i].y1);
+		float b = ceilf(segments[i].y0 < segments[i].y1 ? segments[i].y1 : segments[i].y0);
+		smol_rect_t r = { clip.left, clip.top, clip.left + 1, clip.bottom };
+		if(t > (float)r.top) r.top = t > (float)clip.bottom ? clip.bottom : (int)t;
+		if(b < (float)r.bottom) r.bottom = b < (float)clip.top ? clip.top : (int)b;
+		bounds[i] = r;
+	}
+
+	smol__canvas_bins_t bins;
+	smol__canvas_bin_rows(&bins, bounds, num_segments, clip);
+
+	int width = clip.right - clip.left;
+	int stride = width + 2;
+	float* acc = (float*)SMOL_ALLOC(stride * SMOL_CANVAS_BATCH_BAND_HEIGHT * sizeof(float));
+	smol_u8* coverage = (smol_u8*)SMOL_ALLOC(width + 1);
+
+	//Cells are cleared again as they're read, so this is the only full clear
+	memset(acc, 0, stride * SMOL_CANVAS_BATCH_BAND_HEIGHT * sizeof(float));
+
+	for(int band = 0; band < bins.num_bands && width > 0; band++) {
+
+		if(bins.offsets[band] == bins.offsets[band + 1])
+			continue;
+
+		int band_top = bins.top + band * SMOL_CANVAS_BATCH_BAND_HEIGHT;
+		int band_rows = clip.bottom - band_top < SMOL_CANVAS_BATCH_BAND_HEIGHT ? clip.bottom - band_top : SMOL_CANVAS_BATCH_BAND_HEIGHT;
+
+		float min_x = (float)width;
+		float max_x = 0.f;
+
+		for(int i = bins.offsets[band]; i < bins.offsets[band + 1]; i++) {
+			const smol__fill_segment_t* s = &segments[bins.items[i]];
+			smol__fill_accumulate(acc, stride, band_rows, (float)width, s->x0, s->y0 - band_top, s->x1, s->y1 - band_top);
+			if(s->x0 < min_x) min_x = s->x0;
+			if(s->x1 < min_x) min_x = s->x1;
+			if(s->x0 > max_x) max_x = s->x0;
+			if(s->x1 > max_x) max_x = s->x1;
+		}
+
+		//Nothing is covered outside of the band's outline, and no cell past max_x + 1 is touched
+		int x_first = (int)floorf(min_x);
+		int x_cells = (int)ceilf(max_x) + 2;
+		int x_last = x_cells - 1 < width ? x_cells - 1 : width;
+		if(x_first > x_last) x_first = x_last;
+
+		for(int row = 0; row < band_rows; row++) {
+
+			float* cells = &acc[row * stride];
+			int y = band_top + row;
+			float area = 0.f;
+
+			//8 bit coverage of the row, 255 for pixels the outline covers completely
+			for(int x = x_first; x < x_last; x++) {
+				area += cells[x];
+				float v = fabsf(area);
+				if(nonzero) {
+					v = v > 1.f ? 1.f : v;
+				} else {
+					v = v - 2.f * floorf(v * .5f);
+					v = v > 1.f ? 2.f - v : v;
+				}
+				coverage[x] = (smol_u8)(v * 255.f + .5f);
+			}
+			coverage[x_last] = 0;
+			memset(cells + x_first, 0, (x_cells - x_first) * sizeof(float));
+
+			//Solid runs go out as spans, only the edge pixels are blended one by one
+			smol_pixel_t* dst = &surface->pixel_data[y * surface->width + clip.left];
+			for(int x = x_first; x < x_last;) {
+				if(coverage[x] == 255) {
+					int x_end = x + 1;
+					while(coverage[x_end] == 255) 
+						x_end++;
+					smol__canvas_fill_span(surface, y, clip.left + x, clip.left + x_end, color, blend);
+					x = x_end;
+				} else {
+					if(coverage[x])
+						dst[x] = smol__canvas_blend_coverage(dst[x], color, coverage[x], blend, clip.left + x, y);
+					x++;
+				}
+			}
+		}
+
+	}
+
+	SMOL_FREE(coverage);
+	SMOL_FREE(acc);
+	smol__canvas_free_bins(&bins);
+	SMOL_FREE(bounds);
+	SMOL_FREE(segments);
+
+}
+
+void smol_canvas_fill_path(smol_canvas_t* canvas, const smol_canvas_point_t* points, const int* contour_sizes, int num_contours, smol_fill_flags flags) {
+
+	smol_rect_t clip = smol__canvas_batch_clip(canvas);
+	int nonzero = (flags & SMOL_FILL_NONZERO) != 0;
+
+	if(num_contours <= 0 || clip.left >= clip.right || clip.top >= clip.bottom)
+		return;
+
+	if(flags & SMOL_FILL_ANTIALIASED)
+		smol__canvas_fill_path_coverage(canvas, clip, points, contour_sizes, num_contours, nonzero);
+	else
+		smol__canvas_fill_path_scanline(canvas, clip, points, contour_sizes, num_contours, nonzero);
+
+}
+
+void smol_canvas_fill_polygon(smol_canvas_t* canvas, const smol_canvas_point_t* points, int num_points, smol_fill_flags flags) {
+	if(num_points >= 3)
+		smol_canvas_fill_path(canvas, points, &num_points, 1, flags);
+}
+
+void smol_canvas_fill_triangle(smol_canvas_t* canvas, int x0, int y0, int x1, int y1, int x2, int y2) {
+
+	//The vertices are the pixel centers
+	smol_canvas_point_t points[3] = {
+		{ x0 + .5f, y0 + .5f },
+		{ x1 + .5f, y1 + .5f },
+		{ x2 + .5f, y2 + .5f }
+	};
+
+	smol_canvas_fill_polygon(canvas, points, 3, SMOL_FILL_NONZERO);
+
+}
+
+//FNV-1a of the text, seeded with the font and the scale
+static smol_u32 smol__text_run_hash(const smol_font_t* font, int scale, const char* str, int* length) {
+
+	smol_u32 hash = 2166136261u;
+	smol_size_t seed = (smol_size_t)font ^ ((smol_size_t)scale << 16);
+
+	for(int i = 0; i < (int)sizeof(seed); i++)
+		hash = (hash ^ ((seed >> (i * 8)) & 0xFF)) * 16777619u;
+
+	const char* s = str;
+	for(; *s; s++)
+		hash = (hash ^ (smol_u8)*s) * 16777619u;
+
+	*length = (int)(s - str);
+	return hash;
+
+}
+
+//Lays out the run with the hash and the length of str already known
+static int smol__text_run_update(smol_text_run_t* run, const smol_font_t* font, int scale, const char* str, smol_u32 hash, int length) {
+
+	if(run->text && run->hash == hash && run->font == font && run->scale == scale && strcmp(run->text, str) == 0)
+		return 0;
+
+	if(length + 1 > run->text_capacity) {
+		run->text_capacity = length + 1;
+		run->text = (char*)SMOL_REALLOC(run->text, run->text_capacity);
+	}
+
+	if(length > run->glyph_capacity) {
+		run->glyph_capacity = length;
+		run->glyphs = (smol_text_glyph_t*)SMOL_REALLOC(run->glyphs, sizeof(smol_text_glyph_t) * run->glyph_capacity);
+	}
+
+	memcpy(run->text, str, length + 1);
+	run->font = font;
+	run->scale = scale;
+	run->hash = hash;
+	run->num_glyphs = 0;
+	run->width = 0;
+	run->height = 0;
 
 	int space = font->geometry ? font->geometry['_'].width : font->glyph_width;
 
-	int gx = tx;
-	int gy = ty;
+	int gx = 0;
+	int gy = 0;
 	for(; *str; ++str) {
 
 		if(*str == ' ') {
@@ -1622,13 +3385,11 @@ void smol_canvas_draw_text(smol_canvas_t* canvas, int tx, int ty, int scale, con
 			gx += space * 4;
 			continue;
 		} else if(*str == '\n') {
-			gx = tx;
+			gx = 0;
 			gy += font->glyph_height * scale;
 			continue;
 		}
 
-		const char* glyph = &font->glyphs[(*str) * font->glyph_width * font->glyph_height];
-
 		int char_offset_x = 0;
 		int char_w = font->glyph_width;
 
@@ -1638,12 +3399,150 @@ void smol_canvas_draw_text(smol_canvas_t* canvas, int tx, int ty, int scale, con
 			char_offset_x = geom.offset_x;
 		}
 
-		int l = gx; 
-		int t = gy;
-		int r = l + char_w * scale;
+		smol_text_glyph_t* glyph = &run->glyphs[run->num_glyphs++];
+		glyph->x = gx;
+		glyph->y = gy;
+		glyph->width = char_w * scale;
+		glyph->source_x = char_offset_x * scale;
+		glyph->glyph = *str;
+
+		if(gx + glyph->width > run->width) 
+			run->width = gx + glyph->width;
+		if(gy + font->glyph_height * scale > run->height) 
+			run->height = gy + font->glyph_height * scale;
+
+		gx += font->geometry ? (int)((font->geometry[*str].width+2ull)*scale) : char_w*scale;
+
+	}
+
+	return 1;
+
+}
+
+int smol_text_run_update(smol_text_run_t* run, const smol_font_t* font, int scale, const char* str) {
+
+	int length = 0;
+	smol_u32 hash = smol__text_run_hash(font, scale, str, &length);
+
+	return smol__text_run_update(run, font, scale, str, hash, length);
+
+}
+
+void smol_text_run_free(smol_text_run_t* run) {
+	if(run->text) SMOL_FREE(run->text);
+	if(run->glyphs) SMOL_FREE(run->glyphs);
+	memset(run, 0, sizeof(smol_text_run_t));
+}
+
+#ifdef _MSC_VER
+#include <intrin.h>
+static SMOL_INLINE int smol__ctz32(smol_u32 x) {
+	unsigned long index;
+	_BitScanForward(&index, x);
+	return (int)index;
+}
+#else 
+#define smol__ctz32(x) __builtin_ctz(x)
+#endif 
+
+//Blits glyphs from 1bpp rows. Each row is walked a span of lit pixels at a time, blank pixels are never visited
+//and the spans are filled directly when the blend function would just overwrite.
+static void smol__canvas_draw_text_run_rows(smol_canvas_t* canvas, int tx, int ty, const smol_text_run_t* run) {
+
+	const smol_font_t* font = run->font;
+	smol_pixel_t color = smol_stack_back(canvas->color_stack, smol_pixel_t);
+	smol_pixel_blend_func_proc blend = smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc);
+	smol_rect_t rect = smol_stack_back(canvas->scissor_stack, smol_rect_t);
+	smol_image_t* surface = &canvas->draw_surface;
+
+	int scale = run->scale;
+	int overwrite = (blend == smol_pixel_blend_overwrite);
+
+	for(int i = 0; i < run->num_glyphs; i++) {
+
+		const smol_text_glyph_t* g = &run->glyphs[i];
+		const smol_u32* rows = &font->rows[g->glyph * font->glyph_height];
+
+		//Column c of the glyph covers [origin_x + c * scale, origin_x + (c + 1) * scale)
+		int origin_x = tx + g->x - g->source_x;
+		int l = tx + g->x; 
+		int r = l + g->width;
+
+		if(l < rect.left) l = rect.left;
+		if(r > rect.right) r = rect.right;
+		if(l >= r) 
+			continue;
+
+		for(int row = 0; row < font->glyph_height; row++) {
+
+			smol_u32 mask = rows[row];
+			int t = ty + g->y + row * scale;
+			int b = t + scale;
+
+			if(t < rect.top) t = rect.top;
+			if(b > rect.bottom) b = rect.bottom;
+			if(!mask || t >= b)
+				continue;
+
+			while(mask) {
+
+				int c0 = smol__ctz32(mask);
+				smol_u32 rest = ~(mask >> c0);
+				int c1 = rest ? c0 + smol__ctz32(rest) : 32;
+				mask = (c1 < 32) ? (mask & ~((1u << c1) - 1u)) : 0;
+
+				int x0 = origin_x + c0 * scale;
+				int x1 = origin_x + c1 * scale;
+				if(x0 < l) x0 = l;
+				if(x1 > r) x1 = r;
+				if(x0 >= x1) 
+					continue;
+
+				for(int dy = t; dy < b; dy++) {
+					smol_pixel_t* dst = &surface->pixel_data[dy * surface->width];
+					if(overwrite) {
+						for(int dx = x0; dx < x1; dx++) 
+							dst[dx] = color;
+					} else {
+						for(int dx = x0; dx < x1; dx++) 
+							dst[dx] = blend(dst[dx], color, dx, dy);
+					}
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+void smol_canvas_draw_text_run(smol_canvas_t* canvas, int tx, int ty, const smol_text_run_t* run) {
+
+	const smol_font_t* font = run->font;
+
+	if(font->rows) {
+		smol__canvas_draw_text_run_rows(canvas, tx, ty, run);
+		return;
+	}
+
+	smol_pixel_t color = smol_stack_back(canvas->color_stack, smol_pixel_t);
+	smol_pixel_blend_func_proc blend = smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc);
+	smol_rect_t rect = smol_stack_back(canvas->scissor_stack, smol_rect_t);
+
+	int scale = run->scale;
+
+	for(int i = 0; i < run->num_glyphs; i++) {
+
+		const smol_text_glyph_t* g = &run->glyphs[i];
+		const char* glyph = &font->glyphs[g->glyph * font->glyph_width * font->glyph_height];
+
+		int l = tx + g->x; 
+		int t = ty + g->y;
+		int r = l + g->width;
 		int b = t + font->glyph_height * scale;
 		
-		int sx = char_offset_x*scale;
+		int sx = g->source_x;
 		int sy = 0;
 
 		if(l < rect.left) 
@@ -1668,9 +3567,439 @@ void smol_canvas_draw_text(smol_canvas_t* canvas, int tx, int ty, int scale, con
 
 		}
 
-		gx += font->geometry ? (int)((font->geometry[*str].width+2ull)*scale) : char_w*scale;
+	}
+}
+
+void smol_canvas_draw_text(smol_canvas_t* canvas, int tx, int ty, int scale, const char* str) {
+
+	smol_font_t* font = smol_stack_back(canvas->font_stack, smol_font_t*);
+
+	//Static labels hit the same slot every frame, and only get laid out again when evicted
+	int length = 0;
+	smol_u32 hash = smol__text_run_hash(font, scale, str, &length);
+	smol_text_run_t* run = &canvas->text_runs[hash % SMOL_CANVAS_TEXT_RUN_CACHE_SIZE];
+
+	smol__text_run_update(run, font, scale, str, hash, length);
+	smol_canvas_draw_text_run(canvas, tx, ty, run);
+
+}
+
+static void smol__glyph_page_reset(smol_glyph_cache_t* cache, smol_glyph_page_t* page) {
+	memset(page->pixels, 0, cache->page_size * cache->page_size);
+	page->skyline[0].x = 0;
+	page->skyline[0].y = 0;
+	page->skyline[0].width = cache->page_size;
+	page->num_nodes = 1;
+	page->dirty_x0 = page->dirty_y0 = cache->page_size;
+	page->dirty_x1 = page->dirty_y1 = 0;
+}
+
+//Lowest y a w x h rectangle fits at when its left edge is at skyline node i, -1 if it doesn't fit
+static int smol__skyline_fit(const smol_glyph_page_t* page, int page_size, int i, int w, int h) {
+
+	int x = page->skyline[i].x;
+	if(x + w > page_size)
+		return -1;
+
+	int y = 0;
+	int width_left = w;
+	while(width_left > 0) {
+		if(i >= page->num_nodes) 
+			return -1;
+		if(page->skyline[i].y > y) 
+			y = page->skyline[i].y;
+		if(y + h > page_size) 
+			return -1;
+		width_left -= page->skyline[i].width;
+		i++;
+	}
+
+	return y;
+
+}
+
+//Bottom-left skyline packing, picks the spot where the rectangle's bottom ends up the lowest
+static int smol__skyline_insert(smol_glyph_page_t* page, int page_size, int w, int h, int* out_x, int* out_y) {
+
+	int best = -1;
+	int best_bottom = page_size + 1;
+	int best_width = page_size + 1;
+	int best_y = 0;
+
+	for(int i = 0; i < page->num_nodes; i++) {
+		int y = smol__skyline_fit(page, page_size, i, w, h);
+		if(y < 0) 
+			continue;
+		if(y + h < best_bottom || (y + h == best_bottom && page->skyline[i].width < best_width)) {
+			best = i;
+			best_y = y;
+			best_bottom = y + h;
+			best_width = page->skyline[i].width;
+		}
+	}
+
+	if(best < 0)
+		return 0;
+
+	smol_skyline_node_t* nodes = page->skyline;
+	smol_skyline_node_t node = { nodes[best].x, (smol_u16)(best_y + h), (smol_u16)w };
+
+	memmove(&nodes[best + 1], &nodes[best], (page->num_nodes - best) * sizeof(smol_skyline_node_t));
+	nodes[best] = node;
+	page->num_nodes++;
+
+	//Cut the nodes the new one covers
+	for(int i = best + 1; i < page->num_nodes;) {
+		int prev_right = nodes[i - 1].x + nodes[i - 1].width;
+		if(nodes[i].x >= prev_right)
+			break;
+		int shrink = prev_right - nodes[i].x;
+		if(nodes[i].width <= shrink) {
+			memmove(&nodes[i], &nodes[i + 1], (page->num_nodes - i - 1) * sizeof(smol_skyline_node_t));
+			page->num_nodes--;
+			continue;
+		}
+		nodes[i].x += shrink;
+		nodes[i].width -= shrink;
+		break;
+	}
+
+	for(int i = 0; i < page->num_nodes - 1;) {
+		if(nodes[i].y == nodes[i + 1].y) {
+			nodes[i].width += nodes[i + 1].width;
+			memmove(&nodes[i + 1], &nodes[i + 2], (page->num_nodes - i - 2) * sizeof(smol_skyline_node_t));
+			page->num_nodes--;
+		} else {
+			i++;
+		}
+	}
+
+	*out_x = node.x;
+	*out_y = best_y;
+	return 1;
+
+}
+
+static SMOL_INLINE int smol__glyph_bucket(const smol_glyph_cache_t* cache, smol_u32 codepoint) {
+	return (int)((codepoint * 2654435761u) >> 16) & (cache->num_buckets - 1);
+}
+
+static void smol__glyph_cache_evict(smol_glyph_cache_t* cache, int page) {
+
+	if(cache->evict_func)
+		cache->evict_func(cache->evict_data, page);
+
+	for(int b = 0; b < cache->num_buckets; b++) {
+		int* link = &cache->buckets[b];
+		while(*link >= 0) {
+			smol_glyph_entry_t* entry = &cache->entries[*link];
+			if(entry->page == page) {
+				int index = *link;
+				*link = entry->next;
+				entry->next = cache->free_entry;
+				cache->free_entry = index;
+			} else {
+				link = &entry->next;
+			}
+		}
+	}
+
+	smol__glyph_page_reset(cache, &cache->pages[page]);
 
+}
+
+//Finds room for a w x h rectangle, opening a new page or evicting the least recently used one when needed
+static int smol__glyph_cache_pack(smol_glyph_cache_t* cache, int w, int h, int* x, int* y) {
+
+	for(int p = 0; p < cache->num_pages; p++) 
+		if(smol__skyline_insert(&cache->pages[p], cache->page_size, w, h, x, y))
+			return p;
+
+	int page = -1;
+	if(cache->num_pages < cache->max_pages) {
+		page = cache->num_pages++;
+		smol_glyph_page_t* new_page = &cache->pages[page];
+		new_page->pixels = (smol_u8*)SMOL_ALLOC(cache->page_size * cache->page_size);
+		new_page->skyline = (smol_skyline_node_t*)SMOL_ALLOC((cache->page_size + 1) * sizeof(smol_skyline_node_t));
+		smol__glyph_page_reset(cache, new_page);
+	} else {
+		page = 0;
+		for(int p = 1; p < cache->num_pages; p++)
+			if(cache->pages[p].last_used < cache->pages[page].last_used)
+				page = p;
+		smol__glyph_cache_evict(cache, page);
+	}
+
+	if(smol__skyline_insert(&cache->pages[page], cache->page_size, w, h, x, y))
+		return page;
+
+	return -1;
+
+}
+
+smol_glyph_cache_t smol_glyph_cache_create(int page_size, int max_pages, int cell_width, int cell_height, smol_glyph_source_proc source, void* source_data) {
+
+	smol_glyph_cache_t cache = { 0 };
+	cache.page_size = page_size;
+	cache.max_pages = max_pages;
+	cache.cell_width = cell_width;
+	cache.cell_height = cell_height;
+	cache.source = source;
+	cache.source_data = source_data;
+	cache.free_entry = -1;
+
+	cache.pages = (smol_glyph_page_t*)SMOL_ALLOC(max_pages * sizeof(smol_glyph_page_t));
+	memset(cache.pages, 0, max_pages * sizeof(smol_glyph_page_t));
+
+	cache.num_buckets = 1024;
+	cache.buckets = (int*)SMOL_ALLOC(cache.num_buckets * sizeof(int));
+	memset(cache.buckets, 0xFF, cache.num_buckets * sizeof(int));
+
+	cache.scratch = (smol_u8*)SMOL_ALLOC(cell_width * cell_height);
+
+	return cache;
+
+}
+
+void smol_glyph_cache_destroy(smol_glyph_cache_t* cache) {
+	for(int p = 0; p < cache->num_pages; p++) {
+		SMOL_FREE(cache->pages[p].pixels);
+		SMOL_FREE(cache->pages[p].skyline);
+	}
+	if(cache->pages) SMOL_FREE(cache->pages);
+	if(cache->entries) SMOL_FREE(cache->entries);
+	if(cache->buckets) SMOL_FREE(cache->buckets);
+	if(cache->scratch) SMOL_FREE(cache->scratch);
+	memset(cache, 0, sizeof(smol_glyph_cache_t));
+}
+
+const smol_glyph_entry_t* smol_glyph_cache_get(smol_glyph_cache_t* cache, smol_u32 codepoint) {
+
+	cache->clock++;
+
+	int bucket = smol__glyph_bucket(cache, codepoint);
+	for(int i = cache->buckets[bucket]; i >= 0; i = cache->entries[i].next) {
+		smol_glyph_entry_t* entry = &cache->entries[i];
+		if(entry->codepoint == codepoint) {
+			if(entry->page != SMOL_GLYPH_NO_PAGE)
+				cache->pages[entry->page].last_used = cache->clock;
+			return entry;
+		}
+	}
+
+	//Missing glyphs are cached too, as empty ones
+	smol_glyph_metrics_t metrics = { 0 };
+	memset(cache->scratch, 0, cache->cell_width * cache->cell_height);
+	if(!cache->source(cache->source_data, codepoint, cache->scratch, cache->cell_width, cache->cell_width, cache->cell_height, &metrics))
+		memset(&metrics, 0, sizeof(metrics));
+
+	if(metrics.width > cache->cell_width) metrics.width = cache->cell_width;
+	if(metrics.height > cache->cell_height) metrics.height = cache->cell_height;
+
+	int page = SMOL_GLYPH_NO_PAGE;
+	int x = 0, y = 0;
+
+	if(metrics.width > 0 && metrics.height > 0) {
+
+		//One pixel of padding keeps filtered samples from bleeding into the neighbours
+		page = smol__glyph_cache_pack(cache, metrics.width + 1, metrics.height + 1, &x, &y);
+		if(page < 0) 
+			return NULL;
+
+		smol_glyph_page_t* dst = &cache->pages[page];
+		for(int row = 0; row < metrics.height; row++)
+			memcpy(&dst->pixels[x + (y + row) * cache->page_size], &cache->scratch[row * cache->cell_width], metrics.width);
+
+		if(x < dst->dirty_x0) dst->dirty_x0 = x;
+		if(y < dst->dirty_y0) dst->dirty_y0 = y;
+		if(x + metrics.width > dst->dirty_x1) dst->dirty_x1 = x + metrics.width;
+		if(y + metrics.height > dst->dirty_y1) dst->dirty_y1 = y + metrics.height;
+		dst->last_used = cache->clock;
+
+	}
+
+	int index = cache->free_entry;
+	if(index >= 0) {
+		cache->free_entry = cache->entries[index].next;
+	} else {
+		if(cache->num_entries == cache->entry_capacity) {
+			cache->entry_capacity = cache->entry_capacity ? cache->entry_capacity * 2 : 256;
+			cache->entries = (smol_glyph_entry_t*)SMOL_REALLOC(cache->entries, cache->entry_capacity * sizeof(smol_glyph_entry_t));
+		}
+		index = cache->num_entries++;
+	}
+
+	smol_glyph_entry_t* entry = &cache->entries[index];
+	entry->codepoint = codepoint;
+	entry->page = (smol_u16)page;
+	entry->x = (smol_u16)x;
+	entry->y = (smol_u16)y;
+	entry->width = (smol_u16)metrics.width;
+	entry->height = (smol_u16)metrics.height;
+	entry->offset_x = (smol_i16)metrics.offset_x;
+	entry->offset_y = (smol_i16)metrics.offset_y;
+	entry->advance = (smol_i16)metrics.advance;
+	entry->next = cache->buckets[bucket];
+	cache->buckets[bucket] = index;
+
+	return entry;
+
+}
+
+int smol_glyph_cache_decode_utf8(const char* str, smol_u32* codepoint) {
+
+	const smol_u8* s = (const smol_u8*)str;
+	int length = 1;
+	if(s[0] >= 0xF0) length = 4;
+	else if(s[0] >= 0xE0) length = 3;
+	else if(s[0] >= 0xC0) length = 2;
+
+	//Stray continuation bytes and leads of 5 and 6 byte sequences become U+FFFD one byte at a time
+	if((s[0] & 0xC0) == 0x80 || s[0] >= 0xF8) {
+		*codepoint = 0xFFFD;
+		return 1;
+	}
+
+	//A truncated sequence becomes U+FFFD too, the byte that cut it short (maybe the terminator) isn't consumed
+	for(int i = 1; i < length; i++) {
+		if((s[i] & 0xC0) != 0x80) {
+			*codepoint = 0xFFFD;
+			return i;
+		}
+	}
+
+#ifdef SMOL_UTILS_H
+	unsigned int utf32 = 0;
+	smol_utf8_to_utf32(str, &utf32);
+	*codepoint = utf32;
+#else 
+	smol_u32 utf32 = (length == 1) ? s[0] : (s[0] & (0x7F >> length));
+	for(int i = 1; i < length; i++)
+		utf32 = (utf32 << 6) | (s[i] & 0x3F);
+	*codepoint = utf32;
+#endif 
+
+	return length;
+
+}
+
+int smol_glyph_source_font(void* user_data, smol_u32 codepoint, smol_u8* pixels, int pitch, int max_width, int max_height, smol_glyph_metrics_t* metrics) {
+
+	const smol_font_t* font = (const smol_font_t*)user_data;
+	int space = font->geometry ? font->geometry['_'].width : font->glyph_width;
+
+	if(codepoint == ' ' || codepoint == '\t') {
+		metrics->advance = space * (codepoint == '\t' ? 4 : 1);
+		return 1;
+	}
+
+	if(codepoint >= 128)
+		return 0;
+
+	int offset = 0;
+	int width = font->glyph_width;
+	int advance = font->glyph_width;
+
+	if(font->geometry) {
+		offset = font->geometry[codepoint].offset_x;
+		width = font->geometry[codepoint].width + 1;
+		advance = font->geometry[codepoint].width + 2;
+	}
+
+	if(offset + width > font->glyph_width) width = font->glyph_width - offset;
+	if(width > max_width) width = max_width;
+	int height = font->glyph_height < max_height ? font->glyph_height : max_height;
+
+	for(int y = 0; y < height; y++)
+	for(int x = 0; x < width; x++) {
+		int lit = font->rows ? 
+			(font->rows[codepoint * font->glyph_height + y] >> (offset + x)) & 1 : 
+			font->glyphs[(codepoint * font->glyph_height + y) * font->glyph_width + offset + x] != 0;
+		pixels[x + y * pitch] = lit ? 0xFF : 0x00;
 	}
+
+	metrics->width = width;
+	metrics->height = height;
+	metrics->advance = advance;
+	return 1;
+
+}
+
+void smol_canvas_draw_text_utf8(smol_canvas_t* canvas, smol_glyph_cache_t* cache, int tx, int ty, int scale, const char* str) {
+
+	smol_pixel_t color = smol_stack_back(canvas->color_stack, smol_pixel_t);
+	smol_pixel_blend_func_proc blend = smol_stack_back(canvas->blend_funcs, smol_pixel_blend_func_proc);
+	smol_rect_t rect = smol_stack_back(canvas->scissor_stack, smol_rect_t);
+	smol_image_t* surface = &canvas->draw_surface;
+
+	int gx = tx;
+	int gy = ty;
+
+	while(*str) {
+
+		smol_u32 codepoint;
+		str += smol_glyph_cache_decode_utf8(str, &codepoint);
+
+		if(codepoint == '\n') {
+			gx = tx;
+			gy += cache->cell_height * scale;
+			continue;
+		}
+
+		const smol_glyph_entry_t* glyph = smol_glyph_cache_get(cache, codepoint);
+		if(!glyph) 
+			continue;
+
+		if(glyph->page != SMOL_GLYPH_NO_PAGE) {
+
+			const smol_u8* src = &cache->pages[glyph->page].pixels[glyph->x + glyph->y * cache->page_size];
+			int l0 = gx + glyph->offset_x * scale;
+			int t0 = gy + glyph->offset_y * scale;
+
+			for(int row = 0; row < glyph->height; row++) {
+
+				int t = t0 + row * scale;
+				int b = t + scale;
+				if(t < rect.top) t = rect.top;
+				if(b > rect.bottom) b = rect.bottom;
+				if(t >= b)
+					continue;
+
+				//Spans of lit pixels, filled one scaled span at a time
+				const smol_u8* line = &src[row * cache->page_size];
+				for(int c0 = 0; c0 < glyph->width;) {
+
+					if(line[c0] < 0x80) { 
+						c0++; 
+						continue; 
+					}
+
+					int c1 = c0 + 1;
+					while(c1 < glyph->width && line[c1] >= 0x80) 
+						c1++;
+
+					int x0 = l0 + c0 * scale;
+					int x1 = l0 + c1 * scale;
+					if(x0 < rect.left) x0 = rect.left;
+					if(x1 > rect.right) x1 = rect.right;
+
+					for(int dy = t; dy < b; dy++) {
+						smol_pixel_t* dst = &surface->pixel_data[dy * surface->width];
+						for(int dx = x0; dx < x1; dx++) 
+							dst[dx] = blend(dst[dx], color, dx, dy);
+					}
+
+					c0 = c1;
+				}
+
+			}
+
+		}
+
+		gx += glyph->advance * scale;
+
+	}
+
 }
 
 void smol_canvas_draw_text_formated(smol_canvas_t* canvas, int tx, int ty, int scale, const char* fmt, ...) {
@@ -1741,17 +4070,27 @@ void smol_canvas_present(smol_canvas_t* canvas, smol_frame_t* frame) {
 
 smol_image_t smol_load_image_qoi(const char* file_path) {
 
-	void* buffer = NULL;
-	smol_size_t size = 0;
 	smol_image_t res = { 0 };
 #ifdef SMOL_UTILS_H
-	buffer = smol_read_entire_file(file_path, &size);
+	smol_file_view_t view;
+
+	if(!smol_map_file(file_path, &view)) {
+		printf("Couldn't load qoi from file '%s'!", file_path);
+		return res;
+	}
+
+	//Decoded straight from the mapped pages, no copy of the file is made.
+	smol_file_view_advise(&view, 0, 0, SMOL_FILE_VIEW_HINT_SEQUENTIAL);
+	res = smol_load_image_qoi_from_memory(view.data, view.size);
+	smol_unmap_file(&view);
 #else 
+	void* buffer = NULL;
+	smol_size_t size = 0;
 #ifdef _CRT_SECURE_NO_WARNINGS
-	FILE* f = fopen(file_path, "r");
+	FILE* f = fopen(file_path, "rb");
 #else 
 	FILE* f;
-	fopen_s(&f, file_path, "r");
+	fopen_s(&f, file_path, "rb");
 #endif 
 	if(!f)
 		return res;
@@ -1765,14 +4104,15 @@ smol_image_t smol_load_image_qoi(const char* file_path) {
 	fread(buffer, 1, size, f);
 	fclose(f);
 
-#endif 
-
 	if(!buffer) {
 		printf("Couldn't load qoi from file '%s'!", file_path);
 		return res;
 	}
 
 	res = smol_load_image_qoi_from_memory(buffer, size);
+	free(buffer);
+#endif 
+
 	return res;
 }
 
@@ -43,6 +43,21 @@ distribution.
 #endif 
 #endif 
 
+//Define SMOL_MATH_SIMD before including this header to enable the SSE / NEON backend.
+//It keeps the same API, but smol_v4_t (and so smol_quat_t and smol_m4_t) become 16 byte 
+//aligned, which changes the layout of any struct that embeds them.
+#if defined(SMOL_MATH_SIMD) && !defined(SMOL_MATH_NO_SIMD)
+#	if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#		include <xmmintrin.h>
+#		define SMOL_MATH_SSE
+typedef __m128 smol_simd4_t;
+#	elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#		include <arm_neon.h>
+#		define SMOL_MATH_NEON
+typedef float32x4_t smol_simd4_t;
+#	endif
+#endif 
+
 typedef union smol_v2_t {
 	struct {
 		float x, y;
@@ -74,6 +89,9 @@ typedef union smol_v4_t {
 	};
 	smol_v3_t xyz;
 	float v[4];
+#if defined(SMOL_MATH_SSE) || defined(SMOL_MATH_NEON)
+	smol_simd4_t simd;
+#endif 
 } smol_v4_t;
 
 typedef smol_v2_t smol_complex_t;
@@ -126,6 +144,33 @@ typedef union smol_m4_t {
 } smol_m4_t;
 
 
+//Frustum planes as (normal, distance), a point p is inside when dot(normal, p) + distance >= 0.
+typedef struct smol_frustum_t {
+	union {
+		struct {
+			smol_v4_t left_plane, right_plane, bottom_plane, top_plane, near_plane, far_plane;
+		};
+		smol_v4_t planes[6];
+	};
+} smol_frustum_t;
+
+//Transform hierarchy, nodes are stored in parent sorted order (a parent always comes before
+//its children) so the world matrices propagate in a single linear pass.
+typedef struct smol_transforms_t {
+	int count;
+	int capacity;
+	int* parent; //-1 for roots
+	int* root; //Index of the root of each node's tree
+	int* root_end; //For roots: index of the last node in the tree
+	int* roots;
+	int num_roots;
+	smol_v3_t* position;
+	smol_quat_t* rotation;
+	smol_v3_t* scale;
+	smol_m4_t* world;
+	unsigned char* dirty;
+} smol_transforms_t;
+
 static const smol_v3_t SMOL_RIGHT_VECTOR	= { 1.f, 0.f, 0.f };
 static const smol_v3_t SMOL_UP_VECTOR		= { 0.f, 1.f, 0.f };
 static const smol_v3_t SMOL_FORWARD_VECTOR	= { 0.f, 0.f, 1.f };
@@ -236,6 +281,10 @@ smol_v4_t smol_m4_mul_v4(smol_m4_t m, smol_v4_t v);
 float smol_m4_determinant(smol_m4_t m);
 smol_m4_t smol_m4_adjugate(smol_m4_t m);
 smol_m4_t smol_m4_inverse(smol_m4_t m);
+//Inverse of a rotation + translation matrix (orthonormal upper 3x3, last row 0 0 0 1)
+smol_m4_t smol_m4_inverse_rigid(smol_m4_t m);
+//Inverse of any affine matrix (invertible upper 3x3, last row 0 0 0 1)
+smol_m4_t smol_m4_inverse_affine(smol_m4_t m);
 
 
 //Initializations:
@@ -281,11 +330,78 @@ smol_m4_t smol_m4_ortho_lh(
 	float far_plane
 );
 
+//Batch transforms:
+//The AoS versions read x, y, z (three consecutive floats) every *_stride bytes, so positions 
+//can be transformed straight out of bigger vertex structs. The SoA versions take separate arrays.
+//In place transforms are fine, as long as the source and the destination are the same memory 
+//with the same stride. _points use w = 1, _vectors w = 0 and _project does the perspective 
+//divide, producing normalized device coordinates.
+void smol_m4_transform_points(smol_m4_t m, const void* src, int src_stride, void* dst, int dst_stride, int count);
+void smol_m4_transform_vectors(smol_m4_t m, const void* src, int src_stride, void* dst, int dst_stride, int count);
+void smol_m4_transform_project(smol_m4_t m, const void* src, int src_stride, void* dst, int dst_stride, int count);
+
+void smol_m4_transform_points_soa(smol_m4_t m, const float* x, const float* y, const float* z, float* out_x, float* out_y, float* out_z, int count);
+void smol_m4_transform_vectors_soa(smol_m4_t m, const float* x, const float* y, const float* z, float* out_x, float* out_y, float* out_z, int count);
+void smol_m4_transform_project_soa(smol_m4_t m, const float* x, const float* y, const float* z, float* out_x, float* out_y, float* out_z, int count);
+
+//Frustum culling:
+//Extracts the normalized world space planes from a projection * view matrix (such as 
+//smol_m4_perspective_lh * smol_m4_look_at), or the planes in model space from a full MVP.
+smol_frustum_t smol_frustum_from_m4(smol_m4_t view_projection);
+int smol_frustum_test_sphere(const smol_frustum_t* frustum, smol_v3_t center, float radius);
+int smol_frustum_test_aabb(const smol_frustum_t* frustum, smol_v3_t center, smol_v3_t extents);
+
+//The batch versions take SoA arrays, write the indices of the visible (intersecting or inside) 
+//objects into out_indices, which has to fit count indices, and return the number of them. 
+//AABBs are given as center and half extents.
+int smol_frustum_cull_spheres(const smol_frustum_t* frustum, const float* x, const float* y, const float* z, const float* radius, int count, int* out_indices);
+int smol_frustum_cull_aabbs(const smol_frustum_t* frustum, const float* x, const float* y, const float* z, const float* extent_x, const float* extent_y, const float* extent_z, int count, int* out_indices);
+
+//Transform hierarchy:
+//The local matrix of a node is translate(position) * rotate_quat(rotation) * scale(scale), and
+//its world matrix is the parent's world matrix times that. Only the nodes marked dirty (by the
+//setters) and their descendants get recomputed on update. Trees of different roots are independent,
+//so they can be updated in parallel, e.g. with smol_utils.h:
+//smol_parallel_for(t->num_roots, 1, update_proc, t) -> smol_transforms_update_root(t, t->roots[i]);
+//Nodes of one tree should be added before the next root is added, otherwise the per root updates
+//have to skip over nodes of other trees.
+int smol_transforms_create(smol_transforms_t* transforms, int capacity);
+void smol_transforms_destroy(smol_transforms_t* transforms);
+int smol_transforms_add(smol_transforms_t* transforms, int parent, smol_v3_t position, smol_quat_t rotation, smol_v3_t scale);
+void smol_transforms_set_position(smol_transforms_t* transforms, int node, smol_v3_t position);
+void smol_transforms_set_rotation(smol_transforms_t* transforms, int node, smol_quat_t rotation);
+void smol_transforms_set_scale(smol_transforms_t* transforms, int node, smol_v3_t scale);
+smol_m4_t smol_transforms_local(const smol_transforms_t* transforms, int node);
+void smol_transforms_update(smol_transforms_t* transforms);
+void smol_transforms_update_root(smol_transforms_t* transforms, int root);
+
 #endif 
 
 
 #ifdef SMOL_MATH_IMPLEMENTATION
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+
+#ifndef SMOL_ALLOC
+#define SMOL_ALLOC( size ) malloc(size)
+#endif 
+
+#ifndef SMOL_FREE
+#define SMOL_FREE( ptr ) free(ptr)
+#endif 
+
+#ifndef SMOL_REALLOC
+#define SMOL_REALLOC( old_ptr, new_size ) realloc(old_ptr, new_size)
+#endif 
+
+#if defined(SMOL_MATH_SSE)
+#define SMOL__SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define SMOL__SWIZZLE(a, x, y, z, w) SMOL__SHUFFLE(a, a, x, y, z, w)
+#endif 
+
 #pragma region smol_v2_t 
 SMOL_INLINE smol_v2_t smol_v2(float x, float y) {
 	smol_v2_t res = { x, y };
@@ -492,16 +608,30 @@ SMOL_INLINE smol_v3_t smol_v3_mix(smol_v3_t a, smol_v3_t b, float t) {
 #pragma region smol_v4_t 
 
 SMOL_INLINE smol_v4_t smol_v4(float x, float y, float z, float w) {
+#if defined(SMOL_MATH_SSE)
+	//Filling the lanes one float at a time would stall the following 16 byte load
+	smol_v4_t res;
+	res.simd = _mm_setr_ps(x, y, z, w);
+#else 
 	smol_v4_t res = { x, y, z, w };
+#endif 
 	return res;
 }
 
 SMOL_INLINE smol_v4_t smol_v4_from_v3(smol_v3_t v, float w) {
-	smol_v4_t res = { v.x, v.y, v.z, w };
-	return res;
+	return smol_v4(v.x, v.y, v.z, w);
 }
 
 SMOL_INLINE smol_v4_t smol_v4_neg(smol_v4_t v) {
+#if defined(SMOL_MATH_SSE)
+	smol_v4_t n;
+	n.simd = _mm_sub_ps(_mm_setzero_ps(), v.simd);
+	return n;
+#elif defined(SMOL_MATH_NEON)
+	smol_v4_t n;
+	n.simd = vnegq_f32(v.simd);
+	return n;
+#else 
 	smol_v4_t n = {
 		-v.x,
 		-v.y,
@@ -509,9 +639,19 @@ SMOL_INLINE smol_v4_t smol_v4_neg(smol_v4_t v) {
 		-v.w
 	};
 	return n;
+#endif 
 }
 
 SMOL_INLINE smol_v4_t smol_v4_sub(smol_v4_t a, smol_v4_t b) {
+#if defined(SMOL_MATH_SSE)
+	smol_v4_t v;
+	v.simd = _mm_sub_ps(a.simd, b.simd);
+	return v;
+#elif defined(SMOL_MATH_NEON)
+	smol_v4_t v;
+	v.simd = vsubq_f32(a.simd, b.simd);
+	return v;
+#else 
 	smol_v4_t v = {
 		a.x - b.x,
 		a.y - b.y,
@@ -519,9 +659,19 @@ SMOL_INLINE smol_v4_t smol_v4_sub(smol_v4_t a, smol_v4_t b) {
 		a.w - b.w
 	};
 	return v;
+#endif 
 }
 
 SMOL_INLINE smol_v4_t smol_v4_add(smol_v4_t a, smol_v4_t b) {
+#if defined(SMOL_MATH_SSE)
+	smol_v4_t v;
+	v.simd = _mm_add_ps(a.simd, b.simd);
+	return v;
+#elif defined(SMOL_MATH_NEON)
+	smol_v4_t v;
+	v.simd = vaddq_f32(a.simd, b.simd);
+	return v;
+#else 
 	smol_v4_t v = {
 		a.x + b.x,
 		a.y + b.y,
@@ -529,10 +679,20 @@ SMOL_INLINE smol_v4_t smol_v4_add(smol_v4_t a, smol_v4_t b) {
 		a.w + b.w
 	};
 	return v;
+#endif 
 }
 
 
 SMOL_INLINE smol_v4_t smol_v4_mul(float a, smol_v4_t b) {
+#if defined(SMOL_MATH_SSE)
+	smol_v4_t v;
+	v.simd = _mm_mul_ps(_mm_set1_ps(a), b.simd);
+	return v;
+#elif defined(SMOL_MATH_NEON)
+	smol_v4_t v;
+	v.simd = vmulq_n_f32(b.simd, a);
+	return v;
+#else 
 	smol_v4_t v = {
 		b.x * a,
 		b.y * a,
@@ -540,9 +700,19 @@ SMOL_INLINE smol_v4_t smol_v4_mul(float a, smol_v4_t b) {
 		b.w * a
 	};
 	return v;
+#endif 
 }
 
 SMOL_INLINE smol_v4_t smol_v4_hadam(smol_v4_t a, smol_v4_t b) {
+#if defined(SMOL_MATH_SSE)
+	smol_v4_t v;
+	v.simd = _mm_mul_ps(a.simd, b.simd);
+	return v;
+#elif defined(SMOL_MATH_NEON)
+	smol_v4_t v;
+	v.simd = vmulq_f32(a.simd, b.simd);
+	return v;
+#else 
 	smol_v4_t v = {
 		a.x * b.x,
 		a.y * b.y,
@@ -550,6 +720,7 @@ SMOL_INLINE smol_v4_t smol_v4_hadam(smol_v4_t a, smol_v4_t b) {
 		a.w * b.w
 	};
 	return v;
+#endif 
 }
 
 SMOL_INLINE smol_v4_t smol_v4_div(smol_v4_t a, float b) {
@@ -558,12 +729,23 @@ SMOL_INLINE smol_v4_t smol_v4_div(smol_v4_t a, float b) {
 }
 
 SMOL_INLINE float smol_v4_dot(smol_v4_t a, smol_v4_t b) {
+#if defined(SMOL_MATH_SSE)
+	__m128 m = _mm_mul_ps(a.simd, b.simd);
+	m = _mm_add_ps(m, _mm_movehl_ps(m, m));
+	m = _mm_add_ss(m, SMOL__SWIZZLE(m, 1, 1, 1, 1));
+	return _mm_cvtss_f32(m);
+#elif defined(SMOL_MATH_NEON)
+	float32x4_t m = vmulq_f32(a.simd, b.simd);
+	float32x2_t s = vadd_f32(vget_low_f32(m), vget_high_f32(m));
+	return vget_lane_f32(vpadd_f32(s, s), 0);
+#else 
 	return (
 		a.x * b.x + 
 		a.y * b.y + 
 		a.z * b.z +
 		a.w * b.w
 	);
+#endif 
 }
 
 SMOL_INLINE float smol_v4_len_sq(smol_v4_t v) {
@@ -582,13 +764,21 @@ SMOL_INLINE smol_v4_t smol_v4_norm(smol_v4_t v) {
 SMOL_INLINE smol_v4_t smol_v4_mix(smol_v4_t a, smol_v4_t b, float t) {
 	
 	float it = 1.f - t;
-	
+
+#if defined(SMOL_MATH_SSE)
+	smol_v4_t res;
+	res.simd = _mm_add_ps(_mm_mul_ps(a.simd, _mm_set1_ps(it)), _mm_mul_ps(b.simd, _mm_set1_ps(t)));
+#elif defined(SMOL_MATH_NEON)
+	smol_v4_t res;
+	res.simd = vmlaq_n_f32(vmulq_n_f32(a.simd, it), b.simd, t);
+#else 
 	smol_v4_t res = {
 		a.x * it + b.x * t,
 		a.y * it + b.y * t,
 		a.z * it + b.z * t,
 		a.w * it + b.w * t
 	};
+#endif 
 
 	return res;
 
@@ -816,8 +1006,8 @@ smol_m3_t smol_m3_inverse(smol_m3_t m) {
 		fputs("Derterminat too small!", stderr);
 	#ifdef _MSC_VER
 		__debugbreak();
-	#elif defined(_POSIX_C_SOURCE)
-		sigint(SIGTRAP);
+	#elif defined(SIGTRAP)
+		raise(SIGTRAP);
 	#endif 
 	}
 
@@ -999,7 +1189,20 @@ smol_m3_t smol_m3_rotate_quat(smol_quat_t q) {
 
 
 SMOL_INLINE smol_m4_t smol_m4_transpose(smol_m4_t m) {
-	
+
+#if defined(SMOL_MATH_SSE)
+	_MM_TRANSPOSE4_PS(m.x.simd, m.y.simd, m.z.simd, m.w.simd);
+	return m;
+#elif defined(SMOL_MATH_NEON)
+	float32x4x2_t xy = vtrnq_f32(m.x.simd, m.y.simd);
+	float32x4x2_t zw = vtrnq_f32(m.z.simd, m.w.simd);
+	smol_m4_t res;
+	res.x.simd = vcombine_f32(vget_low_f32(xy.val[0]), vget_low_f32(zw.val[0]));
+	res.y.simd = vcombine_f32(vget_low_f32(xy.val[1]), vget_low_f32(zw.val[1]));
+	res.z.simd = vcombine_f32(vget_high_f32(xy.val[0]), vget_high_f32(zw.val[0]));
+	res.w.simd = vcombine_f32(vget_high_f32(xy.val[1]), vget_high_f32(zw.val[1]));
+	return res;
+#else 
 	smol_m4_t res = {
 		m.m[0], m.m[4],  m.m[8], m.m[12],
 		m.m[1], m.m[5],  m.m[9], m.m[13],
@@ -1008,11 +1211,34 @@ SMOL_INLINE smol_m4_t smol_m4_transpose(smol_m4_t m) {
 	};
 
 	return res;
+#endif 
 
 }
 
 SMOL_INLINE smol_m4_t smol_m4_mul(smol_m4_t a, smol_m4_t b) {
 
+#if defined(SMOL_MATH_SSE)
+	//Each result row is a linear combination of b's rows, weighted by the row of a
+	smol_m4_t res;
+	for(int i = 0; i < 4; i++) {
+		__m128 r = a.rows[i].simd;
+		__m128 xy = _mm_add_ps(_mm_mul_ps(SMOL__SWIZZLE(r, 0, 0, 0, 0), b.x.simd), _mm_mul_ps(SMOL__SWIZZLE(r, 1, 1, 1, 1), b.y.simd));
+		__m128 zw = _mm_add_ps(_mm_mul_ps(SMOL__SWIZZLE(r, 2, 2, 2, 2), b.z.simd), _mm_mul_ps(SMOL__SWIZZLE(r, 3, 3, 3, 3), b.w.simd));
+		res.rows[i].simd = _mm_add_ps(xy, zw);
+	}
+	return res;
+#elif defined(SMOL_MATH_NEON)
+	smol_m4_t res;
+	for(int i = 0; i < 4; i++) {
+		float32x4_t r = a.rows[i].simd;
+		float32x4_t v = vmulq_lane_f32(b.x.simd, vget_low_f32(r), 0);
+		v = vmlaq_lane_f32(v, b.y.simd, vget_low_f32(r), 1);
+		v = vmlaq_lane_f32(v, b.z.simd, vget_high_f32(r), 0);
+		v = vmlaq_lane_f32(v, b.w.simd, vget_high_f32(r), 1);
+		res.rows[i].simd = v;
+	}
+	return res;
+#else 
 	smol_m4_t t = smol_m4_transpose(b);
 
 	smol_m4_t res = {
@@ -1023,6 +1249,7 @@ SMOL_INLINE smol_m4_t smol_m4_mul(smol_m4_t a, smol_m4_t b) {
 	};
 
 	return res;
+#endif 
 
 }
 
@@ -1042,12 +1269,30 @@ SMOL_INLINE smol_m4_t smol_m4_mul_by_val(smol_m4_t a, float f) {
 
 SMOL_INLINE smol_v4_t smol_m4_mul_v4(smol_m4_t m, smol_v4_t v) {
 
+#if defined(SMOL_MATH_SSE)
+	//Four row products, transposed and summed gives all four dots at once
+	__m128 x = _mm_mul_ps(m.x.simd, v.simd);
+	__m128 y = _mm_mul_ps(m.y.simd, v.simd);
+	__m128 z = _mm_mul_ps(m.z.simd, v.simd);
+	__m128 w = _mm_mul_ps(m.w.simd, v.simd);
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+	smol_v4_t res;
+	res.simd = _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, w));
+#elif defined(SMOL_MATH_NEON)
+	smol_m4_t t = smol_m4_transpose(m);
+	smol_v4_t res;
+	res.simd = vmulq_lane_f32(t.x.simd, vget_low_f32(v.simd), 0);
+	res.simd = vmlaq_lane_f32(res.simd, t.y.simd, vget_low_f32(v.simd), 1);
+	res.simd = vmlaq_lane_f32(res.simd, t.z.simd, vget_high_f32(v.simd), 0);
+	res.simd = vmlaq_lane_f32(res.simd, t.w.simd, vget_high_f32(v.simd), 1);
+#else 
 	smol_v4_t res = { 
 		smol_v4_dot(m.x, v),
 		smol_v4_dot(m.y, v),
 		smol_v4_dot(m.z, v),
 		smol_v4_dot(m.w, v)
 	};
+#endif 
 
 	return res;
 
@@ -1067,8 +1312,6 @@ SMOL_INLINE float smol_m4_determinant(smol_m4_t m) {
 
 SMOL_INLINE smol_m4_t smol_m4_adjugate(smol_m4_t m) {
 
-	m = smol_m4_transpose(m);
-
 	smol_m4_t res = {
 			.x = {
 				 (m.y.y * m.z.z * m.w.w) + (m.y.z * m.z.w * m.w.y) + (m.y.w * m.z.y * m.w.z) - (m.y.w * m.z.z * m.w.y) - (m.y.z * m.z.y * m.w.w) - (m.y.y * m.z.w * m.w.z),
@@ -1102,6 +1345,58 @@ SMOL_INLINE smol_m4_t smol_m4_adjugate(smol_m4_t m) {
 
 SMOL_INLINE smol_m4_t smol_m4_inverse(smol_m4_t m) {
 
+#if defined(SMOL_MATH_SSE)
+	//Block-wise inverse; the matrix is split into the 2x2 blocks | A B |
+	//                                                             | C D |
+	//and each __m128 holds one 2x2 block in row-major order.
+	__m128 A = _mm_movelh_ps(m.x.simd, m.y.simd);
+	__m128 B = _mm_movehl_ps(m.y.simd, m.x.simd);
+	__m128 C = _mm_movelh_ps(m.z.simd, m.w.simd);
+	__m128 D = _mm_movehl_ps(m.w.simd, m.z.simd);
+
+	//(|A|, |B|, |C|, |D|)
+	__m128 det_sub = _mm_sub_ps(
+		_mm_mul_ps(SMOL__SHUFFLE(m.x.simd, m.z.simd, 0, 2, 0, 2), SMOL__SHUFFLE(m.y.simd, m.w.simd, 1, 3, 1, 3)),
+		_mm_mul_ps(SMOL__SHUFFLE(m.x.simd, m.z.simd, 1, 3, 1, 3), SMOL__SHUFFLE(m.y.simd, m.w.simd, 0, 2, 0, 2))
+	);
+	__m128 det_a = SMOL__SWIZZLE(det_sub, 0, 0, 0, 0);
+	__m128 det_b = SMOL__SWIZZLE(det_sub, 1, 1, 1, 1);
+	__m128 det_c = SMOL__SWIZZLE(det_sub, 2, 2, 2, 2);
+	__m128 det_d = SMOL__SWIZZLE(det_sub, 3, 3, 3, 3);
+
+	//2x2 products, where # marks the adjugate: D#C and A#B
+	__m128 d_c = _mm_sub_ps(_mm_mul_ps(SMOL__SWIZZLE(D, 3, 3, 0, 0), C), _mm_mul_ps(SMOL__SWIZZLE(D, 1, 1, 2, 2), SMOL__SWIZZLE(C, 2, 3, 0, 1)));
+	__m128 a_b = _mm_sub_ps(_mm_mul_ps(SMOL__SWIZZLE(A, 3, 3, 0, 0), B), _mm_mul_ps(SMOL__SWIZZLE(A, 1, 1, 2, 2), SMOL__SWIZZLE(B, 2, 3, 0, 1)));
+
+	//X# = |D|A - B(D#C), W# = |A|D - C(A#B)
+	__m128 x_ = _mm_sub_ps(_mm_mul_ps(det_d, A), _mm_add_ps(_mm_mul_ps(B, SMOL__SWIZZLE(d_c, 0, 3, 0, 3)), _mm_mul_ps(SMOL__SWIZZLE(B, 1, 0, 3, 2), SMOL__SWIZZLE(d_c, 2, 1, 2, 1))));
+	__m128 w_ = _mm_sub_ps(_mm_mul_ps(det_a, D), _mm_add_ps(_mm_mul_ps(C, SMOL__SWIZZLE(a_b, 0, 3, 0, 3)), _mm_mul_ps(SMOL__SWIZZLE(C, 1, 0, 3, 2), SMOL__SWIZZLE(a_b, 2, 1, 2, 1))));
+
+	//Y# = |B|C - D(A#B)#, Z# = |C|B - A(D#C)#
+	__m128 y_ = _mm_sub_ps(_mm_mul_ps(det_b, C), _mm_sub_ps(_mm_mul_ps(D, SMOL__SWIZZLE(a_b, 3, 0, 3, 0)), _mm_mul_ps(SMOL__SWIZZLE(D, 1, 0, 3, 2), SMOL__SWIZZLE(a_b, 2, 1, 2, 1))));
+	__m128 z_ = _mm_sub_ps(_mm_mul_ps(det_c, B), _mm_sub_ps(_mm_mul_ps(A, SMOL__SWIZZLE(d_c, 3, 0, 3, 0)), _mm_mul_ps(SMOL__SWIZZLE(A, 1, 0, 3, 2), SMOL__SWIZZLE(d_c, 2, 1, 2, 1))));
+
+	//|M| = |A||D| + |B||C| - tr((A#B)(D#C))
+	__m128 tr = _mm_mul_ps(a_b, SMOL__SWIZZLE(d_c, 0, 2, 1, 3));
+	tr = _mm_add_ps(tr, SMOL__SWIZZLE(tr, 2, 3, 0, 1));
+	tr = _mm_add_ps(tr, SMOL__SWIZZLE(tr, 1, 0, 3, 2));
+	__m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), tr);
+
+	__m128 rdet = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), det);
+	x_ = _mm_mul_ps(x_, rdet);
+	y_ = _mm_mul_ps(y_, rdet);
+	z_ = _mm_mul_ps(z_, rdet);
+	w_ = _mm_mul_ps(w_, rdet);
+
+	//Applying the last adjugate and storing the blocks back as rows in one shuffle
+	smol_m4_t res;
+	res.x.simd = SMOL__SHUFFLE(x_, y_, 3, 1, 3, 1);
+	res.y.simd = SMOL__SHUFFLE(x_, y_, 2, 0, 2, 0);
+	res.z.simd = SMOL__SHUFFLE(z_, w_, 3, 1, 3, 1);
+	res.w.simd = SMOL__SHUFFLE(z_, w_, 2, 0, 2, 0);
+
+	return res;
+#else 
 	float det = smol_m4_determinant(m);
 
 	
@@ -1109,8 +1404,8 @@ SMOL_INLINE smol_m4_t smol_m4_inverse(smol_m4_t m) {
 		fputs("Derterminat too small!", stderr);
 	#ifdef _MSC_VER
 		__debugbreak();
-	#elif defined(_POSIX_C_SOURCE)
-		sigint(SIGTRAP);
+	#elif defined(SIGTRAP)
+		raise(SIGTRAP);
 	#endif 
 	}
 	
@@ -1118,6 +1413,97 @@ SMOL_INLINE smol_m4_t smol_m4_inverse(smol_m4_t m) {
 	smol_m4_t res = smol_m4_mul_by_val(adjugate, 1.0f / det);
 	
 	return res;
+#endif 
+
+}
+
+#if defined(SMOL_MATH_SSE)
+SMOL_INLINE __m128 smol__m4_cross_sse(__m128 a, __m128 b) {
+	return _mm_sub_ps(
+		_mm_mul_ps(SMOL__SWIZZLE(a, 1, 2, 0, 3), SMOL__SWIZZLE(b, 2, 0, 1, 3)),
+		_mm_mul_ps(SMOL__SWIZZLE(a, 2, 0, 1, 3), SMOL__SWIZZLE(b, 1, 2, 0, 3))
+	);
+}
+
+//Builds the inverse of an affine matrix out of the columns (x, y, z) of its inverted 3x3 part,
+//the translation is taken from the last column of m.
+SMOL_INLINE smol_m4_t smol__m4_inverse_affine_sse(smol_m4_t m, __m128 x, __m128 y, __m128 z) {
+
+	__m128 n = _mm_mul_ps(x, SMOL__SWIZZLE(m.x.simd, 3, 3, 3, 3));
+	n = _mm_add_ps(n, _mm_mul_ps(y, SMOL__SWIZZLE(m.y.simd, 3, 3, 3, 3)));
+	n = _mm_add_ps(n, _mm_mul_ps(z, SMOL__SWIZZLE(m.z.simd, 3, 3, 3, 3)));
+	n = _mm_sub_ps(_mm_setzero_ps(), n);
+
+	_MM_TRANSPOSE4_PS(x, y, z, n);
+
+	smol_m4_t res;
+	res.x.simd = x;
+	res.y.simd = y;
+	res.z.simd = z;
+	res.w.simd = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+
+	return res;
+
+}
+#endif 
+
+SMOL_INLINE smol_m4_t smol_m4_inverse_rigid(smol_m4_t m) {
+
+#if defined(SMOL_MATH_SSE)
+	//The inverse rotation is the transpose, so the rows of m are the columns of the result
+	return smol__m4_inverse_affine_sse(m, m.x.simd, m.y.simd, m.z.simd);
+#else 
+	smol_v3_t t = { m.x.w, m.y.w, m.z.w };
+
+	smol_m4_t res = {
+		.x = { m.x.x, m.y.x, m.z.x, -(m.x.x * t.x + m.y.x * t.y + m.z.x * t.z) },
+		.y = { m.x.y, m.y.y, m.z.y, -(m.x.y * t.x + m.y.y * t.y + m.z.y * t.z) },
+		.z = { m.x.z, m.y.z, m.z.z, -(m.x.z * t.x + m.y.z * t.y + m.z.z * t.z) },
+		.w = { 0.f, 0.f, 0.f, 1.f }
+	};
+
+	return res;
+#endif 
+
+}
+
+SMOL_INLINE smol_m4_t smol_m4_inverse_affine(smol_m4_t m) {
+
+#if defined(SMOL_MATH_SSE)
+	__m128 x = smol__m4_cross_sse(m.y.simd, m.z.simd);
+	__m128 y = smol__m4_cross_sse(m.z.simd, m.x.simd);
+	__m128 z = smol__m4_cross_sse(m.x.simd, m.y.simd);
+
+	//Lane w of the cross products is zero, so a 4 wide dot is the 3x3 determinant
+	__m128 det = _mm_mul_ps(m.x.simd, x);
+	det = _mm_add_ps(det, SMOL__SWIZZLE(det, 2, 3, 0, 1));
+	det = _mm_add_ps(det, SMOL__SWIZZLE(det, 1, 0, 3, 2));
+
+	__m128 rdet = _mm_div_ps(_mm_set1_ps(1.f), det);
+
+	return smol__m4_inverse_affine_sse(m, _mm_mul_ps(x, rdet), _mm_mul_ps(y, rdet), _mm_mul_ps(z, rdet));
+#else 
+	//The columns of the inverse 3x3 are the cross products of its rows, divided by the determinant
+	smol_v3_t x = { m.y.y * m.z.z - m.y.z * m.z.y, m.y.z * m.z.x - m.y.x * m.z.z, m.y.x * m.z.y - m.y.y * m.z.x };
+	smol_v3_t y = { m.z.y * m.x.z - m.z.z * m.x.y, m.z.z * m.x.x - m.z.x * m.x.z, m.z.x * m.x.y - m.z.y * m.x.x };
+	smol_v3_t z = { m.x.y * m.y.z - m.x.z * m.y.y, m.x.z * m.y.x - m.x.x * m.y.z, m.x.x * m.y.y - m.x.y * m.y.x };
+
+	float rdet = 1.f / smol_v3_dot(m.x.xyz, x);
+	x = smol_v3_mul(rdet, x);
+	y = smol_v3_mul(rdet, y);
+	z = smol_v3_mul(rdet, z);
+
+	smol_v3_t t = { m.x.w, m.y.w, m.z.w };
+
+	smol_m4_t res = {
+		.x = { x.x, y.x, z.x, -(x.x * t.x + y.x * t.y + z.x * t.z) },
+		.y = { x.y, y.y, z.y, -(x.y * t.x + y.y * t.y + z.y * t.z) },
+		.z = { x.z, y.z, z.z, -(x.z * t.x + y.z * t.y + z.z * t.z) },
+		.w = { 0.f, 0.f, 0.f, 1.f }
+	};
+
+	return res;
+#endif 
 
 }
 
@@ -1417,5 +1803,588 @@ SMOL_INLINE smol_m4_t smol_m4_perspective_lh(float fov, float aspect, float near
 
 #pragma endregion
 
+#pragma region Batch transforms
+
+typedef enum {
+	SMOL__TRANSFORM_POINTS,
+	SMOL__TRANSFORM_VECTORS,
+	SMOL__TRANSFORM_PROJECT
+} smol__transform_mode;
+
+static SMOL_INLINE void smol__m4_transform_one(const smol_m4_t* m, smol__transform_mode mode, float* x, float* y, float* z) {
+
+	float w = mode == SMOL__TRANSFORM_VECTORS ? 0.f : 1.f;
+	float px = *x, py = *y, pz = *z;
+
+	float rx = m->x.x * px + m->x.y * py + m->x.z * pz + m->x.w * w;
+	float ry = m->y.x * px + m->y.y * py + m->y.z * pz + m->y.w * w;
+	float rz = m->z.x * px + m->z.y * py + m->z.z * pz + m->z.w * w;
+
+	if(mode == SMOL__TRANSFORM_PROJECT) {
+		float rw = 1.f / (m->w.x * px + m->w.y * py + m->w.z * pz + m->w.w);
+		rx *= rw;
+		ry *= rw;
+		rz *= rw;
+	}
+
+	*x = rx;
+	*y = ry;
+	*z = rz;
+
+}
+
+#if defined(SMOL_MATH_SSE)
+//Transforms 4 points held in SoA registers
+static SMOL_INLINE void smol__m4_transform_x4(const smol_m4_t* m, smol__transform_mode mode, __m128* x, __m128* y, __m128* z) {
+
+	__m128 w = _mm_set1_ps(mode == SMOL__TRANSFORM_VECTORS ? 0.f : 1.f);
+
+	#define SMOL__TRANSFORM_ROW(r) _mm_add_ps( \
+		_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m->r.x), *x), _mm_mul_ps(_mm_set1_ps(m->r.y), *y)), \
+		_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m->r.z), *z), _mm_mul_ps(_mm_set1_ps(m->r.w), w)) \
+	)
+
+	__m128 rx = SMOL__TRANSFORM_ROW(x);
+	__m128 ry = SMOL__TRANSFORM_ROW(y);
+	__m128 rz = SMOL__TRANSFORM_ROW(z);
+
+	if(mode == SMOL__TRANSFORM_PROJECT) {
+		__m128 rw = _mm_div_ps(_mm_set1_ps(1.f), SMOL__TRANSFORM_ROW(w));
+		rx = _mm_mul_ps(rx, rw);
+		ry = _mm_mul_ps(ry, rw);
+		rz = _mm_mul_ps(rz, rw);
+	}
+
+	#undef SMOL__TRANSFORM_ROW
+
+	*x = rx;
+	*y = ry;
+	*z = rz;
+
+}
+#elif defined(SMOL_MATH_NEON)
+static SMOL_INLINE void smol__m4_transform_x4(const smol_m4_t* m, smol__transform_mode mode, float32x4_t* x, float32x4_t* y, float32x4_t* z) {
+
+	float w = mode == SMOL__TRANSFORM_VECTORS ? 0.f : 1.f;
+
+	#define SMOL__TRANSFORM_ROW(r) vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m->r.w * w), *x, m->r.x), *y, m->r.y), *z, m->r.z)
+
+	float32x4_t rx = SMOL__TRANSFORM_ROW(x);
+	float32x4_t ry = SMOL__TRANSFORM_ROW(y);
+	float32x4_t rz = SMOL__TRANSFORM_ROW(z);
+
+	if(mode == SMOL__TRANSFORM_PROJECT) {
+		//Reciprocal estimate, refined with two Newton-Raphson steps
+		float32x4_t d = SMOL__TRANSFORM_ROW(w);
+		float32x4_t rw = vrecpeq_f32(d);
+		rw = vmulq_f32(rw, vrecpsq_f32(d, rw));
+		rw = vmulq_f32(rw, vrecpsq_f32(d, rw));
+		rx = vmulq_f32(rx, rw);
+		ry = vmulq_f32(ry, rw);
+		rz = vmulq_f32(rz, rw);
+	}
+
+	#undef SMOL__TRANSFORM_ROW
+
+	*x = rx;
+	*y = ry;
+	*z = rz;
+
+}
+#endif 
+
+static void smol__m4_transform_aos(const smol_m4_t* m, smol__transform_mode mode, const void* src, int src_stride, void* dst, int dst_stride, int count) {
+
+	const char* in = (const char*)src;
+	char* out = (char*)dst;
+	//Local copy, so the compiler knows the output stores can't alias the matrix
+	smol_m4_t mat = *m;
+	int i = 0;
+
+#if defined(SMOL_MATH_SSE) || defined(SMOL_MATH_NEON)
+	//Every point is read as 4 floats, overreading one past z, so the very last point is left for 
+	//the scalar tail. All 4 points are loaded before anything is stored, which keeps in place safe.
+	for(; i + 4 < count; i += 4) {
+
+		const float* p0 = (const float*)(in + (size_t)i * src_stride);
+		const float* p1 = (const float*)((const char*)p0 + src_stride);
+		const float* p2 = (const float*)((const char*)p1 + src_stride);
+		const float* p3 = (const float*)((const char*)p2 + src_stride);
+
+		float* q0 = (float*)(out + (size_t)i * dst_stride);
+		float* q1 = (float*)((char*)q0 + dst_stride);
+		float* q2 = (float*)((char*)q1 + dst_stride);
+		float* q3 = (float*)((char*)q2 + dst_stride);
+
+	#if defined(SMOL_MATH_SSE)
+		__m128 x = _mm_loadu_ps(p0);
+		__m128 y = _mm_loadu_ps(p1);
+		__m128 z = _mm_loadu_ps(p2);
+		__m128 w = _mm_loadu_ps(p3);
+
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		smol__m4_transform_x4(&mat, mode, &x, &y, &z);
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+
+		_mm_storel_pi((__m64*)q0, x); _mm_store_ss(q0 + 2, _mm_movehl_ps(x, x));
+		_mm_storel_pi((__m64*)q1, y); _mm_store_ss(q1 + 2, _mm_movehl_ps(y, y));
+		_mm_storel_pi((__m64*)q2, z); _mm_store_ss(q2 + 2, _mm_movehl_ps(z, z));
+		_mm_storel_pi((__m64*)q3, w); _mm_store_ss(q3 + 2, _mm_movehl_ps(w, w));
+	#else 
+		smol_m4_t t;
+		t.x.simd = vld1q_f32(p0);
+		t.y.simd = vld1q_f32(p1);
+		t.z.simd = vld1q_f32(p2);
+		t.w.simd = vld1q_f32(p3);
+
+		t = smol_m4_transpose(t);
+		smol__m4_transform_x4(&mat, mode, &t.x.simd, &t.y.simd, &t.z.simd);
+		t = smol_m4_transpose(t);
+
+		vst1_f32(q0, vget_low_f32(t.x.simd)); vst1q_lane_f32(q0 + 2, t.x.simd, 2);
+		vst1_f32(q1, vget_low_f32(t.y.simd)); vst1q_lane_f32(q1 + 2, t.y.simd, 2);
+		vst1_f32(q2, vget_low_f32(t.z.simd)); vst1q_lane_f32(q2 + 2, t.z.simd, 2);
+		vst1_f32(q3, vget_low_f32(t.w.simd)); vst1q_lane_f32(q3 + 2, t.w.simd, 2);
+	#endif 
+
+	}
+#endif 
+
+	for(; i < count; i++) {
+
+		const float* p = (const float*)(in + (size_t)i * src_stride);
+		float* q = (float*)(out + (size_t)i * dst_stride);
+
+		float x = p[0], y = p[1], z = p[2];
+		smol__m4_transform_one(&mat, mode, &x, &y, &z);
+
+		q[0] = x;
+		q[1] = y;
+		q[2] = z;
+
+	}
+
+}
+
+static void smol__m4_transform_soa(const smol_m4_t* m, smol__transform_mode mode, const float* x, const float* y, const float* z, float* out_x, float* out_y, float* out_z, int count) {
+
+	//Local copy, so the compiler knows the output stores can't alias the matrix
+	smol_m4_t mat = *m;
+	int i = 0;
+
+#if defined(SMOL_MATH_SSE)
+	for(; i + 4 <= count; i += 4) {
+		__m128 vx = _mm_loadu_ps(x + i);
+		__m128 vy = _mm_loadu_ps(y + i);
+		__m128 vz = _mm_loadu_ps(z + i);
+		smol__m4_transform_x4(&mat, mode, &vx, &vy, &vz);
+		_mm_storeu_ps(out_x + i, vx);
+		_mm_storeu_ps(out_y + i, vy);
+		_mm_storeu_ps(out_z + i, vz);
+	}
+#elif defined(SMOL_MATH_NEON)
+	for(; i + 4 <= count; i += 4) {
+		float32x4_t vx = vld1q_f32(x + i);
+		float32x4_t vy = vld1q_f32(y + i);
+		float32x4_t vz = vld1q_f32(z + i);
+		smol__m4_transform_x4(&mat, mode, &vx, &vy, &vz);
+		vst1q_f32(out_x + i, vx);
+		vst1q_f32(out_y + i, vy);
+		vst1q_f32(out_z + i, vz);
+	}
+#endif 
+
+	for(; i < count; i++) {
+		float px = x[i], py = y[i], pz = z[i];
+		smol__m4_transform_one(&mat, mode, &px, &py, &pz);
+		out_x[i] = px;
+		out_y[i] = py;
+		out_z[i] = pz;
+	}
+
+}
+
+void smol_m4_transform_points(smol_m4_t m, const void* src, int src_stride, void* dst, int dst_stride, int count) {
+	smol__m4_transform_aos(&m, SMOL__TRANSFORM_POINTS, src, src_stride, dst, dst_stride, count);
+}
+
+void smol_m4_transform_vectors(smol_m4_t m, const void* src, int src_stride, void* dst, int dst_stride, int count) {
+	smol__m4_transform_aos(&m, SMOL__TRANSFORM_VECTORS, src, src_stride, dst, dst_stride, count);
+}
+
+void smol_m4_transform_project(smol_m4_t m, const void* src, int src_stride, void* dst, int dst_stride, int count) {
+	smol__m4_transform_aos(&m, SMOL__TRANSFORM_PROJECT, src, src_stride, dst, dst_stride, count);
+}
+
+void smol_m4_transform_points_soa(smol_m4_t m, const float* x, const float* y, const float* z, float* out_x, float* out_y, float* out_z, int count) {
+	smol__m4_transform_soa(&m, SMOL__TRANSFORM_POINTS, x, y, z, out_x, out_y, out_z, count);
+}
+
+void smol_m4_transform_vectors_soa(smol_m4_t m, const float* x, const float* y, const float* z, float* out_x, float* out_y, float* out_z, int count) {
+	smol__m4_transform_soa(&m, SMOL__TRANSFORM_VECTORS, x, y, z, out_x, out_y, out_z, count);
+}
+
+void smol_m4_transform_project_soa(smol_m4_t m, const float* x, const float* y, const float* z, float* out_x, float* out_y, float* out_z, int count) {
+	smol__m4_transform_soa(&m, SMOL__TRANSFORM_PROJECT, x, y, z, out_x, out_y, out_z, count);
+}
+
+#pragma endregion
+
+#pragma region Frustum culling
+
+smol_frustum_t smol_frustum_from_m4(smol_m4_t m) {
+
+	//Clip space is -w <= x, y, z <= w, so each plane is the last row plus or minus one of the others
+	smol_frustum_t frustum;
+	frustum.left_plane   = smol_v4_add(m.w, m.x);
+	frustum.right_plane  = smol_v4_sub(m.w, m.x);
+	frustum.bottom_plane = smol_v4_add(m.w, m.y);
+	frustum.top_plane    = smol_v4_sub(m.w, m.y);
+	frustum.near_plane   = smol_v4_add(m.w, m.z);
+	frustum.far_plane    = smol_v4_sub(m.w, m.z);
+
+	for(int i = 0; i < 6; i++) {
+		float len = smol_v3_len(frustum.planes[i].xyz);
+		frustum.planes[i] = smol_v4_mul(1.f / len, frustum.planes[i]);
+	}
+
+	return frustum;
+
+}
+
+int smol_frustum_test_sphere(const smol_frustum_t* frustum, smol_v3_t center, float radius) {
+
+	for(int i = 0; i < 6; i++) {
+		smol_v4_t p = frustum->planes[i];
+		if(!(p.x * center.x + p.y * center.y + p.z * center.z + p.w >= -radius))
+			return 0;
+	}
+
+	return 1;
+
+}
+
+int smol_frustum_test_aabb(const smol_frustum_t* frustum, smol_v3_t center, smol_v3_t extents) {
+
+	for(int i = 0; i < 6; i++) {
+		smol_v4_t p = frustum->planes[i];
+		//Projected radius of the box on the plane normal
+		float r = fabsf(p.x) * extents.x + fabsf(p.y) * extents.y + fabsf(p.z) * extents.z;
+		if(!(p.x * center.x + p.y * center.y + p.z * center.z + p.w >= -r))
+			return 0;
+	}
+
+	return 1;
+
+}
+
+//Appends the visible lanes of a 4 wide block to the index list. The index is always written and
+//the count advanced only for visible lanes; out_indices has room for count entries, so that's safe.
+#define SMOL__FRUSTUM_COMPACT(mask, base, out, num) do { \
+	for(int l = 0; l < 4; l++) { \
+		(out)[num] = (base) + l; \
+		(num) += ((mask) >> l) & 1; \
+	} \
+} while(0)
+
+int smol_frustum_cull_spheres(const smol_frustum_t* frustum, const float* x, const float* y, const float* z, const float* radius, int count, int* out_indices) {
+
+	int num = 0;
+	int i = 0;
+
+#if defined(SMOL_MATH_SSE)
+	for(; i + 4 <= count; i += 4) {
+
+		__m128 vx = _mm_loadu_ps(x + i);
+		__m128 vy = _mm_loadu_ps(y + i);
+		__m128 vz = _mm_loadu_ps(z + i);
+		__m128 nr = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+		__m128 inside = _mm_cmpeq_ps(vx, vx);
+
+		for(int p = 0; p < 6; p++) {
+			smol_v4_t pl = frustum->planes[p];
+			__m128 d = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pl.x), vx), _mm_mul_ps(_mm_set1_ps(pl.y), vy)),
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pl.z), vz), _mm_set1_ps(pl.w))
+			);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(d, nr));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		SMOL__FRUSTUM_COMPACT(mask, i, out_indices, num);
+
+	}
+#elif defined(SMOL_MATH_NEON)
+	for(; i + 4 <= count; i += 4) {
+
+		float32x4_t vx = vld1q_f32(x + i);
+		float32x4_t vy = vld1q_f32(y + i);
+		float32x4_t vz = vld1q_f32(z + i);
+		float32x4_t nr = vnegq_f32(vld1q_f32(radius + i));
+		uint32x4_t inside = vdupq_n_u32(0xFFFFFFFFu);
+
+		for(int p = 0; p < 6; p++) {
+			smol_v4_t pl = frustum->planes[p];
+			float32x4_t d = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(pl.w), vx, pl.x), vy, pl.y), vz, pl.z);
+			inside = vandq_u32(inside, vcgeq_f32(d, nr));
+		}
+
+		int mask = 
+			(vgetq_lane_u32(inside, 0) & 1) | 
+			(vgetq_lane_u32(inside, 1) & 2) | 
+			(vgetq_lane_u32(inside, 2) & 4) | 
+			(vgetq_lane_u32(inside, 3) & 8);
+		SMOL__FRUSTUM_COMPACT(mask, i, out_indices, num);
+
+	}
+#endif 
+
+	for(; i < count; i++) {
+		out_indices[num] = i;
+		num += smol_frustum_test_sphere(frustum, smol_v3(x[i], y[i], z[i]), radius[i]);
+	}
+
+	return num;
+
+}
+
+int smol_frustum_cull_aabbs(const smol_frustum_t* frustum, const float* x, const float* y, const float* z, const float* extent_x, const float* extent_y, const float* extent_z, int count, int* out_indices) {
+
+	int num = 0;
+	int i = 0;
+
+#if defined(SMOL_MATH_SSE) || defined(SMOL_MATH_NEON)
+	smol_v3_t abs_normals[6];
+	for(int p = 0; p < 6; p++) {
+		smol_v4_t pl = frustum->planes[p];
+		abs_normals[p] = smol_v3(fabsf(pl.x), fabsf(pl.y), fabsf(pl.z));
+	}
+#endif 
+
+#if defined(SMOL_MATH_SSE)
+	for(; i + 4 <= count; i += 4) {
+
+		__m128 vx = _mm_loadu_ps(x + i);
+		__m128 vy = _mm_loadu_ps(y + i);
+		__m128 vz = _mm_loadu_ps(z + i);
+		__m128 ex = _mm_loadu_ps(extent_x + i);
+		__m128 ey = _mm_loadu_ps(extent_y + i);
+		__m128 ez = _mm_loadu_ps(extent_z + i);
+		__m128 inside = _mm_cmpeq_ps(vx, vx);
+
+		for(int p = 0; p < 6; p++) {
+			smol_v4_t pl = frustum->planes[p];
+			__m128 d = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pl.x), vx), _mm_mul_ps(_mm_set1_ps(pl.y), vy)),
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pl.z), vz), _mm_set1_ps(pl.w))
+			);
+			__m128 r = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(abs_normals[p].x), ex), _mm_mul_ps(_mm_set1_ps(abs_normals[p].y), ey)),
+				_mm_mul_ps(_mm_set1_ps(abs_normals[p].z), ez)
+			);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		SMOL__FRUSTUM_COMPACT(mask, i, out_indices, num);
+
+	}
+#elif defined(SMOL_MATH_NEON)
+	for(; i + 4 <= count; i += 4) {
+
+		float32x4_t vx = vld1q_f32(x + i);
+		float32x4_t vy = vld1q_f32(y + i);
+		float32x4_t vz = vld1q_f32(z + i);
+		float32x4_t ex = vld1q_f32(extent_x + i);
+		float32x4_t ey = vld1q_f32(extent_y + i);
+		float32x4_t ez = vld1q_f32(extent_z + i);
+		uint32x4_t inside = vdupq_n_u32(0xFFFFFFFFu);
+
+		for(int p = 0; p < 6; p++) {
+			smol_v4_t pl = frustum->planes[p];
+			float32x4_t d = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(pl.w), vx, pl.x), vy, pl.y), vz, pl.z);
+			d = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(d, ex, abs_normals[p].x), ey, abs_normals[p].y), ez, abs_normals[p].z);
+			inside = vandq_u32(inside, vcgeq_f32(d, vdupq_n_f32(0.f)));
+		}
+
+		int mask = 
+			(vgetq_lane_u32(inside, 0) & 1) | 
+			(vgetq_lane_u32(inside, 1) & 2) | 
+			(vgetq_lane_u32(inside, 2) & 4) | 
+			(vgetq_lane_u32(inside, 3) & 8);
+		SMOL__FRUSTUM_COMPACT(mask, i, out_indices, num);
+
+	}
+#endif 
+
+	for(; i < count; i++) {
+		out_indices[num] = i;
+		num += smol_frustum_test_aabb(frustum, smol_v3(x[i], y[i], z[i]), smol_v3(extent_x[i], extent_y[i], extent_z[i]));
+	}
+
+	return num;
+
+}
+
+#undef SMOL__FRUSTUM_COMPACT
+
+#pragma endregion
+
+#pragma region Transform hierarchy
+
+static int smol__transforms_reserve(smol_transforms_t* t, int capacity) {
+
+	if(capacity <= t->capacity) 
+		return 1;
+
+	#define SMOL__TRANSFORMS_GROW(field) do { \
+		void* mem = SMOL_REALLOC(t->field, sizeof(*t->field) * capacity); \
+		if(!mem) return 0; \
+		t->field = mem; \
+	} while(0)
+
+	SMOL__TRANSFORMS_GROW(parent);
+	SMOL__TRANSFORMS_GROW(root);
+	SMOL__TRANSFORMS_GROW(root_end);
+	SMOL__TRANSFORMS_GROW(roots);
+	SMOL__TRANSFORMS_GROW(position);
+	SMOL__TRANSFORMS_GROW(rotation);
+	SMOL__TRANSFORMS_GROW(scale);
+	SMOL__TRANSFORMS_GROW(world);
+	SMOL__TRANSFORMS_GROW(dirty);
+
+	#undef SMOL__TRANSFORMS_GROW
+
+	t->capacity = capacity;
+
+	return 1;
+
+}
+
+int smol_transforms_create(smol_transforms_t* transforms, int capacity) {
+	memset(transforms, 0, sizeof(*transforms));
+	return smol__transforms_reserve(transforms, capacity > 0 ? capacity : 16);
+}
+
+void smol_transforms_destroy(smol_transforms_t* transforms) {
+	SMOL_FREE(transforms->parent);
+	SMOL_FREE(transforms->root);
+	SMOL_FREE(transforms->root_end);
+	SMOL_FREE(transforms->roots);
+	SMOL_FREE(transforms->position);
+	SMOL_FREE(transforms->rotation);
+	SMOL_FREE(transforms->scale);
+	SMOL_FREE(transforms->world);
+	SMOL_FREE(transforms->dirty);
+	memset(transforms, 0, sizeof(*transforms));
+}
+
+int smol_transforms_add(smol_transforms_t* transforms, int parent, smol_v3_t position, smol_quat_t rotation, smol_v3_t scale) {
+
+	smol_transforms_t* t = transforms;
+
+	if(parent >= t->count) 
+		return -1;
+
+	if(t->count == t->capacity && !smol__transforms_reserve(t, t->capacity * 2))
+		return -1;
+
+	int node = t->count++;
+
+	t->parent[node] = parent < 0 ? -1 : parent;
+	t->position[node] = position;
+	t->rotation[node] = rotation;
+	t->scale[node] = scale;
+	t->world[node] = smol_m4_identity();
+	t->dirty[node] = 1;
+
+	if(parent < 0) {
+		t->root[node] = node;
+		t->roots[t->num_roots++] = node;
+	} else {
+		t->root[node] = t->root[parent];
+	}
+
+	t->root_end[t->root[node]] = node;
+
+	return node;
+
+}
+
+void smol_transforms_set_position(smol_transforms_t* transforms, int node, smol_v3_t position) {
+	transforms->position[node] = position;
+	transforms->dirty[node] = 1;
+}
+
+void smol_transforms_set_rotation(smol_transforms_t* transforms, int node, smol_quat_t rotation) {
+	transforms->rotation[node] = rotation;
+	transforms->dirty[node] = 1;
+}
+
+void smol_transforms_set_scale(smol_transforms_t* transforms, int node, smol_v3_t scale) {
+	transforms->scale[node] = scale;
+	transforms->dirty[node] = 1;
+}
+
+smol_m4_t smol_transforms_local(const smol_transforms_t* transforms, int node) {
+
+	smol_quat_t q = transforms->rotation[node];
+	smol_v3_t p = transforms->position[node];
+	smol_v3_t s = transforms->scale[node];
+
+	float qxx = q.x * q.x, qyy = q.y * q.y, qzz = q.z * q.z, qww = q.w * q.w;
+	float qxy = q.x * q.y, qxz = q.x * q.z, qxw = q.x * q.w;
+	float qyz = q.y * q.z, qyw = q.y * q.w, qzw = q.z * q.w;
+
+	//Same rotation as smol_m4_rotate_quat, with the scale folded into the columns
+	smol_m4_t res;
+	res.x = smol_v4((2.f * (qww + qxx) - 1.f) * s.x, 2.f * (qxy + qzw) * s.y, 2.f * (qxz - qyw) * s.z, p.x);
+	res.y = smol_v4(2.f * (qxy - qzw) * s.x, (2.f * (qww + qyy) - 1.f) * s.y, 2.f * (qyz + qxw) * s.z, p.y);
+	res.z = smol_v4(2.f * (qxz + qyw) * s.x, 2.f * (qyz - qxw) * s.y, (2.f * (qww + qzz) - 1.f) * s.z, p.z);
+	res.w = smol_v4(0.f, 0.f, 0.f, 1.f);
+
+	return res;
+
+}
+
+//Recomputes the dirty nodes of [first, last] belonging to the given root (or any root when root < 0).
+//A node is recomputed when it's dirty or its parent was, the flags are cleared afterwards.
+static void smol__transforms_propagate(smol_transforms_t* t, int first, int last, int root) {
+
+	for(int i = first; i <= last; i++) {
+
+		if(root >= 0 && t->root[i] != root) 
+			continue;
+
+		int parent = t->parent[i];
+
+		if(parent >= 0 && t->dirty[parent]) 
+			t->dirty[i] = 1;
+
+		if(!t->dirty[i]) 
+			continue;
+
+		smol_m4_t local = smol_transforms_local(t, i);
+		t->world[i] = parent < 0 ? local : smol_m4_mul(t->world[parent], local);
+
+	}
+
+	for(int i = first; i <= last; i++) {
+		if(root < 0 || t->root[i] == root)
+			t->dirty[i] = 0;
+	}
+
+}
+
+void smol_transforms_update(smol_transforms_t* transforms) {
+	smol__transforms_propagate(transforms, 0, transforms->count - 1, -1);
+}
+
+void smol_transforms_update_root(smol_transforms_t* transforms, int root) {
+	smol__transforms_propagate(transforms, root, transforms->root_end[root], root);
+}
+
+#pragma endregion
+
 
 #endif
\ No newline at end of file
@@ -31,6 +31,7 @@ void load_font(const char* path);
 void save_font(const char* path);
 void export_c_header(const char* path);
 void export_c_blob(const char* path);
+void export_pxb(const char* path);
 
 BOOL SaveBitmapToFile(const char* filename, HBITMAP hBitmap);
 
@@ -493,6 +494,12 @@ int main() {
 			if(path) export_c_blob(path);
 		}
 
+		if(smol_key_hit(SMOLK_F9)) {
+			const char* exts[] = { "*.pxb" };
+			char* path = tinyfd_saveFileDialog("Export binary font", "", sizeof(exts)/sizeof(*exts), exts, NULL);
+			if(path) export_pxb(path);
+		}
+
 		if(cur_char < 0) cur_char = 0;
 		if(cur_char > (num_chars-1)) cur_char = (num_chars-1);
 
@@ -949,6 +956,47 @@ void export_c_blob(const char* path) {
 
 }
 
+//Writes the font as smol_canvas' precompiled binary format, loaded with smol_font_load_pxb / smol_font_from_pxb
+void export_pxb(const char* path) {
+
+	if(char_w > 32) {
+		printf("Glyphs wider than 32 pixels can't be exported as .pxb!\n");
+		return;
+	}
+
+	update_bounds();
+
+	smol_pxb_header_t header = { 0 };
+	memcpy(header.magic, "PXB1", 4);
+	header.glyph_width = char_w;
+	header.glyph_height = char_h;
+	header.num_glyphs = 128;
+	header.geometry_offset = sizeof(smol_pxb_header_t);
+	header.rows_offset = header.geometry_offset + 128 * sizeof(smol_font_hor_geometry_t);
+	header.file_size = header.rows_offset + 128 * char_h * sizeof(smol_u32);
+
+	smol_u32* rows = (smol_u32*)calloc(128 * char_h, sizeof(smol_u32));
+	for(int c = 0; c < 128; c++) {
+		if(!offsets[c]) continue;
+		for(int y = 0; y < char_h; y++)
+		for(int x = 0; x < char_w; x++) {
+			if(offsets[c][x + y * char_w])
+				rows[c * char_h + y] |= 1U << x;
+		}
+	}
+
+	FILE* file = fopen(path, "wb");
+	if(file) {
+		fwrite(&header, sizeof(header), 1, file);
+		fwrite(char_geometry, sizeof(char_geometry), 1, file);
+		fwrite(rows, sizeof(smol_u32), 128 * char_h, file);
+		fclose(file);
+	}
+
+	free(rows);
+
+}
+
 
 BOOL SaveBitmapToFile(const char* filename, HBITMAP hBitmap) {
 	BITMAP bitmap;
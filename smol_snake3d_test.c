@@ -668,7 +668,16 @@ int main(const int argc, const char* argv[]) {
 	glBindVertexArray(0);
 
 
-#define ADD_CUBE() cube_instances[num_cubes++]
+	//The cubes are gathered on the CPU first, then culled per viewport, so only the visible ones get uploaded
+	cube_inst_t* cube_candidates = malloc(sizeof(cube_inst_t) * MAX_NUM_CUBES);
+	float* cull_x = malloc(sizeof(float) * MAX_NUM_CUBES * 4);
+	float* cull_y = cull_x + MAX_NUM_CUBES;
+	float* cull_z = cull_y + MAX_NUM_CUBES;
+	float* cull_extent = cull_z + MAX_NUM_CUBES;
+	int* visible_cubes = malloc(sizeof(int) * MAX_NUM_CUBES);
+	int num_candidates = 0;
+
+#define ADD_CUBE() cube_candidates[num_candidates++]
 
 #ifndef __EMSCRIPTEN__
 	cube_inst_t* cube_instances = NULL;
@@ -1020,7 +1029,7 @@ int main(const int argc, const char* argv[]) {
 			glEnable(GL_DEPTH_TEST);
 
 			{
-				BEGIN_CUBES();
+				num_candidates = 0;
 	
 				ADD_CUBE() = (cube_inst_t){
 					.pos_scale = {
@@ -1045,6 +1054,22 @@ int main(const int argc, const char* argv[]) {
 					};
 				}
 
+				smol_frustum_t frustum = smol_frustum_from_m4(mvp_mat);
+
+				for(int i = 0; i < num_candidates; i++) {
+					cull_x[i] = cube_candidates[i].pos_scale.x;
+					cull_y[i] = cube_candidates[i].pos_scale.y;
+					cull_z[i] = cube_candidates[i].pos_scale.z;
+					cull_extent[i] = cube_candidates[i].pos_scale.w * .5f;
+				}
+
+				int num_visible = smol_frustum_cull_aabbs(&frustum, cull_x, cull_y, cull_z, cull_extent, cull_extent, cull_extent, num_candidates, visible_cubes);
+
+				BEGIN_CUBES();
+
+				for(int i = 0; i < num_visible; i++)
+					cube_instances[num_cubes++] = cube_candidates[visible_cubes[i]];
+
 				END_CUBES();
 			}
 
@@ -1137,6 +1162,9 @@ int main(const int argc, const char* argv[]) {
 
 	}
 
+	free(cube_candidates);
+	free(cull_x);
+	free(visible_cubes);
 
 	return 0;
 }
@@ -28,6 +28,12 @@
 #	define smol_offset_of(Type, Field) ((void*)&(((Type*)0)->Field))
 #endif 
 
+//Number of batches the vertex buffer ring can hold, each batch (begin - end - draw) gets its own 
+//stretch of the buffer, so the CPU only waits for the GPU when it laps a batch still being drawn.
+#ifndef SMOL_TEXT_RENDERER_REGIONS
+#	define SMOL_TEXT_RENDERER_REGIONS 3
+#endif 
+
 #ifndef SMOL_MATH_H
 #error This header requires smol_math.h be included before it!
 #else
@@ -36,12 +42,17 @@
 typedef struct _smol_font_hor_geometry_t smol_font_hor_geometry_t;
 typedef struct _smol_gl_font_t smol_gl_font_t;
 typedef struct _smol_text_renderer_t smol_text_renderer_t;
+typedef struct _smol_gl_text_run_t smol_gl_text_run_t;
 
 smol_gl_font_t smol_gl_font_create(const char* pixels, int char_w, int glyph_height, smol_font_hor_geometry_t* horizontal_geometry);
+smol_gl_font_t smol_gl_font_create_sdf(const char* pixels, int glyph_width, int glyph_height, smol_font_hor_geometry_t* horizontal_geometry, int resolution, float spread);
 smol_gl_font_t smol_font_load_pxf(const char* file_path);
+smol_gl_font_t smol_gl_font_load_pxb(const char* file_path);
 
 smol_text_renderer_t smol_text_renderer_create(const smol_gl_font_t* font, int max_characters);
+smol_text_renderer_t smol_text_renderer_create_instanced(const smol_gl_font_t* font, int max_characters);
 void smol_text_renderer_set_texture_uniform_slot(smol_text_renderer_t* tr, GLuint uniform_location, GLuint texture_slot);
+void smol_text_renderer_set_instanced_program(smol_text_renderer_t* tr, GLuint program);
 void smol_text_renderer_set_font(smol_text_renderer_t* tr, const smol_font_t* font);
 void smol_text_renderer_begin(smol_text_renderer_t* tr);
 void smol_text_renderer_end(smol_text_renderer_t* tr);
@@ -49,6 +60,14 @@ void smol_text_renderer_add_string(smol_text_renderer_t* tr, smol_v2_t pos, floa
 void smol_text_renderer_add_char(smol_text_renderer_t* tr, smol_v2_t pos, char chr, float scale, GLuint color);
 void smol_text_renderer_draw(smol_text_renderer_t* tr);
 
+int smol_gl_text_run_update(smol_gl_text_run_t* run, const smol_gl_font_t* font, float scale, const char* str);
+void smol_gl_text_run_destroy(smol_gl_text_run_t* run);
+void smol_text_renderer_add_run(smol_text_renderer_t* tr, const smol_gl_text_run_t* run, smol_v2_t pos, GLuint color);
+void smol_text_renderer_draw_run(smol_text_renderer_t* tr, smol_gl_text_run_t* run, smol_v2_t pos, GLuint color);
+
+void smol_text_renderer_set_glyph_cache(smol_text_renderer_t* tr, smol_glyph_cache_t* cache);
+void smol_text_renderer_add_string_utf8(smol_text_renderer_t* tr, smol_v2_t pos, float scale, GLuint color, const char* str);
+
 #ifdef SMOL_TEXT_RENDERER_IMPLEMENTATION
 
 #ifndef SMOL_CANVAS_H
@@ -71,17 +90,64 @@ typedef struct _smol_char_vertex_t {
 	GLuint color;
 } smol_char_vertex_t;
 
+//Per glyph record of the instanced path, the vertex shader expands it to a quad (res/shaders/text_instanced.vert)
+typedef struct _smol_glyph_instance_t {
+	smol_v2_t position;
+	GLushort glyph;
+	GLushort scale; //8.8 fixed point
+	GLuint color;
+} smol_glyph_instance_t;
+
+//A string laid out once as glyph instances relative to its origin. Drawn with smol_text_renderer_draw_run it 
+//lives in its own buffer, which is only uploaded again when the text, font or scale changes.
+typedef struct _smol_gl_text_run_t {
+	const smol_gl_font_t* font;
+	float scale;
+	GLuint hash;
+	char* text;
+	int text_capacity;
+	smol_glyph_instance_t* glyphs;
+	int num_glyphs;
+	int glyph_capacity;
+	smol_v2_t size;
+	GLuint vertex_buffer;
+	GLuint vertex_attribs;
+	int buffer_capacity; //Glyphs the vertex buffer has room for
+	int dirty; //Glyphs changed since the last upload
+} smol_gl_text_run_t;
+
 typedef struct _smol_text_renderer_t {
 	GLuint vertex_buffer;
 	GLuint index_buffer;
 	GLuint vertex_attribs;
-	smol_char_vertex_t* vertices;
+	union {
+		smol_char_vertex_t* vertices;
+		smol_glyph_instance_t* instances; //Used instead of vertices when instanced
+	};
 	GLuint vertex_count;
 	GLuint index_count;
 	GLuint texture_slot;
 	GLuint texture_uniform;
 	GLenum index_type;
 	const smol_gl_font_t* font;
+	GLuint instanced; //Vertex counts and offsets are in glyph instances instead of vertices when set
+	GLuint record_size; //Size of a vertex or a glyph instance
+	GLuint vertex_capacity; //Vertices per batch, the ring is SMOL_TEXT_RENDERER_REGIONS times that
+	GLuint base_vertex; //First vertex of the current batch
+	GLuint write_head; //First vertex of the next batch
+	GLuint lap; //Incremented every time the write head wraps around
+	void* vertex_storage; //The whole ring when it's persistently mapped, the CPU side copy on WebGL
+	GLint glyph_size_uniform;
+	GLint glyph_geometry_uniform;
+	GLint origin_uniform;
+	const smol_gl_font_t* uploaded_font; //Font whose geometry the instanced program's uniforms hold
+	smol_glyph_cache_t* glyph_cache;
+	GLuint* page_textures; //One texture per glyph cache page
+	int glyph_page; //Glyph cache page the batch samples, -1 when it samples the font's atlas
+#ifndef __EMSCRIPTEN__
+	GLsync region_fences[SMOL_TEXT_RENDERER_REGIONS];
+	GLuint region_laps[SMOL_TEXT_RENDERER_REGIONS];
+#endif 
 } smol_text_renderer_t;
 
 
@@ -128,6 +194,144 @@ smol_gl_font_t smol_gl_font_create(const char* pixels, int glyph_width, int glyp
 	return font;
 
 }
+
+//Offset to the nearest seed texel, used by the 8SSEDT passes below
+typedef struct _smol__sdf_point_t {
+	int dx;
+	int dy;
+} smol__sdf_point_t;
+
+#define SMOL__SDF_FAR 16384
+
+static void smol__sdf_compare(smol__sdf_point_t* grid, int w, int h, int x, int y, int ox, int oy) {
+
+	if(x + ox < 0 || x + ox >= w || y + oy < 0 || y + oy >= h)
+		return;
+
+	smol__sdf_point_t* p = &grid[x + y * w];
+	smol__sdf_point_t other = grid[(x + ox) + (y + oy) * w];
+	other.dx += ox;
+	other.dy += oy;
+
+	if(other.dx * other.dx + other.dy * other.dy < p->dx * p->dx + p->dy * p->dy)
+		*p = other;
+
+}
+
+//8 point sequential signed euclidean distance transform, two sweeps over the grid
+static void smol__sdf_8ssedt(smol__sdf_point_t* grid, int w, int h) {
+
+	for(int y = 0; y < h; y++) {
+		for(int x = 0; x < w; x++) {
+			smol__sdf_compare(grid, w, h, x, y, -1,  0);
+			smol__sdf_compare(grid, w, h, x, y,  0, -1);
+			smol__sdf_compare(grid, w, h, x, y, -1, -1);
+			smol__sdf_compare(grid, w, h, x, y,  1, -1);
+		}
+		for(int x = w - 1; x >= 0; x--)
+			smol__sdf_compare(grid, w, h, x, y, 1, 0);
+	}
+
+	for(int y = h - 1; y >= 0; y--) {
+		for(int x = w - 1; x >= 0; x--) {
+			smol__sdf_compare(grid, w, h, x, y,  1, 0);
+			smol__sdf_compare(grid, w, h, x, y,  0, 1);
+			smol__sdf_compare(grid, w, h, x, y, -1, 1);
+			smol__sdf_compare(grid, w, h, x, y,  1, 1);
+		}
+		for(int x = 0; x < w; x++)
+			smol__sdf_compare(grid, w, h, x, y, -1, 0);
+	}
+
+}
+
+//Same as smol_gl_font_create, but the atlas holds a signed distance field to be drawn with res/shaders/text_sdf.frag.
+//Every font pixel becomes resolution x resolution texels, spread is the distance in font pixels the field covers 
+//on both sides of a glyph's edge. The atlas is single channel and only holds the 128 glyphs, and it stays sharp 
+//at any scale so one atlas serves all text sizes.
+smol_gl_font_t smol_gl_font_create_sdf(const char* pixels, int glyph_width, int glyph_height, smol_font_hor_geometry_t* horizontal_geometry, int resolution, float spread) {
+
+	smol_gl_font_t font = { 0 };
+	font.font_def.glyph_width = glyph_width;
+	font.font_def.glyph_height = glyph_height;
+	font.font_def.geometry = horizontal_geometry;
+	//Texture coordinates stay in font pixels, the texture is just resolution times bigger
+	font.atlas_w = 16 * glyph_width;
+	font.atlas_h = 8 * glyph_height;
+
+	int cell_w = glyph_width * resolution;
+	int cell_h = glyph_height * resolution;
+	int tex_w = 16 * cell_w;
+	int tex_h = 8 * cell_h;
+	float inv_range = 1.f / (2.f * spread * (float)resolution);
+
+	unsigned char* memory = (unsigned char*)calloc(tex_w * tex_h, 1);
+	smol__sdf_point_t* inside = (smol__sdf_point_t*)malloc(2 * cell_w * cell_h * sizeof(smol__sdf_point_t));
+	smol__sdf_point_t* outside = inside + cell_w * cell_h;
+
+	if(memory && inside) {
+
+		const smol__sdf_point_t seed = { 0, 0 };
+		const smol__sdf_point_t far = { SMOL__SDF_FAR, SMOL__SDF_FAR };
+
+		for(int chr = 0; chr < 128; chr++) {
+
+			const char* glyph = &pixels[chr * glyph_width * glyph_height];
+			int num_lit = 0;
+
+			for(int y = 0; y < cell_h; y++)
+			for(int x = 0; x < cell_w; x++) {
+				int lit = glyph[(x / resolution) + (y / resolution) * glyph_width] > 0;
+				inside[x + y * cell_w] = lit ? seed : far;
+				outside[x + y * cell_w] = lit ? far : seed;
+				num_lit += lit;
+			}
+
+			//Empty glyphs are all "far outside", which is what the atlas was cleared to
+			if(!num_lit)
+				continue;
+
+			smol__sdf_8ssedt(inside, cell_w, cell_h);
+			smol__sdf_8ssedt(outside, cell_w, cell_h);
+
+			unsigned char* cell = &memory[(chr >> 4) * cell_h * tex_w + (chr & 15) * cell_w];
+			for(int y = 0; y < cell_h; y++)
+			for(int x = 0; x < cell_w; x++) {
+				smol__sdf_point_t in = inside[x + y * cell_w];
+				smol__sdf_point_t out = outside[x + y * cell_w];
+				float distance = (out.dx | out.dy) ?
+					 sqrtf((float)(out.dx * out.dx + out.dy * out.dy)) - .5f:
+					-sqrtf((float)(in.dx * in.dx + in.dy * in.dy)) + .5f;
+				float value = (.5f + distance * inv_range) * 255.f + .5f;
+				cell[x + y * tex_w] = (unsigned char)(value < 0.f ? 0.f : value > 255.f ? 255.f : value);
+			}
+
+		}
+
+		glGenTextures(1, &font.texture_id);
+		glBindTexture(GL_TEXTURE_2D, font.texture_id);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, tex_w, tex_h, 0, GL_RED, GL_UNSIGNED_BYTE, memory);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		//Distance in alpha, like the coverage of the other atlases
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_ONE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_ONE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_ONE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_RED);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	free(memory);
+	free(inside);
+
+	return font;
+
+}
+
 #ifndef __EMSCRIPTEN__
 #define INDICES_PER_QUAD 5
 #else 
@@ -135,6 +339,107 @@ smol_gl_font_t smol_gl_font_create(const char* pixels, int glyph_width, int glyp
 #endif 
 #define INDICES_PER_65K (65536 / INDICES_PER_QUAD)
 
+#ifndef __EMSCRIPTEN__
+//Persistent mapping needs GL 4.4 or ARB_buffer_storage
+static int smol__text_renderer_has_buffer_storage() {
+
+#if defined(GL_MAP_PERSISTENT_BIT) && defined(GL_NUM_EXTENSIONS)
+	GLint major = 0, minor = 0, num_extensions = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+	if(major > 4 || (major == 4 && minor >= 4))
+		return 1;
+
+	glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+	for(GLint i = 0; i < num_extensions; i++) {
+		const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if(ext && strcmp(ext, "GL_ARB_buffer_storage") == 0)
+			return 1;
+	}
+#endif 
+
+	return 0;
+
+}
+
+//Waits until the GPU is done with the previous lap's draws in the regions overlapping [first, first + count)
+static void smol__text_renderer_wait_regions(smol_text_renderer_t* tr, GLuint first, GLuint count) {
+
+	GLuint first_region = first / tr->vertex_capacity;
+	GLuint last_region = (first + count - 1) / tr->vertex_capacity;
+
+	for(GLuint r = first_region; r <= last_region && r < SMOL_TEXT_RENDERER_REGIONS; r++) {
+
+		if(!tr->region_fences[r] || tr->region_laps[r] == tr->lap)
+			continue;
+
+		GLenum res;
+		do {
+			res = glClientWaitSync(tr->region_fences[r], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		} while(res == GL_TIMEOUT_EXPIRED);
+
+		glDeleteSync(tr->region_fences[r]);
+		tr->region_fences[r] = NULL;
+
+	}
+
+}
+
+//Fences the regions the last drawn batch was read from
+static void smol__text_renderer_fence_regions(smol_text_renderer_t* tr, GLuint first, GLuint count) {
+
+	if(count == 0) 
+		return;
+
+	GLuint first_region = first / tr->vertex_capacity;
+	GLuint last_region = (first + count - 1) / tr->vertex_capacity;
+
+	for(GLuint r = first_region; r <= last_region && r < SMOL_TEXT_RENDERER_REGIONS; r++) {
+		if(tr->region_fences[r]) 
+			glDeleteSync(tr->region_fences[r]);
+		tr->region_fences[r] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		tr->region_laps[r] = tr->lap;
+	}
+
+}
+#endif 
+
+//Creates the vertex buffer ring, num_batch_bytes is the size of one batch
+static void smol__text_renderer_create_ring(smol_text_renderer_t* tr, GLuint num_batch_bytes) {
+
+#ifdef __EMSCRIPTEN__
+	tr->vertex_storage = malloc(num_batch_bytes);
+	memset(tr->vertex_storage, 0, num_batch_bytes);
+#endif 
+	glGenBuffers(1, &tr->vertex_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, tr->vertex_buffer);
+#ifdef __EMSCRIPTEN__
+	glBufferData(GL_ARRAY_BUFFER, num_batch_bytes, tr->vertex_storage, GL_DYNAMIC_DRAW);
+#else 
+	GLsizeiptr num_ring_bytes = (GLsizeiptr)num_batch_bytes * SMOL_TEXT_RENDERER_REGIONS;
+
+	if(smol__text_renderer_has_buffer_storage()) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, num_ring_bytes, NULL, flags);
+		tr->vertex_storage = glMapBufferRange(GL_ARRAY_BUFFER, 0, num_ring_bytes, flags);
+		
+		if(!tr->vertex_storage) {
+			//Storage is immutable, the fallback needs a fresh buffer
+			glDeleteBuffers(1, &tr->vertex_buffer);
+			glGenBuffers(1, &tr->vertex_buffer);
+			glBindBuffer(GL_ARRAY_BUFFER, tr->vertex_buffer);
+		}
+	} 
+	
+	if(!tr->vertex_storage) {
+		glBufferData(GL_ARRAY_BUFFER, num_ring_bytes, NULL, GL_DYNAMIC_DRAW);
+	}
+#endif 
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+}
+
 smol_text_renderer_t smol_text_renderer_create(const smol_gl_font_t* font, int max_characters) {
 
 	smol_text_renderer_t text_renderer = { 0 };
@@ -153,16 +458,12 @@ smol_text_renderer_t smol_text_renderer_create(const smol_gl_font_t* font, int m
 	GLuint num_vbo_bytes = max_characters * 4 * sizeof(smol_char_vertex_t);
 	GLuint num_ibo_bytes = max_characters * 5 * index_type_size;
 
-#ifdef __EMSCRIPTEN__
-	text_renderer.vertices = malloc(num_vbo_bytes);
-	memset(text_renderer.vertices, 0, num_vbo_bytes);
-#endif 
-	glGenBuffers(1, &text_renderer.vertex_buffer);
-	glGenBuffers(1, &text_renderer.index_buffer);
-	glBindBuffer(GL_ARRAY_BUFFER, text_renderer.vertex_buffer);
-	glBufferData(GL_ARRAY_BUFFER, num_vbo_bytes, text_renderer.vertices, GL_DYNAMIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	text_renderer.vertex_capacity = max_characters * 4;
+	text_renderer.record_size = sizeof(smol_char_vertex_t);
+	text_renderer.glyph_page = -1;
 
+	glGenBuffers(1, &text_renderer.index_buffer);
+	smol__text_renderer_create_ring(&text_renderer, num_vbo_bytes);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, text_renderer.index_buffer);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, num_ibo_bytes, NULL, GL_STATIC_DRAW);
 	
@@ -265,11 +566,86 @@ smol_text_renderer_t smol_text_renderer_create(const smol_gl_font_t* font, int m
 	return text_renderer;
 }
 
+//Points the per instance attributes at the glyph instances starting from the first one
+static void smol__text_renderer_point_instances(GLuint first) {
+
+	char* base = (char*)NULL + first * sizeof(smol_glyph_instance_t);
+
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(smol_glyph_instance_t), base + (size_t)smol_offset_of(smol_glyph_instance_t, position));
+	glVertexAttribIPointer(1, 2, GL_UNSIGNED_SHORT, sizeof(smol_glyph_instance_t), base + (size_t)smol_offset_of(smol_glyph_instance_t, glyph));
+	glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(smol_glyph_instance_t), base + (size_t)smol_offset_of(smol_glyph_instance_t, color));
+
+}
+
+//Uploads the glyph metrics the instanced vertex shader looks glyphs up from
+static void smol__text_renderer_upload_glyph_geometry(smol_text_renderer_t* tr, const smol_gl_font_t* font) {
+
+	GLfloat geometry[128 * 2];
+
+	for(int i = 0; i < 128; i++) {
+		geometry[i * 2 + 0] = font->font_def.geometry ? (float)font->font_def.geometry[i].offset_x : 0.f;
+		geometry[i * 2 + 1] = font->font_def.geometry ? (float)font->font_def.geometry[i].width : (float)font->font_def.glyph_width;
+	}
+
+	glUniform4f(
+		tr->glyph_size_uniform, 
+		(float)font->font_def.glyph_width, 
+		(float)font->font_def.glyph_height, 
+		1.f / (float)font->atlas_w, 
+		1.f / (float)font->atlas_h
+	);
+	glUniform4fv(tr->glyph_geometry_uniform, 64, geometry);
+
+	tr->uploaded_font = font;
+
+}
+
+//Glyphs are 16 byte instances instead of 4 vertices and 5 indices, drawn with res/shaders/text_instanced.vert
+smol_text_renderer_t smol_text_renderer_create_instanced(const smol_gl_font_t* font, int max_characters) {
+
+	smol_text_renderer_t text_renderer = { 0 };
+
+	text_renderer.font = font;
+	text_renderer.instanced = 1;
+	text_renderer.vertex_capacity = max_characters;
+	text_renderer.record_size = sizeof(smol_glyph_instance_t);
+	text_renderer.glyph_size_uniform = -1;
+	text_renderer.glyph_geometry_uniform = -1;
+	text_renderer.origin_uniform = -1;
+	text_renderer.glyph_page = -1;
+
+	smol__text_renderer_create_ring(&text_renderer, max_characters * sizeof(smol_glyph_instance_t));
+
+	glGenVertexArrays(1, &text_renderer.vertex_attribs);
+
+	glBindVertexArray(text_renderer.vertex_attribs);
+	glBindBuffer(GL_ARRAY_BUFFER, text_renderer.vertex_buffer);
+
+	for(GLuint i = 0; i < 3; i++) {
+		glEnableVertexAttribArray(i);
+		glVertexAttribDivisor(i, 1);
+	}
+	smol__text_renderer_point_instances(0);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	return text_renderer;
+}
+
 void smol_text_renderer_set_texture_uniform_slot(smol_text_renderer_t* tr, GLuint uniform_location, GLuint texture_slot) {
 	tr->texture_uniform = uniform_location;
 	tr->texture_slot = texture_slot;
 }
 
+//The glyph metrics are uploaded to this program on draw, so it should only be shared by one instanced renderer
+void smol_text_renderer_set_instanced_program(smol_text_renderer_t* tr, GLuint program) {
+	tr->glyph_size_uniform = glGetUniformLocation(program, "uGlyphSize");
+	tr->glyph_geometry_uniform = glGetUniformLocation(program, "uGlyphGeometry");
+	tr->origin_uniform = glGetUniformLocation(program, "uOrigin");
+	tr->uploaded_font = NULL;
+}
+
 void smol_text_renderer_set_font(smol_text_renderer_t* tr, const smol_font_t* font) {
 	if(tr->vertices) {
 		smol_text_renderer_end(tr);
@@ -285,24 +661,101 @@ void smol_text_renderer_begin(smol_text_renderer_t* tr) {
 	tr->vertex_count = 0;
 	tr->index_count = 0;
 #ifndef __EMSCRIPTEN__
-	glBindBuffer(GL_ARRAY_BUFFER, tr->vertex_buffer);
-	tr->vertices = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
+	//Every batch reserves room for the maximum amount of characters, wrap if that doesn't fit
+	if(tr->write_head + tr->vertex_capacity > tr->vertex_capacity * SMOL_TEXT_RENDERER_REGIONS) {
+		tr->write_head = 0;
+		tr->lap++;
+	}
+
+	tr->base_vertex = tr->write_head;
+	smol__text_renderer_wait_regions(tr, tr->base_vertex, tr->vertex_capacity);
+
+	if(tr->vertex_storage) {
+		tr->vertices = (void*)((char*)tr->vertex_storage + tr->base_vertex * tr->record_size);
+	} else {
+		//The fences already guard the range, so the driver doesn't need to sync on the map
+		glBindBuffer(GL_ARRAY_BUFFER, tr->vertex_buffer);
+		tr->vertices = glMapBufferRange(
+			GL_ARRAY_BUFFER, 
+			tr->base_vertex * tr->record_size, 
+			tr->vertex_capacity * tr->record_size, 
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+		);
+	}
+#else 
+	tr->vertices = tr->vertex_storage;
 #endif 
 }
 
 void smol_text_renderer_end(smol_text_renderer_t* tr) {
 #ifdef __EMSCRIPTEN__
 	glBindBuffer(GL_ARRAY_BUFFER, tr->vertex_buffer);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, tr->vertex_count * sizeof(smol_char_vertex_t), tr->vertices);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, tr->vertex_count * tr->record_size, tr->vertex_storage);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 #else 
-	glUnmapBuffer(GL_ARRAY_BUFFER);
+	if(!tr->vertex_storage) {
+		glBindBuffer(GL_ARRAY_BUFFER, tr->vertex_buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	tr->write_head = tr->base_vertex + tr->vertex_count;
 #endif 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	tr->vertices = NULL;
 }
 
+static void smol__text_renderer_flush(smol_text_renderer_t* tr) {
+	smol_text_renderer_end(tr);
+	smol_text_renderer_draw(tr);
+	smol_text_renderer_begin(tr);
+}
+
+static void smol__text_renderer_add_quad(smol_text_renderer_t* tr, smol_v2_t p0, smol_v2_t p1, smol_v2_t uv0, smol_v2_t uv1, GLuint color) {
+
+	tr->vertices[tr->vertex_count].position = p0;
+	tr->vertices[tr->vertex_count].texcoord = uv0;
+	tr->vertices[tr->vertex_count].color = color;
+	tr->vertex_count++;
+
+	tr->vertices[tr->vertex_count].position = smol_v2(p0.x, p1.y);
+	tr->vertices[tr->vertex_count].texcoord = smol_v2(uv0.x, uv1.y);
+	tr->vertices[tr->vertex_count].color = color;
+	tr->vertex_count++;
+
+	tr->vertices[tr->vertex_count].position = smol_v2(p1.x, p0.y);
+	tr->vertices[tr->vertex_count].texcoord = smol_v2(uv1.x, uv0.y);
+	tr->vertices[tr->vertex_count].color = color;
+	tr->vertex_count++;
+
+	tr->vertices[tr->vertex_count].position = p1;
+	tr->vertices[tr->vertex_count].texcoord = uv1;
+	tr->vertices[tr->vertex_count].color = color;
+	tr->vertex_count++;
+
+#ifdef __EMSCRIPTEN__
+	tr->index_count += 6;
+#else 
+	tr->index_count += 5;
+#endif 
+}
+
 void smol_text_renderer_add_char(smol_text_renderer_t* tr, smol_v2_t pos, char chr, float scale, GLuint color) {
 
+	if(tr->instanced) {
+		smol_glyph_instance_t* instance = &tr->instances[tr->vertex_count++];
+		instance->position = pos;
+		instance->glyph = (unsigned char)chr & 0x7F;
+		instance->scale = (GLushort)(scale * 256.f + .5f);
+		instance->color = color;
+		return;
+	}
+
+	//The font's atlas and the glyph cache pages are separate textures
+	if(tr->glyph_page >= 0) {
+		if(tr->vertex_count) 
+			smol__text_renderer_flush(tr);
+		tr->glyph_page = -1;
+	}
+
 	smol_gl_font_t* font = tr->font;
 
 	float hor_offset = 0;
@@ -336,35 +789,8 @@ void smol_text_renderer_add_char(smol_text_renderer_t* tr, smol_v2_t pos, char c
 	height *= scale;
 	width += scale;
 
-
-	tr->vertices[tr->vertex_count].position = smol_v2_add(pos, smol_v2(hor_offset, 0.f));
-	tr->vertices[tr->vertex_count].texcoord = uv0;
-	tr->vertices[tr->vertex_count].color = color;
-	tr->vertex_count++;
-
-	
-	tr->vertices[tr->vertex_count].position = smol_v2_add(pos, smol_v2(hor_offset, height));
-	tr->vertices[tr->vertex_count].texcoord = smol_v2(uv0.x, uv1.y);
-	tr->vertices[tr->vertex_count].color = color;
-	tr->vertex_count++;
-
-	
-	tr->vertices[tr->vertex_count].position = smol_v2_add(pos, smol_v2(hor_offset + width, 0));
-	tr->vertices[tr->vertex_count].texcoord = smol_v2(uv1.x, uv0.y);
-	tr->vertices[tr->vertex_count].color = color;
-	tr->vertex_count++;
-
-	
-	tr->vertices[tr->vertex_count].position = smol_v2_add(pos, smol_v2(hor_offset + width, height));
-	tr->vertices[tr->vertex_count].texcoord = uv1;
-	tr->vertices[tr->vertex_count].color = color;
-	tr->vertex_count++;
-
-#ifdef __EMSCRIPTEN__
-	tr->index_count += 6;
-#else 
-	tr->index_count += 5;
-#endif 
+	smol_v2_t p0 = smol_v2_add(pos, smol_v2(hor_offset, 0.f));
+	smol__text_renderer_add_quad(tr, p0, smol_v2_add(p0, smol_v2(width, height)), uv0, uv1, color);
 }
 
 
@@ -428,22 +854,345 @@ void smol_text_renderer_add_string(smol_text_renderer_t* tr, smol_v2_t pos, floa
 
 }
 
+//FNV-1a of the text, seeded with the font and the scale
+static GLuint smol__gl_text_run_hash(const smol_gl_font_t* font, float scale, const char* str, int* length) {
+
+	GLuint hash = 2166136261u;
+	GLuint scale_bits;
+	size_t font_bits = (size_t)font;
+	memcpy(&scale_bits, &scale, sizeof(scale_bits));
+
+	for(int i = 0; i < (int)sizeof(font_bits); i++)
+		hash = (hash ^ ((font_bits >> (i * 8)) & 0xFF)) * 16777619u;
+	for(int i = 0; i < 4; i++)
+		hash = (hash ^ ((scale_bits >> (i * 8)) & 0xFF)) * 16777619u;
+
+	const char* s = str;
+	for(; *s; s++)
+		hash = (hash ^ (unsigned char)*s) * 16777619u;
+
+	*length = (int)(s - str);
+	return hash;
+
+}
+
+//Lays the run out the same way smol_text_renderer_add_string does, returns 1 if the layout changed
+int smol_gl_text_run_update(smol_gl_text_run_t* run, const smol_gl_font_t* font, float scale, const char* str) {
+
+	int length = 0;
+	GLuint hash = smol__gl_text_run_hash(font, scale, str, &length);
+
+	if(run->text && run->hash == hash && run->font == font && run->scale == scale && strcmp(run->text, str) == 0)
+		return 0;
+
+	if(length + 1 > run->text_capacity) {
+		run->text_capacity = length + 1;
+		run->text = realloc(run->text, run->text_capacity);
+	}
+
+	if(length > run->glyph_capacity) {
+		run->glyph_capacity = length;
+		run->glyphs = realloc(run->glyphs, sizeof(smol_glyph_instance_t) * run->glyph_capacity);
+	}
+
+	memcpy(run->text, str, length + 1);
+	run->font = font;
+	run->scale = scale;
+	run->hash = hash;
+	run->num_glyphs = 0;
+	run->size = smol_v2(0.f, 0.f);
+	run->dirty = 1;
+
+	smol_v2_t cpos = smol_v2(0.f, 0.f);
+	float space = font->font_def.geometry ? font->font_def.geometry['_'].width : font->font_def.glyph_width;
+	float height = scale * (float)font->font_def.glyph_height;
+
+	for(int i = 0; i < length; i++) {
+
+		switch(str[i]) {
+			case ' ':
+			case '\t':
+				cpos.x += space * scale * (str[i]=='\t' ? 4 : 1);
+			break;
+			case '\n':
+				cpos.x = 0.f;
+				cpos.y += height;
+			break;
+			default: {
+				smol_glyph_instance_t* instance = &run->glyphs[run->num_glyphs++];
+				instance->position = cpos;
+				instance->glyph = (unsigned char)str[i] & 0x7F;
+				instance->scale = (GLushort)(scale * 256.f + .5f);
+				instance->color = 0xFFFFFFFF;
+
+				if(font->font_def.geometry) {
+					cpos.x += scale * font->font_def.geometry[instance->glyph].offset_x;
+					cpos.x += scale * font->font_def.geometry[instance->glyph].width;
+				} else {
+					cpos.x += scale * (float)font->font_def.glyph_width;
+				}
+
+				if(cpos.x > run->size.x) run->size.x = cpos.x;
+				if(cpos.y + height > run->size.y) run->size.y = cpos.y + height;
+			} break;
+		}
+
+	}
+
+	return 1;
+
+}
+
+void smol_gl_text_run_destroy(smol_gl_text_run_t* run) {
+	if(run->vertex_attribs) glDeleteVertexArrays(1, &run->vertex_attribs);
+	if(run->vertex_buffer) glDeleteBuffers(1, &run->vertex_buffer);
+	if(run->text) free(run->text);
+	if(run->glyphs) free(run->glyphs);
+	memset(run, 0, sizeof(smol_gl_text_run_t));
+}
+
+//Copies the run into the current batch, only the origin and the color are applied per glyph
+void smol_text_renderer_add_run(smol_text_renderer_t* tr, const smol_gl_text_run_t* run, smol_v2_t pos, GLuint color) {
+
+	if(tr->instanced) {
+		smol_glyph_instance_t* instances = &tr->instances[tr->vertex_count];
+		for(int i = 0; i < run->num_glyphs; i++) {
+			instances[i] = run->glyphs[i];
+			instances[i].position = smol_v2_add(pos, run->glyphs[i].position);
+			instances[i].color = color;
+		}
+		tr->vertex_count += run->num_glyphs;
+		return;
+	}
+
+	for(int i = 0; i < run->num_glyphs; i++) {
+		smol_v2_t glyph_pos = smol_v2_add(pos, run->glyphs[i].position);
+		smol_text_renderer_add_char(tr, glyph_pos, (char)run->glyphs[i].glyph, run->scale, color);
+	}
+
+}
+
+//Draws the run from its own buffer, for the instanced renderers only. Origin and color are set
+//through the uOrigin uniform and a constant color attribute, so moving or recoloring is free.
+void smol_text_renderer_draw_run(smol_text_renderer_t* tr, smol_gl_text_run_t* run, smol_v2_t pos, GLuint color) {
+
+	if(!tr->instanced || run->num_glyphs == 0)
+		return;
+
+	if(!run->vertex_buffer) {
+		glGenBuffers(1, &run->vertex_buffer);
+		glGenVertexArrays(1, &run->vertex_attribs);
+
+		glBindVertexArray(run->vertex_attribs);
+		glBindBuffer(GL_ARRAY_BUFFER, run->vertex_buffer);
+		for(GLuint i = 0; i < 2; i++) {
+			glEnableVertexAttribArray(i);
+			glVertexAttribDivisor(i, 1);
+		}
+		smol__text_renderer_point_instances(0);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	if(run->dirty) {
+		glBindBuffer(GL_ARRAY_BUFFER, run->vertex_buffer);
+		if(run->num_glyphs > run->buffer_capacity) {
+			run->buffer_capacity = run->glyph_capacity;
+			glBufferData(GL_ARRAY_BUFFER, run->buffer_capacity * sizeof(smol_glyph_instance_t), NULL, GL_STATIC_DRAW);
+		}
+		glBufferSubData(GL_ARRAY_BUFFER, 0, run->num_glyphs * sizeof(smol_glyph_instance_t), run->glyphs);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		run->dirty = 0;
+	}
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDisable(GL_CULL_FACE);
+
+	glActiveTexture(GL_TEXTURE0 + tr->texture_slot);
+	glBindTexture(GL_TEXTURE_2D, run->font->texture_id);
+	glUniform1i(tr->texture_uniform, tr->texture_slot);
+
+	if(tr->uploaded_font != run->font)
+		smol__text_renderer_upload_glyph_geometry(tr, run->font);
+	glUniform2f(tr->origin_uniform, pos.x, pos.y);
+
+	glBindVertexArray(run->vertex_attribs);
+	glVertexAttrib4f(
+		2, 
+		(float)((color >> 0x00) & 0xFF) / 255.f,
+		(float)((color >> 0x08) & 0xFF) / 255.f,
+		(float)((color >> 0x10) & 0xFF) / 255.f,
+		(float)((color >> 0x18) & 0xFF) / 255.f
+	);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, run->num_glyphs);
+	glBindVertexArray(0);
+	glDisable(GL_BLEND);
+
+}
+
+//Uploads the areas of the glyph cache pages that changed since the last draw
+static void smol__text_renderer_upload_pages(smol_text_renderer_t* tr) {
+
+	smol_glyph_cache_t* cache = tr->glyph_cache;
+
+	for(int p = 0; p < cache->num_pages; p++) {
+
+		smol_glyph_page_t* page = &cache->pages[p];
+		if(page->dirty_x0 >= page->dirty_x1 || page->dirty_y0 >= page->dirty_y1)
+			continue;
+
+		glBindTexture(GL_TEXTURE_2D, tr->page_textures[p]);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, cache->page_size);
+		glTexSubImage2D(
+			GL_TEXTURE_2D, 0, 
+			page->dirty_x0, page->dirty_y0, 
+			page->dirty_x1 - page->dirty_x0, page->dirty_y1 - page->dirty_y0, 
+			GL_RED, GL_UNSIGNED_BYTE, 
+			&page->pixels[page->dirty_x0 + page->dirty_y0 * cache->page_size]
+		);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		page->dirty_x0 = page->dirty_y0 = cache->page_size;
+		page->dirty_x1 = page->dirty_y1 = 0;
+
+	}
+
+}
+
+//The glyph cache is about to clear a page, draw what's batched from it first
+static void smol__text_renderer_evict_page(void* user_data, int page) {
+	smol_text_renderer_t* tr = (smol_text_renderer_t*)user_data;
+	if(tr->glyph_page == page && tr->vertices && tr->vertex_count)
+		smol__text_renderer_flush(tr);
+}
+
+//The renderer registers itself to the cache's eviction callback, so it must not be moved afterwards
+void smol_text_renderer_set_glyph_cache(smol_text_renderer_t* tr, smol_glyph_cache_t* cache) {
+
+	if(tr->page_textures) {
+		glDeleteTextures(tr->glyph_cache->max_pages, tr->page_textures);
+		free(tr->page_textures);
+	}
+
+	tr->glyph_cache = cache;
+	tr->glyph_page = -1;
+	tr->page_textures = malloc(cache->max_pages * sizeof(GLuint));
+	glGenTextures(cache->max_pages, tr->page_textures);
+
+	//Single channel coverage, swizzled so text.frag reads it from alpha
+	for(int p = 0; p < cache->max_pages; p++) {
+		glBindTexture(GL_TEXTURE_2D, tr->page_textures[p]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, cache->page_size, cache->page_size, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_ONE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_ONE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_ONE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_RED);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	cache->evict_func = smol__text_renderer_evict_page;
+	cache->evict_data = tr;
+
+}
+
+//Draws codepoints from the glyph cache, for the non-instanced renderers only
+void smol_text_renderer_add_string_utf8(smol_text_renderer_t* tr, smol_v2_t pos, float scale, GLuint color, const char* str) {
+
+	smol_glyph_cache_t* cache = tr->glyph_cache;
+
+	if(!cache || tr->instanced)
+		return;
+
+	float inv_page_size = 1.f / (float)cache->page_size;
+	smol_v2_t cpos = pos;
+
+	while(*str) {
+
+		smol_u32 codepoint;
+		str += smol_glyph_cache_decode_utf8(str, &codepoint);
+
+		if(codepoint == '\n') {
+			cpos.x = pos.x;
+			cpos.y += scale * (float)cache->cell_height;
+			continue;
+		}
+
+		const smol_glyph_entry_t* glyph = smol_glyph_cache_get(cache, codepoint);
+		if(!glyph)
+			continue;
+
+		if(glyph->page != SMOL_GLYPH_NO_PAGE) {
+
+			if(tr->glyph_page != glyph->page) {
+				if(tr->vertex_count)
+					smol__text_renderer_flush(tr);
+				tr->glyph_page = glyph->page;
+			}
+
+			smol_v2_t p0 = smol_v2_add(cpos, smol_v2(glyph->offset_x * scale, glyph->offset_y * scale));
+			smol_v2_t p1 = smol_v2_add(p0, smol_v2(glyph->width * scale, glyph->height * scale));
+			smol_v2_t uv0 = smol_v2(glyph->x * inv_page_size, glyph->y * inv_page_size);
+			smol_v2_t uv1 = smol_v2((glyph->x + glyph->width) * inv_page_size, (glyph->y + glyph->height) * inv_page_size);
+
+			smol__text_renderer_add_quad(tr, p0, p1, uv0, uv1, color);
+
+		}
+
+		cpos.x += glyph->advance * scale;
+
+	}
+
+}
+
 void smol_text_renderer_draw(smol_text_renderer_t* tr) {
 
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glDisable(GL_CULL_FACE);
 
+	if(tr->glyph_cache)
+		smol__text_renderer_upload_pages(tr);
+
 	glActiveTexture(GL_TEXTURE0 + tr->texture_slot);
-	glBindTexture(GL_TEXTURE_2D, tr->font->texture_id);
+	glBindTexture(GL_TEXTURE_2D, tr->glyph_page >= 0 ? tr->page_textures[tr->glyph_page] : tr->font->texture_id);
 	glUniform1i(tr->texture_uniform, tr->texture_slot);
 
+	if(tr->instanced) {
+
+		if(tr->uploaded_font != tr->font)
+			smol__text_renderer_upload_glyph_geometry(tr, tr->font);
+		glUniform2f(tr->origin_uniform, 0.f, 0.f);
+
+		glBindVertexArray(tr->vertex_attribs);
+	#ifndef __EMSCRIPTEN__
+		//No base instance before GL 4.2, so the attributes are pointed at the batch instead
+		glBindBuffer(GL_ARRAY_BUFFER, tr->vertex_buffer);
+		smol__text_renderer_point_instances(tr->base_vertex);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	#endif 
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, tr->vertex_count);
+	#ifndef __EMSCRIPTEN__
+		smol__text_renderer_fence_regions(tr, tr->base_vertex, tr->vertex_count);
+	#endif 
+		glBindVertexArray(0);
+		glDisable(GL_BLEND);
+		return;
+	}
+
 #ifndef __EMSCRIPTEN__
 	glEnable(GL_PRIMITIVE_RESTART);
 	glPrimitiveRestartIndex(tr->index_type == GL_UNSIGNED_SHORT ? 0xFFFF : 0xFFFFFFFF);
 	glBindVertexArray(tr->vertex_attribs);
-	glDrawElements(GL_TRIANGLE_STRIP, tr->index_count, tr->index_type, NULL);
+	glDrawElementsBaseVertex(GL_TRIANGLE_STRIP, tr->index_count, tr->index_type, NULL, tr->base_vertex);
 	glDisable(GL_PRIMITIVE_RESTART);
+	smol__text_renderer_fence_regions(tr, tr->base_vertex, tr->vertex_count);
 #else 
 	glBindVertexArray(tr->vertex_attribs);
 	glDrawElements(GL_TRIANGLES, tr->index_count, tr->index_type, NULL);
@@ -527,6 +1276,39 @@ smol_gl_font_t smol_font_load_pxf(const char* file_path) {
 
 	return font;
 	
+}
+
+//Loads a precompiled binary font (see smol_font_from_pxb), the bit rows only have to be expanded for the atlas
+smol_gl_font_t smol_gl_font_load_pxb(const char* file_path) {
+
+	smol_gl_font_t font = { 0 };
+	smol_font_t def = { 0 };
+	void* data = smol_font_load_pxb(file_path, &def);
+
+	if(!data)
+		return font;
+
+	int glyph_size = def.glyph_width * def.glyph_height;
+	char* pix_buffer = malloc(128 * glyph_size);
+	smol_font_hor_geometry_t* sizes = NULL;
+
+	for(int i = 0; i < 128 * def.glyph_height; i++) 
+	for(int x = 0; x < def.glyph_width; x++) 
+		pix_buffer[i * def.glyph_width + x] = (def.rows[i] >> x) & 1;
+
+	//The geometry stays with the font, the file data doesn't
+	if(def.geometry) {
+		sizes = malloc(sizeof(smol_font_hor_geometry_t) * 128);
+		memcpy(sizes, def.geometry, sizeof(smol_font_hor_geometry_t) * 128);
+	}
+
+	font = smol_gl_font_create(pix_buffer, def.glyph_width, def.glyph_height, sizes);
+
+	free(pix_buffer);
+	SMOL_FREE(data);
+
+	return font;
+
 }
 #endif 
 #endif 
@@ -34,7 +34,9 @@ distribution.
 #	ifndef SMOL_PLATFORM_LINUX
 #		define SMOL_PLATFORM_LINUX
 #	endif 
-# 	define _XOPEN_SOURCE 500
+#	ifndef _XOPEN_SOURCE
+# 		define _XOPEN_SOURCE 700
+#	endif 
 #	include <unistd.h>
 #	include <sys/types.h>
 #	include <sys/stat.h>
@@ -42,6 +44,45 @@ distribution.
 #	include <time.h>
 #	include <fcntl.h>
 #	include <dirent.h>
+#	include <sched.h>
+#	include <pthread.h>
+#	include <errno.h>
+#	include <sys/mman.h>
+#	if !defined(MADV_WILLNEED)
+//Strict ISO C modes hide madvise too, these are the values Linux uses.
+extern int madvise(void* addr, size_t length, int advice);
+#		define MADV_NORMAL 0
+#		define MADV_RANDOM 1
+#		define MADV_SEQUENTIAL 2
+#		define MADV_WILLNEED 3
+#		define MADV_DONTNEED 4
+#	endif 
+#	if !defined(SMOL_NO_IO_URING) && defined(__has_include)
+#		if __has_include(<linux/io_uring.h>)
+#			define SMOL__HAS_IO_URING
+#		endif 
+#	endif 
+#	if !defined(CLOCK_MONOTONIC)
+//Strict ISO C modes (-std=c99) hide the POSIX clocks, if the system headers were included before this file.
+struct timespec;
+extern int clock_gettime(clockid_t clock_id, struct timespec* tp);
+#		define CLOCK_MONOTONIC 1
+#		define SMOL__TIMESPEC_SHIM
+#	endif 
+#	if !defined(AT_FDCWD)
+//Same for the *at family (POSIX 2008), O_DIRECTORY is left out as it's value depends on the architecture.
+extern int openat(int dir_fd, const char* path, int flags, ...);
+extern int fstatat(int dir_fd, const char* path, struct stat* buffer, int flags);
+extern DIR* fdopendir(int fd);
+#		define AT_FDCWD -100
+#		define AT_SYMLINK_NOFOLLOW 0x100
+#	endif 
+#	if !defined(DT_DIR)
+#		define DT_UNKNOWN 0
+#		define DT_DIR 4
+#		define DT_REG 8
+#		define DT_LNK 10
+#	endif 
 #elif defined(__APPLE__)
 #	define SMOL_PLATFORM_MAC_OS
 //TODO:
@@ -61,8 +102,10 @@ distribution.
 
 #if defined(_WIN64) || defined(__linux__)
 typedef unsigned long long smol_size_t;
+typedef long long smol_ssize_t;
 #else 
 typedef unsigned int smol_size_t;
+typedef int smol_ssize_t;
 #endif 
 
 typedef void* smol_file_scan_session_t;
@@ -104,12 +147,75 @@ typedef struct _smol_file_info smol_file_info_t;
 #	define smol_offset_of(Type, Field) ((void*)&(((Type*)0)->Field))
 #endif 
 
-//smol_timer - Returns high precision system up time in seconds on
-//             Windows, and high precision time since Unix epoch on Linux. 
-//Returns: double - containing seconds.microseconds since the last start 
-//                  of the computer (win32) or since unix epoch (on linux) 
+//smol_timer - Returns high precision monotonic time in seconds. On Windows it's 
+//             the system up time, on Linux it's based on CLOCK_MONOTONIC.
+//Returns: double - containing seconds.nanoseconds since an unspecified starting point
 double smol_timer(); 
 
+//smol_cycles - Returns the CPU time stamp counter (rdtsc) on x86, on other architectures
+//              it falls back to smol_timer() in nanoseconds. Very cheap, but not synchronized with wall clock.
+//Returns: unsigned long long - containing the current cycle count
+unsigned long long smol_cycles(void);
+
+//smol_cycles_frequency - Returns the number of smol_cycles() ticks in second. It's calibrated 
+//                        against smol_timer() the first time it's called (takes about 10 milliseconds).
+//Returns: double - containing cycles per second
+double smol_cycles_frequency(void);
+
+/* --------------------------------------- */
+/*    INSTRUMENTATION (PROFILING ZONES)    */
+/* --------------------------------------- */
+
+//Profiling zones are compiled out, unless SMOL_PROFILER_ENABLE is defined before including this file.
+//Each thread records begin/end events into it's own ring buffer of SMOL_PROFILE_RING_SIZE events,
+//the oldest events get overwritten. The names must be string literals (or otherwise outlive the profiler).
+//Usage:
+//	SMOL_PROFILE_ZONE("frame");                  //Ends at the end of the current scope (GCC & Clang only)
+//	SMOL_PROFILE_BEGIN("blit"); ... SMOL_PROFILE_END();
+//	SMOL_PROFILE_BLOCK("mixer") { ... }          //Works on every compiler
+//	smol_profile_export_chrome_trace("trace.json"); //Open with chrome://tracing or ui.perfetto.dev
+
+#ifndef SMOL_PROFILE_RING_SIZE
+#define SMOL_PROFILE_RING_SIZE 65536 //Must be power of two
+#endif 
+
+//smol_profile_begin - Records a zone begin event for the calling thread
+void smol_profile_begin(const char* name);
+
+//smol_profile_end - Records a zone end event for the calling thread 
+void smol_profile_end(void);
+
+//smol_profile_export_chrome_trace - Writes all the recorded events in Chrome trace event JSON format. 
+//                                   Should be called when the other threads aren't recording.
+//Arguments:
+// - const char* file_path -- Path to the output file
+//Returns: int - SMOL_TRUE if successful, SMOL_FALSE otherwise
+int smol_profile_export_chrome_trace(const char* file_path);
+
+//smol_profile_reset - Discards all the recorded events
+void smol_profile_reset(void);
+
+#ifdef SMOL_PROFILER_ENABLE
+#	define SMOL_PROFILE_BEGIN(name) smol_profile_begin(name)
+#	define SMOL_PROFILE_END() smol_profile_end()
+#	define SMOL_PROFILE_CONCAT_(a, b) a##b
+#	define SMOL_PROFILE_CONCAT(a, b) SMOL_PROFILE_CONCAT_(a, b)
+#	define SMOL_PROFILE_BLOCK(name) for(int SMOL_PROFILE_CONCAT(smol__zone_, __LINE__) = (smol_profile_begin(name), 0); !SMOL_PROFILE_CONCAT(smol__zone_, __LINE__); SMOL_PROFILE_CONCAT(smol__zone_, __LINE__) = (smol_profile_end(), 1))
+#	if defined(__GNUC__) || defined(__clang__)
+static inline void smol__profile_zone_cleanup(const char** name) { (void)name; smol_profile_end(); }
+#		define SMOL_PROFILE_ZONE(name) const char* SMOL_PROFILE_CONCAT(smol__zone_, __LINE__) __attribute__((cleanup(smol__profile_zone_cleanup))) = (smol_profile_begin(name), (name))
+#	else 
+//No scope exit hooks in C on this compiler, use SMOL_PROFILE_BLOCK or SMOL_PROFILE_BEGIN/END instead.
+#		define SMOL_PROFILE_ZONE(name) (void)0
+#	endif 
+#else 
+#	define SMOL_PROFILE_BEGIN(name) (void)0
+#	define SMOL_PROFILE_END() (void)0
+#	define SMOL_PROFILE_BLOCK(name) 
+#	define SMOL_PROFILE_ZONE(name) (void)0
+#endif 
+
+
 
 /* --------------------------------------- */
 /* SOME UNICODE CONVERSION FUNCTIONALITY   */
@@ -161,6 +267,104 @@ int smol_utf16_to_utf8(const unsigned short* utf16, int buf_len, char* utf8);
 //Returns: int                      -- number of utf16 symbols written
 int smol_utf8_to_utf16(const char* utf8, int buf_len, unsigned short* utf16);
 
+/* ---------------------------------------- */
+/* BULK UNICODE TRANSCODING                 */
+/* ---------------------------------------- */
+
+//The buffer converters below work on whole strings, lengths and capacities are in code units (bytes for utf8, 
+//ushorts for utf16, uints for utf32). Runs of ASCII are handled 16 at a time with SSE2 / NEON when available.
+//The input is validated strictly: overlong forms, surrogate codepoints and unpaired surrogates are rejected.
+
+typedef enum {
+	SMOL_UTF_OK = 0,            //Everything was converted
+	SMOL_UTF_INVALID,           //Malformed input at 'read'
+	SMOL_UTF_TRUNCATED,         //The input ends in the middle of a sequence at 'read'
+	SMOL_UTF_OUTPUT_FULL        //The output ran out of space, the conversion can be continued from 'read'
+} smol_utf_status;
+
+typedef struct _smol_utf_result_t {
+	smol_utf_status status;
+	smol_size_t read;           //Number of input code units consumed
+	smol_size_t written;        //Number of output code units written
+} smol_utf_result_t;
+
+//Carries a partial sequence from a chunk to the next one, zero initialize before the first chunk.
+typedef struct _smol_utf_stream_t {
+	unsigned char pending[4];
+	unsigned short pending_surrogate;
+	int pending_count;
+} smol_utf_stream_t;
+
+//smol_utf8_validate - Checks that a buffer is valid utf8
+//Arguments:
+// - const char* utf8              -- utf8 encoded bytes
+// - smol_size_t length            -- Number of bytes
+// - smol_size_t* error_offset     -- Receives the offset of the first invalid or truncated sequence, may be NULL
+//Returns: int - SMOL_TRUE if the buffer is valid, SMOL_FALSE otherwise
+int smol_utf8_validate(const char* utf8, smol_size_t length, smol_size_t* error_offset);
+
+//smol_utf16_validate - Checks that a buffer is valid utf16 (no unpaired surrogates)
+//Arguments:
+// - const unsigned short* utf16   -- utf16 code units
+// - smol_size_t length            -- Number of code units
+// - smol_size_t* error_offset     -- Receives the offset of the first invalid code unit, may be NULL
+//Returns: int - SMOL_TRUE if the buffer is valid, SMOL_FALSE otherwise
+int smol_utf16_validate(const unsigned short* utf16, smol_size_t length, smol_size_t* error_offset);
+
+//smol_utf8_utf16_length, smol_utf8_utf32_length, smol_utf16_utf8_length, smol_utf16_utf32_length, 
+//smol_utf32_utf8_length, smol_utf32_utf16_length - Compute the exact number of code units needed to 
+//convert a valid buffer from one encoding to another, so the output can be allocated up front.
+smol_size_t smol_utf8_utf16_length(const char* utf8, smol_size_t length);
+smol_size_t smol_utf8_utf32_length(const char* utf8, smol_size_t length);
+smol_size_t smol_utf16_utf8_length(const unsigned short* utf16, smol_size_t length);
+smol_size_t smol_utf16_utf32_length(const unsigned short* utf16, smol_size_t length);
+smol_size_t smol_utf32_utf8_length(const unsigned int* utf32, smol_size_t length);
+smol_size_t smol_utf32_utf16_length(const unsigned int* utf32, smol_size_t length);
+
+//smol_utf8_to_utf16_buffer - Converts a utf8 buffer into utf16
+//Arguments:
+// - const char* utf8              -- utf8 encoded bytes
+// - smol_size_t length            -- Number of bytes
+// - unsigned short* utf16         -- Output buffer
+// - smol_size_t capacity          -- Number of code units available in the output buffer
+//Returns: smol_utf_result_t - Status and number of code units read and written
+smol_utf_result_t smol_utf8_to_utf16_buffer(const char* utf8, smol_size_t length, unsigned short* utf16, smol_size_t capacity);
+
+//smol_utf8_to_utf32_buffer - Converts a utf8 buffer into utf32, see smol_utf8_to_utf16_buffer
+smol_utf_result_t smol_utf8_to_utf32_buffer(const char* utf8, smol_size_t length, unsigned int* utf32, smol_size_t capacity);
+
+//smol_utf16_to_utf8_buffer - Converts a utf16 buffer into utf8, see smol_utf8_to_utf16_buffer
+smol_utf_result_t smol_utf16_to_utf8_buffer(const unsigned short* utf16, smol_size_t length, char* utf8, smol_size_t capacity);
+
+//smol_utf16_to_utf32_buffer - Converts a utf16 buffer into utf32, see smol_utf8_to_utf16_buffer
+smol_utf_result_t smol_utf16_to_utf32_buffer(const unsigned short* utf16, smol_size_t length, unsigned int* utf32, smol_size_t capacity);
+
+//smol_utf32_to_utf8_buffer - Converts a utf32 buffer into utf8, see smol_utf8_to_utf16_buffer
+smol_utf_result_t smol_utf32_to_utf8_buffer(const unsigned int* utf32, smol_size_t length, char* utf8, smol_size_t capacity);
+
+//smol_utf32_to_utf16_buffer - Converts a utf32 buffer into utf16, see smol_utf8_to_utf16_buffer
+smol_utf_result_t smol_utf32_to_utf16_buffer(const unsigned int* utf32, smol_size_t length, unsigned short* utf16, smol_size_t capacity);
+
+//smol_utf8_stream_to_utf16 - Converts a chunk of a utf8 stream into utf16. A sequence cut off at the end of the chunk
+//                            is kept in the stream and finished with the next chunk, so 'read' covers it.
+//Arguments:
+// - smol_utf_stream_t* stream     -- The stream state
+// - const char* utf8              -- The chunk
+// - smol_size_t length            -- Number of bytes in the chunk
+// - unsigned short* utf16         -- Output buffer
+// - smol_size_t capacity          -- Number of code units available in the output buffer
+// - int last_chunk                -- If SMOL_TRUE, a cut off sequence is reported as SMOL_UTF_TRUNCATED
+//Returns: smol_utf_result_t - Status and number of code units read and written. After SMOL_UTF_INVALID the 
+//                             stream is reset, and the conversion can be resumed past the bad byte.
+smol_utf_result_t smol_utf8_stream_to_utf16(smol_utf_stream_t* stream, const char* utf8, smol_size_t length, unsigned short* utf16, smol_size_t capacity, int last_chunk);
+
+//smol_utf8_stream_to_utf32 - Converts a chunk of a utf8 stream into utf32, see smol_utf8_stream_to_utf16
+smol_utf_result_t smol_utf8_stream_to_utf32(smol_utf_stream_t* stream, const char* utf8, smol_size_t length, unsigned int* utf32, smol_size_t capacity, int last_chunk);
+
+//smol_utf16_stream_to_utf8 - Converts a chunk of a utf16 stream into utf8, a surrogate pair may be split 
+//                            between the chunks. See smol_utf8_stream_to_utf16
+smol_utf_result_t smol_utf16_stream_to_utf8(smol_utf_stream_t* stream, const unsigned short* utf16, smol_size_t length, char* utf8, smol_size_t capacity, int last_chunk);
+
 /* ---------------------------------------------- */
 /* A SORTING UTILITITY BECAUSE QSORT WON'T CUT IT */
 /* ---------------------------------------------- */
@@ -179,18 +383,100 @@ void smol_sort(void* data, int num_elements, int element_size, smol_sort_proc co
 /* A RANDOM NUMBER GENERATOR FUNCTIONALITY */
 /* --------------------------------------- */
 
+//The generators are plain state objects, give each thread it's own. For independent streams from one seed, 
+//copy a generator and jump it (smol_xoshiro256_jump) or advance it (smol_pcg32_advance) per thread.
+
+typedef struct _smol_xoshiro256_t {
+	unsigned long long s[4];
+} smol_xoshiro256_t;
+
+typedef struct _smol_pcg32_t {
+	unsigned long long state;
+	unsigned long long inc;
+} smol_pcg32_t;
+
+//smol_xoshiro256_seed - Seeds a xoshiro256** generator, the seed is expanded with splitmix64
+//Arguments:
+// - smol_xoshiro256_t* rng         -- The generator
+// - unsigned long long seed        -- The random seed
+void smol_xoshiro256_seed(smol_xoshiro256_t* rng, unsigned long long seed);
+
+//smol_xoshiro256_next - Returns the next random 64bit integer
+unsigned long long smol_xoshiro256_next(smol_xoshiro256_t* rng);
+
+//smol_xoshiro256_jump - Advances the generator by 2^128 steps, gives 2^128 non-overlapping streams
+void smol_xoshiro256_jump(smol_xoshiro256_t* rng);
+
+//smol_xoshiro256_long_jump - Advances the generator by 2^192 steps, for streams of streams (e.g. per machine)
+void smol_xoshiro256_long_jump(smol_xoshiro256_t* rng);
+
+//smol_xoshiro256_bounded - Returns an unbiased random integer between [0..bound)
+//Arguments:
+// - smol_xoshiro256_t* rng         -- The generator
+// - unsigned int bound             -- The upper limit (exclusive), must be above 0
+//Returns: unsigned int - containing the random number
+unsigned int smol_xoshiro256_bounded(smol_xoshiro256_t* rng, unsigned int bound);
+
+//smol_xoshiro256_float - Returns a random float between [0..1)
+float smol_xoshiro256_float(smol_xoshiro256_t* rng);
+
+//smol_pcg32_seed - Seeds a PCG32 generator
+//Arguments:
+// - smol_pcg32_t* rng              -- The generator
+// - unsigned long long seed        -- The random seed
+// - unsigned long long stream      -- Selects one of 2^63 distinct sequences
+void smol_pcg32_seed(smol_pcg32_t* rng, unsigned long long seed, unsigned long long stream);
+
+//smol_pcg32_next - Returns the next random 32bit integer
+unsigned int smol_pcg32_next(smol_pcg32_t* rng);
+
+//smol_pcg32_advance - Skips ahead (or back, with a negative delta casted) in the sequence in O(log delta)
+//Arguments:
+// - smol_pcg32_t* rng              -- The generator
+// - unsigned long long delta       -- Number of steps to skip
+void smol_pcg32_advance(smol_pcg32_t* rng, unsigned long long delta);
+
+//smol_pcg32_bounded - Returns an unbiased random integer between [0..bound)
+//Arguments:
+// - smol_pcg32_t* rng              -- The generator
+// - unsigned int bound             -- The upper limit (exclusive), must be above 0
+//Returns: unsigned int - containing the random number
+unsigned int smol_pcg32_bounded(smol_pcg32_t* rng, unsigned int bound);
+
+//smol_pcg32_float - Returns a random float between [0..1)
+float smol_pcg32_float(smol_pcg32_t* rng);
+
+//smol_rand_fill_u32 - Fills an array with random 32bit integers. Large arrays are generated with 4 SIMD lanes 
+//                     seeded from the generator, so the values differ from calling smol_xoshiro256_next in a loop.
+//Arguments:
+// - smol_xoshiro256_t* rng         -- The generator, NULL uses the global one (smol_randomize)
+// - unsigned int* values           -- The array to be filled
+// - smol_size_t count              -- Number of values
+void smol_rand_fill_u32(smol_xoshiro256_t* rng, unsigned int* values, smol_size_t count);
+
+//smol_rand_fill_f32 - Fills an array with random floats between [minimum...maximum), see smol_rand_fill_u32
+//Arguments:
+// - smol_xoshiro256_t* rng         -- The generator, NULL uses the global one (smol_randomize)
+// - float* values                  -- The array to be filled
+// - smol_size_t count              -- Number of values
+// - float minimum                  -- The lowest number in the range
+// - float maximum                  -- The highest number-epsilon in the range
+void smol_rand_fill_f32(smol_xoshiro256_t* rng, float* values, smol_size_t count, float minimum, float maximum);
+
+//The functions below use a global xoshiro256** generator, they aren't thread safe.
+
 //smol_randomize - Randomizes the random generator
 //Arguments:
 // - int seed                       -- The random seed
 void smol_randomize(unsigned int seed);
 
-//smol_rand - Returns a random integer between [0..SMOL_RAND_MAX)
+//smol_rand - Returns a random integer between [0..SMOL_RAND_MAX]
 unsigned int smol_rand();
 
 //smol_randf - Returns a random float between [0..1)
 float smol_randf();
 
-//smol_rnd - Returns an exclusive random integer berween [minimum...maximum)
+//smol_rnd - Returns an exclusive random integer berween [minimum...maximum), without modulo bias
 //Arguments:
 // - int minimum - The lowest number in the range
 // - int maximum - The highhest number-1 in the range
@@ -382,11 +668,11 @@ struct { \
 } (void)0
 
 #define smol_vector_resize(vec, size) { \
-	if(size > (vec)->allocation) { \
-		(vec)->allocation = ((size / (vec)->allocation)+1)*(vec)->allocation; \
+	if((size) > (vec)->allocation) { \
+		(vec)->allocation = (((size) / (vec)->allocation)+1)*(vec)->allocation; \
 		((void**)&(vec)->data)[0] = SMOL_REALLOC((vec)->data, sizeof(*((vec)->data)) * (vec)->allocation); \
 	} \
-	(vec)->count = size; \
+	(vec)->count = (size); \
 }
 
 //smol_vector_pop - Pops the last object from the vector
@@ -536,7 +822,8 @@ struct { \
 /*       QUEUE STUFF      */
 /* -----------------------*/
 
-
+//This macro can be used to define a queue type, or declare a local variable: smol_queue(int) int_queue;
+//NOTE: 'first' is kept within [0...allocation) and 'last' is always first + count. 
 #define smol_queue(type) \
 struct { \
 	int allocation; \
@@ -545,15 +832,26 @@ struct { \
 	type* data; \
 }
 
+//smol__queue_grow - Doubles queue allocation, and moves the wrapped around elements after the old end,
+//                   so that (first + index) % allocation still points to the same elements. 
+//Arguments:
+// - void** data        -- A pointer to the queue data pointer
+// - int* allocation    -- A pointer to the queue allocation
+// - int first          -- The index of the first element
+// - int last           -- The index one past the last element
+// - int element_size   -- Size of a single element in bytes
+void smol__queue_grow(void** data, int* allocation, int first, int last, int element_size);
+
 #define smol_queue_init(queue, initial_alloc) { \
-	(queue)->allocation = initial_alloc; \
-	(void*)((queue)->data) = SMOL_ALLOC(sizeof(*((queue)->data))*initial_alloc); \
+	(queue)->allocation = (initial_alloc) > 0 ? (initial_alloc) : 1; \
+	((void**)&(queue)->data)[0] = SMOL_ALLOC(sizeof(*((queue)->data))*(queue)->allocation); \
 	(queue)->first = 0; \
 	(queue)->last = 0; \
 } (void)0
 
 #define smol_queue_free(queue) {\
 	if((queue)->data) SMOL_FREE((void*)((queue)->data)); \
+	(queue)->data = NULL; \
 	(queue)->allocation = 0; \
 	(queue)->first = 0; \
 	(queue)->last = 0; \
@@ -566,39 +864,335 @@ struct { \
 	((queue)->last - (queue)->first)
 
 #define smol_queue_push_back(queue, value) { \
-	if(smol_queue_count(queue) >= (queue)->allocation) { \
-		(queue)->allocation <<= 1; \
-		(void*)((queue)->data) = SMOL_REALLOC((void*)((queue)->data), sizeof(*((queue)->data))*(queue)->allocation); \
-	} \
-	(queue)->data[((queue)->allocation + (queue)->last++) % (queue)->allocation] = value; \
+	if(smol_queue_count(queue) >= (queue)->allocation) \
+		smol__queue_grow((void**)&(queue)->data, &(queue)->allocation, (queue)->first, (queue)->last, sizeof(*((queue)->data))); \
+	(queue)->data[(queue)->last++ % (queue)->allocation] = value; \
 } (void)0
 
 #define smol_queue_push_front(queue, value) { \
-	if(smol_queue_count(queue) >= (queue)->allocation) { \
-		(queue)->allocation <<= 1; \
-		(void*)((queue)->data) = SMOL_REALLOC((void*)((queue)->data), sizeof(*((queue)->data))*(queue)->allocation); \
+	if(smol_queue_count(queue) >= (queue)->allocation) \
+		smol__queue_grow((void**)&(queue)->data, &(queue)->allocation, (queue)->first, (queue)->last, sizeof(*((queue)->data))); \
+	if(--(queue)->first < 0) { \
+		(queue)->first += (queue)->allocation; \
+		(queue)->last += (queue)->allocation; \
 	} \
-	(queue)->data[((queue)->allocation + (queue)->first) % (queue)->allocation] = value; \
+	(queue)->data[(queue)->first] = value; \
 } (void)0
 
 #define smol_queue_at(queue, index) \
-	((queue)->data[((queue)->allocation + (queue)->first + index)  % (queue)->allocation])
+	((queue)->data[((queue)->first + (index)) % (queue)->allocation])
 
 #define smol_queue_pop_front(queue) {\
-	((queue)->data[((queue)->allocation + (queue)->first++) % (queue)->allocation]); \
-	if((queue)->first == (queue)->last) smol_queue_clear(queue); \
+	if(++(queue)->first >= (queue)->last) smol_queue_clear(queue); \
+	else if((queue)->first >= (queue)->allocation) { \
+		(queue)->first -= (queue)->allocation; \
+		(queue)->last -= (queue)->allocation; \
+	} \
 } (void)0
 
 #define smol_queue_pop_back(queue) { \
-	((queue)->data[((queue)->allocation + --(queue)->last) % (queue)->allocation]); \
-	if((queue)->first == (queue)->last) smol_queue_clear(queue); \
+	if(--(queue)->last <= (queue)->first) smol_queue_clear(queue); \
 } (void)0
 
 #define smol_queue_front(queue) \
-	((queue)->data[((queue)->allocation + (queue)->first) % (queue)->allocation])
+	((queue)->data[(queue)->first])
 
 #define smol_queue_back(queue) \
-	((queue)->data[((queue)->allocation + ((queue)->last - 1)) % (queue)->allocation])
+	((queue)->data[((queue)->last - 1) % (queue)->allocation])
+
+/* ---------------------------------------- */
+/*  ATOMICS AND LOCK-FREE (THREADSAFE) QUEUES */
+/* ---------------------------------------- */
+
+#ifndef SMOL_CACHE_LINE_SIZE
+#define SMOL_CACHE_LINE_SIZE 64
+#endif 
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#	if defined(_WIN64)
+#		define smol__atomic_cas_impl(ptr, desired, expected) ((smol_size_t)_InterlockedCompareExchange64((volatile __int64*)(ptr), (__int64)(desired), (__int64)(expected)))
+#		define smol__atomic_add_impl(ptr, value) ((smol_size_t)_InterlockedExchangeAdd64((volatile __int64*)(ptr), (__int64)(value)))
+#		define smol__atomic_xchg_impl(ptr, value) ((smol_size_t)_InterlockedExchange64((volatile __int64*)(ptr), (__int64)(value)))
+#	else 
+#		define smol__atomic_cas_impl(ptr, desired, expected) ((smol_size_t)_InterlockedCompareExchange((volatile long*)(ptr), (long)(desired), (long)(expected)))
+#		define smol__atomic_add_impl(ptr, value) ((smol_size_t)_InterlockedExchangeAdd((volatile long*)(ptr), (long)(value)))
+#		define smol__atomic_xchg_impl(ptr, value) ((smol_size_t)_InterlockedExchange((volatile long*)(ptr), (long)(value)))
+#	endif 
+#endif 
+
+//smol_atomic_load - Loads a value with acquire semantics
+//Arguments:
+// - volatile smol_size_t* ptr -- A pointer to the value
+//Returns: smol_size_t - containing the loaded value
+SMOL_INLINE smol_size_t smol_atomic_load(volatile smol_size_t* ptr) {
+#if defined(_MSC_VER) && defined(_M_ARM64)
+	return (smol_size_t)__ldar64((unsigned __int64 volatile*)ptr);
+#elif defined(_MSC_VER) && defined(_M_ARM)
+	smol_size_t value = *ptr;
+	__dmb(_ARM_BARRIER_ISH);
+	return value;
+#elif defined(_MSC_VER)
+	//x86 and x64 loads already have acquire semantics, only the compiler has to be kept from reordering
+	smol_size_t value = *ptr;
+	_ReadWriteBarrier();
+	return value;
+#else 
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#endif 
+}
+
+//smol_atomic_store - Stores a value with release semantics
+//Arguments:
+// - volatile smol_size_t* ptr -- A pointer to the value
+// - smol_size_t value         -- The value to be stored
+SMOL_INLINE void smol_atomic_store(volatile smol_size_t* ptr, smol_size_t value) {
+#if defined(_MSC_VER) && defined(_M_ARM64)
+	__stlr64((unsigned __int64 volatile*)ptr, (unsigned __int64)value);
+#elif defined(_MSC_VER) && defined(_M_ARM)
+	__dmb(_ARM_BARRIER_ISH);
+	*ptr = value;
+#elif defined(_MSC_VER)
+	//x86 and x64 stores already have release semantics, only the compiler has to be kept from reordering
+	_ReadWriteBarrier();
+	*ptr = value;
+#else 
+	__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#endif 
+}
+
+//smol_atomic_cas - Compare and swap, stores 'desired' if the value equals 'expected'
+//Arguments:
+// - volatile smol_size_t* ptr -- A pointer to the value
+// - smol_size_t expected      -- The value expected to be found
+// - smol_size_t desired       -- The value to be stored
+//Returns: int - SMOL_TRUE if the swap happened, SMOL_FALSE otherwise
+SMOL_INLINE int smol_atomic_cas(volatile smol_size_t* ptr, smol_size_t expected, smol_size_t desired) {
+#if defined(_MSC_VER)
+	return smol__atomic_cas_impl(ptr, desired, expected) == expected;
+#else 
+	return __atomic_compare_exchange_n(ptr, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+#endif 
+}
+
+//smol_atomic_fetch_add - Adds a value atomically
+//Arguments:
+// - volatile smol_size_t* ptr -- A pointer to the value
+// - smol_size_t value         -- The value to be added
+//Returns: smol_size_t - containing the value before the addition
+SMOL_INLINE smol_size_t smol_atomic_fetch_add(volatile smol_size_t* ptr, smol_size_t value) {
+#if defined(_MSC_VER)
+	return smol__atomic_add_impl(ptr, value);
+#else 
+	return __atomic_fetch_add(ptr, value, __ATOMIC_SEQ_CST);
+#endif 
+}
+
+//smol_atomic_exchange - Swaps a value atomically
+//Arguments:
+// - volatile smol_size_t* ptr -- A pointer to the value
+// - smol_size_t value         -- The value to be stored
+//Returns: smol_size_t - containing the previous value
+SMOL_INLINE smol_size_t smol_atomic_exchange(volatile smol_size_t* ptr, smol_size_t value) {
+#if defined(_MSC_VER)
+	return smol__atomic_xchg_impl(ptr, value);
+#else 
+	return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+#endif 
+}
+
+//smol_atomic_fence - A full (sequentially consistent) memory fence
+SMOL_INLINE void smol_atomic_fence(void) {
+#if defined(_MSC_VER)
+	MemoryBarrier();
+#else 
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif 
+}
+
+//smol_cpu_relax - A hint for the CPU that we're in a spin loop
+SMOL_INLINE void smol_cpu_relax(void) {
+#if defined(_MSC_VER)
+	YieldProcessor();
+#elif defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#endif 
+}
+
+//smol_mpmc_queue_t - A bounded multi producer / multi consumer queue with 
+//per cell sequence numbers (Dmitry Vyukov's algorithm), elements are copied in and out.
+typedef struct _smol_mpmc_queue_t {
+	char* cells;
+	smol_size_t mask;
+	int cell_size;
+	int element_size;
+	char pad0[SMOL_CACHE_LINE_SIZE];
+	volatile smol_size_t enqueue_pos;
+	char pad1[SMOL_CACHE_LINE_SIZE - sizeof(smol_size_t)];
+	volatile smol_size_t dequeue_pos;
+	char pad2[SMOL_CACHE_LINE_SIZE - sizeof(smol_size_t)];
+} smol_mpmc_queue_t;
+
+//smol_mpmc_queue_init - Initializes a MPMC queue
+//Arguments:
+// - smol_mpmc_queue_t* queue -- The queue to be initialized
+// - int capacity             -- Maximum number of elements, rounded up to a power of two
+// - int element_size         -- Size of a single element in bytes
+//Returns: int - SMOL_TRUE if successful, SMOL_FALSE otherwise
+int smol_mpmc_queue_init(smol_mpmc_queue_t* queue, int capacity, int element_size);
+
+//smol_mpmc_queue_free - Frees a MPMC queue, no other thread may be using the queue at this point
+void smol_mpmc_queue_free(smol_mpmc_queue_t* queue);
+
+//smol_mpmc_queue_push - Copies an element into the queue
+//Arguments:
+// - smol_mpmc_queue_t* queue -- The queue
+// - const void* element      -- A pointer to the element
+//Returns: int - SMOL_TRUE if successful, SMOL_FALSE if the queue was full
+int smol_mpmc_queue_push(smol_mpmc_queue_t* queue, const void* element);
+
+//smol_mpmc_queue_pop - Copies an element out of the queue
+//Arguments:
+// - smol_mpmc_queue_t* queue -- The queue
+// - void* element            -- A pointer where the element is copied to
+//Returns: int - SMOL_TRUE if successful, SMOL_FALSE if the queue was empty
+int smol_mpmc_queue_pop(smol_mpmc_queue_t* queue, void* element);
+
+//smol_spsc_queue_t - A bounded single producer / single consumer ring buffer. 
+//Both sides keep a cached copy of the other side's index, to avoid touching it's cache line every time.
+typedef struct _smol_spsc_queue_t {
+	char* data;
+	smol_size_t mask;
+	int element_size;
+	char pad0[SMOL_CACHE_LINE_SIZE];
+	volatile smol_size_t head; //Written by consumer
+	smol_size_t cached_tail;
+	char pad1[SMOL_CACHE_LINE_SIZE - sizeof(smol_size_t) * 2];
+	volatile smol_size_t tail; //Written by producer
+	smol_size_t cached_head;
+	char pad2[SMOL_CACHE_LINE_SIZE - sizeof(smol_size_t) * 2];
+} smol_spsc_queue_t;
+
+//smol_spsc_queue_init - Initializes a SPSC queue
+//Arguments:
+// - smol_spsc_queue_t* queue -- The queue to be initialized
+// - int capacity             -- Maximum number of elements, rounded up to a power of two
+// - int element_size         -- Size of a single element in bytes
+//Returns: int - SMOL_TRUE if successful, SMOL_FALSE otherwise
+int smol_spsc_queue_init(smol_spsc_queue_t* queue, int capacity, int element_size);
+
+//smol_spsc_queue_free - Frees a SPSC queue
+void smol_spsc_queue_free(smol_spsc_queue_t* queue);
+
+//smol_spsc_queue_push - Copies an element into the queue, call only from the producer thread
+//Returns: int - SMOL_TRUE if successful, SMOL_FALSE if the queue was full
+int smol_spsc_queue_push(smol_spsc_queue_t* queue, const void* element);
+
+//smol_spsc_queue_pop - Copies an element out of the queue, call only from the consumer thread
+//Returns: int - SMOL_TRUE if successful, SMOL_FALSE if the queue was empty
+int smol_spsc_queue_pop(smol_spsc_queue_t* queue, void* element);
+
+/* ---------------------------------------- */
+/*   THREADS, AND A WORK STEALING JOB SYSTEM  */
+/* ---------------------------------------- */
+
+#if defined(SMOL_PLATFORM_WINDOWS)
+typedef HANDLE smol_thread_t;
+typedef CRITICAL_SECTION smol_mutex_t;
+typedef CONDITION_VARIABLE smol_cond_t;
+#elif defined(SMOL_PLATFORM_LINUX)
+typedef pthread_t smol_thread_t;
+typedef pthread_mutex_t smol_mutex_t;
+typedef pthread_cond_t smol_cond_t;
+#endif 
+
+typedef void(*smol_thread_proc)(void* user_data);
+
+#if defined(SMOL_PLATFORM_WINDOWS) || defined(SMOL_PLATFORM_LINUX)
+#define SMOL_HAS_THREADS 1
+
+//smol_thread_create - Starts a new thread
+//Arguments:
+// - smol_thread_t* thread  -- A pointer to the thread handle
+// - smol_thread_proc proc  -- The procedure the thread runs
+// - void* user_data        -- User data passed to the procedure
+//Returns: int - SMOL_TRUE if successful, SMOL_FALSE otherwise
+int smol_thread_create(smol_thread_t* thread, smol_thread_proc proc, void* user_data);
+
+//smol_thread_join - Waits for thread to finish, and releases it
+void smol_thread_join(smol_thread_t thread);
+
+//smol_thread_yield - Gives rest of the time slice to other threads
+void smol_thread_yield(void);
+
+void smol_mutex_init(smol_mutex_t* mutex);
+void smol_mutex_destroy(smol_mutex_t* mutex);
+void smol_mutex_lock(smol_mutex_t* mutex);
+void smol_mutex_unlock(smol_mutex_t* mutex);
+
+void smol_cond_init(smol_cond_t* cond);
+void smol_cond_destroy(smol_cond_t* cond);
+void smol_cond_wait(smol_cond_t* cond, smol_mutex_t* mutex);
+void smol_cond_signal(smol_cond_t* cond);
+void smol_cond_broadcast(smol_cond_t* cond);
+#endif 
+
+//smol_get_num_cpus - Returns the number of logical processors 
+int smol_get_num_cpus(void);
+
+#ifndef SMOL_JOB_DEQUE_SIZE
+#define SMOL_JOB_DEQUE_SIZE 4096 //Must be power of two
+#endif 
+
+#ifndef SMOL_JOB_MAX_WORKERS
+#define SMOL_JOB_MAX_WORKERS 64
+#endif 
+
+typedef void(*smol_job_proc)(void* user_data);
+typedef void(*smol_parallel_for_proc)(int first, int last, void* user_data);
+
+//smol_job_counter_t - Counts the jobs not yet finished, works as a fence for dependencies.
+//Must be zero initialized: smol_job_counter_t counter = { 0 };
+typedef struct _smol_job_counter_t {
+	volatile smol_size_t value;
+} smol_job_counter_t;
+
+//smol_job_system_init - Starts the worker threads. The calling thread becomes the worker #0, 
+//                       and it's the only non worker thread that may submit jobs. 
+//Arguments:
+// - int num_threads -- Number of additional worker threads, if negative, the number of cpus - 1 is used.
+//Returns: int - SMOL_TRUE if successful, SMOL_FALSE otherwise
+int smol_job_system_init(int num_threads);
+
+//smol_job_system_shutdown - Stops and joins all the worker threads
+void smol_job_system_shutdown(void);
+
+//smol_job_system_num_workers - Returns the number of workers, including the thread that called init.
+int smol_job_system_num_workers(void);
+
+//smol_job_submit - Pushes a job into the current worker's queue, other workers may steal it. 
+//                  If called outside of the job system threads, or the queue is full, the job is run immediately.
+//Arguments:
+// - smol_job_proc proc           -- The job procedure
+// - void* user_data              -- User data passed to the procedure
+// - smol_job_counter_t* counter  -- Incremented now, decremented when the job is done (may be NULL)
+void smol_job_submit(smol_job_proc proc, void* user_data, smol_job_counter_t* counter);
+
+//smol_job_wait - Runs / steals other jobs until the counter reaches zero
+//Arguments:
+// - smol_job_counter_t* counter  -- The counter to be waited for
+void smol_job_wait(smol_job_counter_t* counter);
+
+//smol_parallel_for - Calls proc for sub ranges of [first...last), distributed over the workers, and waits for them to finish.
+//Arguments:
+// - int first                    -- The first index of the range
+// - int last                     -- One past the last index of the range
+// - int grain_size               -- The number of indices processed in one call (at most)
+// - smol_parallel_for_proc proc  -- The procedure called for each sub range
+// - void* user_data              -- User data passed to the procedure
+void smol_parallel_for(int first, int last, int grain_size, smol_parallel_for_proc proc, void* user_data);
 
 /* ------------------------------ */
 /* SOME FILE SYSTEM FUNCTIONALITY */
@@ -626,19 +1220,253 @@ const char* smol_get_current_directory(void);
 //Returns: int - If change was successful or not
 int smol_change_directory(const char* path);
 
-//smol_start_file_scan_session - Returns an exclusive random float berween [minimum...maximum)
+//smol_start_file_scan_session - Starts listing the current folder (not recursive, see smol_scan_directory for that)
 //Arguments:
 // - smol_file_info_t*  -- A pointer to smol_file_info_t structure, contains the first file found in the current folder
 //Returns: smol_file_scan_session_t - A handle to the file system scan session
 smol_file_scan_session_t smol_start_file_scan_session(smol_file_info_t* info);
 
-//smol_start_file_scan_session - Returns an exclusive random float berween [minimum...maximum)
+//smol_file_scan_session_next - Gets the next entry of the folder, the session is closed once this returns SMOL_FALSE
 //Arguments:
 // - smol_file_scan_session_t  -- A file scan session handle
 // - smol_file_info_t*         --  A pointer to smol_file_info_t structure, contains the next file found in the current folder
 //Returns: smol_file_scan_session_t - A handle to the file system scan session
 int smol_file_scan_session_next(smol_file_scan_session_t session, smol_file_info_t* info);
 
+/* ---------------------------------------- */
+/*  ASYNCHRONOUS (BULK) FILE LOADING        */
+/* ---------------------------------------- */
+
+//smol_file_request_t - Describes one read, file_path must stay valid until the request is completed.
+typedef struct _smol_file_request_t {
+	const char* file_path;
+	void* buffer;               //Optional destination buffer, if NULL the loader allocates one (free it with SMOL_FREE)
+	smol_size_t buffer_size;    //Size of the destination buffer
+	smol_size_t offset;         //Offset in the file where reading starts
+	smol_size_t size;           //Number of bytes to read, 0 reads until the end of the file
+	void* user_data;
+} smol_file_request_t;
+
+typedef struct _smol_file_completion_t {
+	const char* file_path;
+	void* buffer;               //The caller's buffer, or zero terminated buffer allocated by the loader 
+	smol_size_t size;           //Number of bytes read
+	void* user_data;
+	int error;                  //Zero on success, otherwise errno (Linux) or GetLastError() (Windows) code
+	int owns_buffer;            //SMOL_TRUE if the buffer was allocated by the loader
+} smol_file_completion_t;
+
+//smol_file_completion_proc - Called from a loader thread when a request completes
+typedef void(*smol_file_completion_proc)(const smol_file_completion_t* completion, void* user_data);
+
+typedef struct _smol_file_loader_t smol_file_loader_t;
+
+#ifndef SMOL_FILE_LOADER_MAX_THREADS
+#define SMOL_FILE_LOADER_MAX_THREADS 16
+#endif 
+
+//smol_file_loader_create - Creates an asynchronous file loader. On Linux io_uring is used when 
+//                          the kernel allows it (one I/O thread), otherwise a thread pool using pread.
+//Arguments:
+// - int num_threads                        -- Number of I/O threads for the thread pool backend (1 if <= 0)
+// - int queue_size                         -- Maximum number of queued requests and unpolled completions
+// - smol_file_completion_proc callback     -- If not NULL, called for each completion instead of queuing them for smol_file_loader_poll
+// - void* callback_user_data               -- User data passed to the callback
+//Returns: smol_file_loader_t* - the loader or NULL on failure
+smol_file_loader_t* smol_file_loader_create(int num_threads, int queue_size, smol_file_completion_proc callback, void* callback_user_data);
+
+//smol_file_loader_submit - Queues a batch of read requests (the requests are copied).
+//Returns: int - The number of requests queued, less than count if the queue was full
+int smol_file_loader_submit(smol_file_loader_t* loader, const smol_file_request_t* requests, int count);
+
+//smol_file_loader_poll - Pops a completion, when no callback was given to the loader. 
+//                        Without threads, the next queued request is read here.
+//Returns: int - SMOL_TRUE if a completion was retrieved, SMOL_FALSE if none were available
+int smol_file_loader_poll(smol_file_loader_t* loader, smol_file_completion_t* completion);
+
+//smol_file_loader_in_flight - Returns the number of requests that haven't been completed yet
+int smol_file_loader_in_flight(smol_file_loader_t* loader);
+
+//smol_file_loader_destroy - Finishes the pending requests, stops the threads and frees the loader. 
+//                           Buffers of unpolled completions allocated by the loader are freed too.
+void smol_file_loader_destroy(smol_file_loader_t* loader);
+
+/* ---------------------------------------- */
+/*  MEMORY MAPPED (READ ONLY) FILE VIEWS    */
+/* ---------------------------------------- */
+
+//Access pattern hints passed to smol_file_view_advise
+typedef enum {
+	SMOL_FILE_VIEW_HINT_NORMAL = 0,
+	SMOL_FILE_VIEW_HINT_SEQUENTIAL,  //Read ahead aggressively, pages can be dropped soon after reading
+	SMOL_FILE_VIEW_HINT_RANDOM,      //Don't bother reading ahead
+	SMOL_FILE_VIEW_HINT_WILLNEED,    //Start reading the range in now
+	SMOL_FILE_VIEW_HINT_DONTNEED     //The range won't be needed for a while, the pages can be dropped
+} smol_file_view_hint;
+
+typedef struct _smol_file_view_t {
+	const void* data;
+	smol_size_t size;
+	int is_copy; //SMOL_TRUE when the platform couldn't map the file, and it was read into memory instead
+} smol_file_view_t;
+
+//smol_map_file - Maps a whole file read only into memory. The pages are shared with other processes 
+//                mapping the same file, and they're loaded only when touched.
+//Arguments:
+// - const char* file_path     -- A path to a file
+// - smol_file_view_t* view    -- The view to be initialized
+//Returns: int - SMOL_TRUE if successful, SMOL_FALSE otherwise
+int smol_map_file(const char* file_path, smol_file_view_t* view);
+
+//smol_unmap_file - Unmaps a file mapped with smol_map_file
+void smol_unmap_file(smol_file_view_t* view);
+
+//smol_file_view_advise - Tells the OS how a range of the view is going to be accessed
+//Arguments:
+// - const smol_file_view_t* view  -- The view
+// - smol_size_t offset            -- Offset of the range in bytes
+// - smol_size_t size              -- Size of the range in bytes, 0 means until the end of the view
+// - smol_file_view_hint hint      -- The access hint
+void smol_file_view_advise(const smol_file_view_t* view, smol_size_t offset, smol_size_t size, smol_file_view_hint hint);
+
+//smol_file_view_prefetch - Starts reading a range of the view in the background, so touching it later won't page fault
+//Arguments:
+// - const smol_file_view_t* view  -- The view
+// - smol_size_t offset            -- Offset of the range in bytes
+// - smol_size_t size              -- Size of the range in bytes, 0 means until the end of the view
+void smol_file_view_prefetch(const smol_file_view_t* view, smol_size_t offset, smol_size_t size);
+
+/* ---------------------------------------- */
+/*  RECURSIVE (PARALLEL) DIRECTORY SCANNING */
+/* ---------------------------------------- */
+
+typedef enum {
+	SMOL_DIR_SCAN_RECURSIVE        = 0x00000001U, //Descend into sub folders
+	SMOL_DIR_SCAN_STATS            = 0x00000002U, //Fill in sizes and modification times (may need a stat per file)
+	SMOL_DIR_SCAN_INCLUDE_FOLDERS  = 0x00000004U, //Report folders too, not just files
+	SMOL_DIR_SCAN_DEFAULT          = (SMOL_DIR_SCAN_RECURSIVE | SMOL_DIR_SCAN_STATS)
+} smol_dir_scan_flags;
+
+typedef struct _smol_dir_entry_t {
+	const char* path;           //Path relative to the scanned root, with '/' separators. Valid only during the callback.
+	smol_size_t size;           //File size in bytes (SMOL_DIR_SCAN_STATS)
+	long long mtime_ns;         //Modification time in nanoseconds since unix epoch (SMOL_DIR_SCAN_STATS)
+	int is_folder;
+} smol_dir_entry_t;
+
+#ifndef SMOL_DIR_SCAN_BATCH_SIZE
+#define SMOL_DIR_SCAN_BATCH_SIZE 256
+#endif 
+
+//smol_dir_scan_proc - Receives a batch of entries. The calls are serialized, but they may come from different threads.
+typedef void(*smol_dir_scan_proc)(const smol_dir_entry_t* entries, int count, void* user_data);
+
+//smol_scan_directory - Scans a directory tree, and reports the entries in batches. If the job system is running 
+//                      (smol_job_system_init) and this is called from one of it's threads, the sub folders
+//                      are scanned in parallel by the workers. Symbolic links to folders aren't followed.
+//Arguments:
+// - const char* root_path          -- The folder to be scanned
+// - int flags                      -- smol_dir_scan_flags
+// - smol_dir_scan_proc callback    -- Called for each batch of entries
+// - void* user_data                -- User data passed to the callback
+//Returns: int - SMOL_TRUE if the root folder could be opened, SMOL_FALSE otherwise
+int smol_scan_directory(const char* root_path, int flags, smol_dir_scan_proc callback, void* user_data);
+
+/* ---------------------------------------- */
+/*  HASHING                                 */
+/* ---------------------------------------- */
+
+//smol_hash64 - Computes a 64bit non-cryptographic hash (XXH64) of a buffer
+//Arguments:
+// - const void* data          -- The data to be hashed
+// - smol_size_t size          -- Size of the data in bytes
+// - unsigned long long seed   -- Seed, different seeds give unrelated hashes
+//Returns: unsigned long long - The hash
+unsigned long long smol_hash64(const void* data, smol_size_t size, unsigned long long seed);
+
+/* ---------------------------------------- */
+/*  ASSET MANIFEST CACHE                    */
+/* ---------------------------------------- */
+
+//The manifest file is native endian, and laid out so that it can be used straight from a memory mapping:
+//header, entries sorted by the path hash, and the NUL terminated paths.
+#define SMOL_MANIFEST_VERSION 1
+
+typedef struct _smol_manifest_entry_t {
+	unsigned long long path_hash;     //smol_hash64 of the path
+	unsigned long long size;          //File size in bytes
+	long long mtime_ns;               //Modification time in nanoseconds since unix epoch
+	unsigned long long content_hash;  //smol_hash64 of the file contents
+	unsigned int path_offset;         //Offset of the path into the path strings
+	unsigned int path_length;         //Length of the path, without the terminator
+} smol_manifest_entry_t;
+
+typedef struct _smol_manifest_t {
+	smol_file_view_t view;
+	const smol_manifest_entry_t* entries;
+	const char* paths;
+	int count;
+} smol_manifest_t;
+
+typedef enum {
+	SMOL_MANIFEST_ADDED = 0,
+	SMOL_MANIFEST_CHANGED,
+	SMOL_MANIFEST_REMOVED
+} smol_manifest_change;
+
+//smol_manifest_change_proc - Reports a file whose content differs from the previous manifest. 
+//                            For SMOL_MANIFEST_REMOVED the entry is the old one.
+typedef void(*smol_manifest_change_proc)(const char* path, const smol_manifest_entry_t* entry, smol_manifest_change change, void* user_data);
+
+//smol_manifest_load - Maps a manifest file written by smol_manifest_update
+//Arguments:
+// - smol_manifest_t* manifest    -- The manifest to be loaded into, it's left empty on failure
+// - const char* manifest_path    -- Path of the manifest file
+//Returns: int - SMOL_TRUE if the manifest was found and valid, SMOL_FALSE otherwise
+int smol_manifest_load(smol_manifest_t* manifest, const char* manifest_path);
+
+//smol_manifest_free - Unmaps a manifest
+//Arguments:
+// - smol_manifest_t* manifest    -- The manifest to be freed
+void smol_manifest_free(smol_manifest_t* manifest);
+
+//smol_manifest_find - Looks up an entry by it's path
+//Arguments:
+// - const smol_manifest_t* manifest  -- The manifest
+// - const char* path                 -- Path relative to the scanned root, with '/' separators
+//Returns: const smol_manifest_entry_t* - The entry, or NULL if the path isn't in the manifest
+const smol_manifest_entry_t* smol_manifest_find(const smol_manifest_t* manifest, const char* path);
+
+//smol_manifest_entry_path - Gets the path of an entry
+//Arguments:
+// - const smol_manifest_t* manifest      -- The manifest
+// - const smol_manifest_entry_t* entry   -- An entry of the manifest
+//Returns: const char* - The path, valid as long as the manifest is loaded
+const char* smol_manifest_entry_path(const smol_manifest_t* manifest, const smol_manifest_entry_t* entry);
+
+//smol_manifest_update - Rescans a folder tree and rewrites the manifest. Only the files whose size or modification 
+//                       time changed are re-hashed, and only the ones whose contents changed get reported.
+//                       The hashing is spread over the job system, if it's running. Keep the manifest file 
+//                       itself out of root_path.
+//Arguments:
+// - smol_manifest_t* manifest            -- The previous manifest (may be empty), reloaded from the new file on success
+// - const char* manifest_path            -- Path of the manifest file
+// - const char* root_path                -- The folder to be scanned
+// - smol_manifest_change_proc callback   -- Called for each added, changed or removed file, may be NULL
+// - void* user_data                      -- User data passed to the callback
+//Returns: int - Number of changes reported, or -1 on failure
+int smol_manifest_update(smol_manifest_t* manifest, const char* manifest_path, const char* root_path, smol_manifest_change_proc callback, void* user_data);
+
+//smol_asset_cache_path - Formats a path for a derived (e.g. decoded) asset, named after the source contents
+//Arguments:
+// - char* buffer                     -- Buffer for the path
+// - int buffer_size                  -- Size of the buffer
+// - const char* cache_folder         -- Folder of the cached assets
+// - unsigned long long content_hash  -- Content hash of the source asset
+// - const char* extension            -- Extension including the dot, e.g. ".rgba", may be NULL
+//Returns: int - SMOL_TRUE if the path fit into the buffer
+int smol_asset_cache_path(char* buffer, int buffer_size, const char* cache_folder, unsigned long long content_hash, const char* extension);
+
 
 #ifdef SMOL_UTILS_IMPLEMENTATION
 
@@ -673,6 +1501,15 @@ int smol_file_scan_session_next(smol_file_scan_session_t session, smol_file_info
 #endif
 
 
+//The vector paths (bulk utf conversion, random number fills) use SSE2 or NEON when they're available.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	include <emmintrin.h>
+#	define SMOL__HAS_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#	include <arm_neon.h>
+#	define SMOL__HAS_NEON
+#endif 
+
 #pragma region Unicode stuff 
 
 //https://en.wikipedia.org/wiki/UTF-8#Encoding
@@ -777,7 +1614,7 @@ int smol_utf16_to_utf32(const unsigned short* utf16, unsigned int* utf32) {
 int smol_utf32_to_utf16(unsigned int utf32, int buf_len, unsigned short* utf16) {
 
 
-	if(utf32 > 0x10000) {
+	if(utf32 >= 0x10000) {
 		
 		if(2 > buf_len) return 0;
 
@@ -807,221 +1644,3859 @@ int smol_utf16_to_utf8(const unsigned short* utf16, int buf_len, char* utf8) {
 int smol_utf8_to_utf16(const char* utf8, int buf_len, unsigned short* utf16) {
 
 	unsigned int utf32 = 0;
-	if(smol_utf8_to_utf32(utf8, &utf32))
+	if(smol_utf8_to_utf32(utf8, &utf32) == 0)
 		return 0;
 
 	return smol_utf32_to_utf16(utf32, buf_len, utf16);
 
 }
 
-#pragma endregion
-
-#pragma region Sorting utilities
+//ASCII runs are checked and copied in blocks, so the block is still in the cache for the copy.
+#define SMOL__UTF_ASCII_BLOCK 4096
 
+SMOL_INLINE smol_size_t smol__min_size(smol_size_t a, smol_size_t b) {
+	return a < b ? a : b;
+}
 
-void smol_sort(void* data, int num_elements, int element_size, smol_sort_proc compare, void* user_data) {
+//Length of the leading run of ASCII bytes.
+static smol_size_t smol__utf8_ascii_prefix(const unsigned char* src, smol_size_t length) {
 
-	char* first = ((char*)data);
-	char* last =  first + (num_elements * element_size);
+	smol_size_t i = 0;
 
-#ifdef _MSC_VER
-#define SMOL_SORT_SWAP(a, b) { \
-	char* tmp = alloca(element_size); \
-	memcpy((void*)tmp, (const void*)a, element_size); \
-	memcpy((void*)a, (const void*)b, element_size); \
-	memcpy((void*)b, (const void*)tmp, element_size); \
-}
-#else 
-#define SMOL_SORT_SWAP(a, b) { \
-	char tmp[element_size]; \
-	memcpy(tmp, a, element_size); \
-	memcpy(a, b, element_size); \
-	memcpy(b, tmp, element_size); \
-}
+#if defined(SMOL__HAS_SSE2)
+	for(; i + 16 <= length; i += 16) {
+		if(_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(src + i)))) 
+			break;
+	}
+#elif defined(SMOL__HAS_NEON)
+	for(; i + 16 <= length; i += 16) {
+		if(vmaxvq_u8(vld1q_u8(src + i)) >= 0x80) 
+			break;
+	}
 #endif 
 
-	if((last - first) > element_size) {
-		char* part_idx = first;
-		{
-			char* pivot = last - element_size;
-			for(char* it = first; it != last; it += element_size) {
-				if(compare((const void*)pivot, (const void*)it, user_data) > 0) {
-					SMOL_SORT_SWAP(part_idx, it);
-					part_idx += element_size;
-				}
-			}
-			SMOL_SORT_SWAP(part_idx, pivot);
-		}
-		smol_sort((void*)first, (part_idx - first) / element_size, element_size, compare, user_data);
-		smol_sort((void*)(part_idx + element_size), (last - (part_idx + element_size)) / element_size, element_size, compare, user_data);
+	for(; i + 8 <= length; i += 8) {
+		unsigned long long word;
+		memcpy(&word, src + i, 8);
+		if(word & 0x8080808080808080ULL) 
+			break;
 	}
-#undef SMOL_SORT_SWAP
-}
-
-#pragma endregion
 
+	while(i < length && src[i] < 0x80) 
+		i++;
 
-#pragma region Linear Congruential PRNG
-static unsigned int smol__rand_state;
+	return i;
 
-void smol_randomize(unsigned int seed) {
-	smol__rand_state = seed;
 }
 
-//Le zoinked from here https://www.sanfoundry.com/c-program-implement-linear-congruential-generator-pseudo-random-number-generation/
-unsigned int smol_rand() {
-	return (smol__rand_state = (smol__rand_state * 1103515245 + 12345) & SMOL_RAND_MAX);
-}
+static smol_size_t smol__utf16_ascii_prefix(const unsigned short* src, smol_size_t length) {
 
-float smol_randf() {
-	unsigned int bits = 0x3F800000 | (smol_rand() >> 8);
-	return (*((float*)&bits)) - 1.f;
-}
+	smol_size_t i = 0;
 
-int smol_rnd(int minimum, int maximum) {
-	return minimum + smol_rand() % (maximum - minimum);
-}
+#if defined(SMOL__HAS_SSE2)
+	const __m128i high_bits = _mm_set1_epi16((short)0xFF80);
+	for(; i + 8 <= length; i += 8) {
+		__m128i high = _mm_and_si128(_mm_loadu_si128((const __m128i*)(src + i)), high_bits);
+		if(_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xFFFF) 
+			break;
+	}
+#elif defined(SMOL__HAS_NEON)
+	for(; i + 8 <= length; i += 8) {
+		if(vmaxvq_u16(vld1q_u16(src + i)) >= 0x80) 
+			break;
+	}
+#endif 
 
-float smol_rndf(float minimum, float maximum) {
-	return minimum + smol_randf() * (maximum - minimum);
-}
+	while(i < length && src[i] < 0x80) 
+		i++;
 
-#pragma endregion
+	return i;
 
-#if defined(SMOL_PLATFORM_WINDOWS)
+}
 
-//A nasty global :|
-double smol__perf_freq;
+static smol_size_t smol__utf32_ascii_prefix(const unsigned int* src, smol_size_t length) {
 
-double smol_timer(void) {
+	smol_size_t i = 0;
 
-	if(smol__perf_freq == 0.0) {
-		LARGE_INTEGER freq;
-		if(QueryPerformanceFrequency(&freq) == TRUE) {
-			smol__perf_freq = 1.0 / (double)freq.QuadPart;
-		} else {
-			SMOL_ASSERT(!"Failed to query perfomance frequency!");
-			return 0.;
-		}
+#if defined(SMOL__HAS_SSE2)
+	const __m128i high_bits = _mm_set1_epi32((int)0xFFFFFF80);
+	for(; i + 4 <= length; i += 4) {
+		__m128i high = _mm_and_si128(_mm_loadu_si128((const __m128i*)(src + i)), high_bits);
+		if(_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) != 0xFFFF) 
+			break;
+	}
+#elif defined(SMOL__HAS_NEON)
+	for(; i + 4 <= length; i += 4) {
+		if(vmaxvq_u32(vld1q_u32(src + i)) >= 0x80) 
+			break;
 	}
+#endif 
 
-	LARGE_INTEGER ctr = {0};
-	SMOL_ASSERT("Failed to query performance counter!" && QueryPerformanceCounter(&ctr));
+	while(i < length && src[i] < 0x80) 
+		i++;
 
-	return (double)ctr.QuadPart * smol__perf_freq;
+	return i;
 
 }
 
-const char* smol_get_current_directory(void) {
-	
-	static char buffer[512] = { 0 };
-	
-#ifdef UNICODE 
-	{
-		wchar_t buf[512];
-		GetCurrentDirectory(512, buf);
-		BOOL subst = FALSE;
-		WideCharToMultiByte(CP_UTF8, 0, buf, lstrlenW(buf), buffer, 1024, "?", &subst);
+static void smol__ascii_widen_u16(const unsigned char* src, unsigned short* dst, smol_size_t count) {
+
+	smol_size_t i = 0;
+
+#if defined(SMOL__HAS_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	for(; i + 16 <= count; i += 16) {
+		__m128i bytes = _mm_loadu_si128((const __m128i*)(src + i));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi8(bytes, zero));
+		_mm_storeu_si128((__m128i*)(dst + i + 8), _mm_unpackhi_epi8(bytes, zero));
+	}
+#elif defined(SMOL__HAS_NEON)
+	for(; i + 16 <= count; i += 16) {
+		uint8x16_t bytes = vld1q_u8(src + i);
+		vst1q_u16(dst + i, vmovl_u8(vget_low_u8(bytes)));
+		vst1q_u16(dst + i + 8, vmovl_u8(vget_high_u8(bytes)));
 	}
-#else 
-	GetCurrentDirectory(512, buffer);
 #endif 
-	
-	return buffer;
+
+	for(; i < count; i++) 
+		dst[i] = src[i];
+
+}
+
+static void smol__ascii_widen_u32(const unsigned char* src, unsigned int* dst, smol_size_t count) {
+
+	smol_size_t i = 0;
+
+#if defined(SMOL__HAS_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	for(; i + 16 <= count; i += 16) {
+		__m128i bytes = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i low = _mm_unpacklo_epi8(bytes, zero);
+		__m128i high = _mm_unpackhi_epi8(bytes, zero);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi16(low, zero));
+		_mm_storeu_si128((__m128i*)(dst + i + 4), _mm_unpackhi_epi16(low, zero));
+		_mm_storeu_si128((__m128i*)(dst + i + 8), _mm_unpacklo_epi16(high, zero));
+		_mm_storeu_si128((__m128i*)(dst + i + 12), _mm_unpackhi_epi16(high, zero));
+	}
+#elif defined(SMOL__HAS_NEON)
+	for(; i + 16 <= count; i += 16) {
+		uint8x16_t bytes = vld1q_u8(src + i);
+		uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+		uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+		vst1q_u32(dst + i, vmovl_u16(vget_low_u16(low)));
+		vst1q_u32(dst + i + 4, vmovl_u16(vget_high_u16(low)));
+		vst1q_u32(dst + i + 8, vmovl_u16(vget_low_u16(high)));
+		vst1q_u32(dst + i + 12, vmovl_u16(vget_high_u16(high)));
+	}
+#endif 
+
+	for(; i < count; i++) 
+		dst[i] = src[i];
+
+}
+
+//The source is known to be ASCII here, so packing with saturation is exact.
+static void smol__ascii_narrow_u16(const unsigned short* src, unsigned char* dst, smol_size_t count) {
+
+	smol_size_t i = 0;
+
+#if defined(SMOL__HAS_SSE2)
+	for(; i + 16 <= count; i += 16) {
+		__m128i low = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i high = _mm_loadu_si128((const __m128i*)(src + i + 8));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(low, high));
+	}
+#elif defined(SMOL__HAS_NEON)
+	for(; i + 16 <= count; i += 16) 
+		vst1q_u8(dst + i, vcombine_u8(vmovn_u16(vld1q_u16(src + i)), vmovn_u16(vld1q_u16(src + i + 8))));
+#endif 
+
+	for(; i < count; i++) 
+		dst[i] = (unsigned char)src[i];
+
+}
+
+static void smol__ascii_narrow_u32(const unsigned int* src, unsigned char* dst, smol_size_t count) {
+
+	smol_size_t i = 0;
+
+#if defined(SMOL__HAS_SSE2)
+	for(; i + 16 <= count; i += 16) {
+		__m128i a = _mm_packs_epi32(_mm_loadu_si128((const __m128i*)(src + i)), _mm_loadu_si128((const __m128i*)(src + i + 4)));
+		__m128i b = _mm_packs_epi32(_mm_loadu_si128((const __m128i*)(src + i + 8)), _mm_loadu_si128((const __m128i*)(src + i + 12)));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(a, b));
+	}
+#elif defined(SMOL__HAS_NEON)
+	for(; i + 16 <= count; i += 16) {
+		uint16x8_t a = vcombine_u16(vmovn_u32(vld1q_u32(src + i)), vmovn_u32(vld1q_u32(src + i + 4)));
+		uint16x8_t b = vcombine_u16(vmovn_u32(vld1q_u32(src + i + 8)), vmovn_u32(vld1q_u32(src + i + 12)));
+		vst1q_u8(dst + i, vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+	}
+#endif 
+
+	for(; i < count; i++) 
+		dst[i] = (unsigned char)src[i];
+
+}
+
+//Decodes one strictly valid utf8 sequence. 
+//Returns: the length of the sequence, 0 if it's invalid, or -1 if the input ends before the sequence does.
+static int smol__utf8_decode(const unsigned char* src, smol_size_t length, unsigned int* codepoint) {
+
+	unsigned int value = src[0];
+	unsigned int minimum;
+	int size;
+
+	if(value < 0x80) {
+		*codepoint = value;
+		return 1;
+	}
+	else if(value >= 0xC2 && value <= 0xDF) { size = 2; value &= 0x1F; minimum = 0x80; }
+	else if((value & 0xF0) == 0xE0) { size = 3; value &= 0x0F; minimum = 0x800; }
+	else if(value >= 0xF0 && value <= 0xF4) { size = 4; value &= 0x07; minimum = 0x10000; }
+	else return 0;
+
+	for(int i = 1; i < size; i++) {
+		if((smol_size_t)i >= length) 
+			return -1;
+		if((src[i] & 0xC0) != 0x80) 
+			return 0;
+		value = (value << 6) | (src[i] & 0x3F);
+	}
+
+	if(value < minimum || value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF)) 
+		return 0;
+
+	*codepoint = value;
+
+	return size;
+
+}
+
+SMOL_INLINE int smol__utf8_encoded_length(unsigned int codepoint) {
+	return codepoint < 0x80 ? 1 : codepoint < 0x800 ? 2 : codepoint < 0x10000 ? 3 : 4;
+}
+
+static void smol__utf8_encode(unsigned int codepoint, int size, unsigned char* dst) {
+	switch(size) {
+		case 1: 
+			dst[0] = (unsigned char)codepoint; 
+		break;
+		case 2: 
+			dst[0] = (unsigned char)(0xC0 | (codepoint >> 6)); 
+			dst[1] = (unsigned char)(0x80 | (codepoint & 0x3F)); 
+		break;
+		case 3: 
+			dst[0] = (unsigned char)(0xE0 | (codepoint >> 12)); 
+			dst[1] = (unsigned char)(0x80 | ((codepoint >> 6) & 0x3F)); 
+			dst[2] = (unsigned char)(0x80 | (codepoint & 0x3F)); 
+		break;
+		case 4: 
+			dst[0] = (unsigned char)(0xF0 | (codepoint >> 18)); 
+			dst[1] = (unsigned char)(0x80 | ((codepoint >> 12) & 0x3F)); 
+			dst[2] = (unsigned char)(0x80 | ((codepoint >> 6) & 0x3F)); 
+			dst[3] = (unsigned char)(0x80 | (codepoint & 0x3F)); 
+		break;
+	}
+}
+
+//Decodes one utf16 codepoint, returns the number of code units, 0 if invalid, or -1 if a pair is cut off.
+static int smol__utf16_decode(const unsigned short* src, smol_size_t length, unsigned int* codepoint) {
+
+	unsigned int value = src[0];
+
+	if((value & 0xF800) != 0xD800) {
+		*codepoint = value;
+		return 1;
+	}
+
+	if(value >= 0xDC00) 
+		return 0;
+	if(length < 2) 
+		return -1;
+	if((src[1] & 0xFC00) != 0xDC00) 
+		return 0;
+
+	*codepoint = 0x10000 + ((value - 0xD800) << 10) + (src[1] - 0xDC00);
+
+	return 2;
+
+}
+
+SMOL_INLINE int smol__utf32_valid(unsigned int codepoint) {
+	return codepoint <= 0x10FFFF && (codepoint & 0xFFFFF800) != 0xD800;
+}
+
+int smol_utf8_validate(const char* utf8, smol_size_t length, smol_size_t* error_offset) {
+
+	const unsigned char* src = (const unsigned char*)utf8;
+	smol_size_t i = 0;
+	unsigned int codepoint;
+
+	while(i < length) {
+
+		if(src[i] < 0x80) {
+			i += smol__utf8_ascii_prefix(src + i, length - i);
+			continue;
+		}
+
+		int size = smol__utf8_decode(src + i, length - i, &codepoint);
+		if(size <= 0) {
+			if(error_offset) *error_offset = i;
+			return SMOL_FALSE;
+		}
+
+		i += size;
+
+	}
+
+	return SMOL_TRUE;
+
+}
+
+int smol_utf16_validate(const unsigned short* utf16, smol_size_t length, smol_size_t* error_offset) {
+
+	smol_size_t i = 0;
+	unsigned int codepoint;
+
+	while(i < length) {
+
+		int size = smol__utf16_decode(utf16 + i, length - i, &codepoint);
+		if(size <= 0) {
+			if(error_offset) *error_offset = i;
+			return SMOL_FALSE;
+		}
+
+		i += size;
+
+	}
+
+	return SMOL_TRUE;
+
+}
+
+//Counts the bytes that start a codepoint (everything but 10xxxxxx), and optionally the 4 byte leads (11110xxx).
+static smol_size_t smol__utf8_count(const unsigned char* src, smol_size_t length, int count_4byte) {
+
+	smol_size_t i = 0;
+	smol_size_t count = 0;
+
+#if defined(SMOL__HAS_SSE2)
+	const __m128i continuation = _mm_set1_epi8(-65);   //0xBF as signed, continuation bytes are 0x80...0xBF
+	const __m128i lead_4byte = _mm_set1_epi8(-17);     //0xEF as signed, 4 byte leads are 0xF0...0xFF
+	const __m128i zero = _mm_setzero_si128();
+	for(; i + 16 <= length; i += 16) {
+		__m128i bytes = _mm_loadu_si128((const __m128i*)(src + i));
+		unsigned int starts = (unsigned int)_mm_movemask_epi8(_mm_cmpgt_epi8(bytes, continuation));
+		unsigned int leads = count_4byte ? (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(bytes, lead_4byte), _mm_cmplt_epi8(bytes, zero))) : 0;
+		//Popcount of the two 16 bit masks
+		starts = starts - ((starts >> 1) & 0x5555); starts = (starts & 0x3333) + ((starts >> 2) & 0x3333);
+		starts = (starts + (starts >> 4)) & 0x0F0F; starts = (starts + (starts >> 8)) & 0x1F;
+		leads = leads - ((leads >> 1) & 0x5555); leads = (leads & 0x3333) + ((leads >> 2) & 0x3333);
+		leads = (leads + (leads >> 4)) & 0x0F0F; leads = (leads + (leads >> 8)) & 0x1F;
+		count += starts + leads;
+	}
+#elif defined(SMOL__HAS_NEON)
+	const int8x16_t continuation = vdupq_n_s8(-65);
+	const uint8x16_t lead_4byte = vdupq_n_u8(0xF0);
+	for(; i + 16 <= length; i += 16) {
+		uint8x16_t bytes = vld1q_u8(src + i);
+		uint8x16_t starts = vshrq_n_u8(vcgtq_s8(vreinterpretq_s8_u8(bytes), continuation), 7);
+		uint8x16_t leads = vshrq_n_u8(vcgeq_u8(bytes, lead_4byte), 7);
+		count += vaddvq_u8(starts);
+		if(count_4byte) count += vaddvq_u8(leads);
+	}
+#endif 
+
+	for(; i < length; i++) {
+		count += (src[i] & 0xC0) != 0x80;
+		if(count_4byte) count += src[i] >= 0xF0;
+	}
+
+	return count;
+
+}
+
+smol_size_t smol_utf8_utf16_length(const char* utf8, smol_size_t length) {
+	return smol__utf8_count((const unsigned char*)utf8, length, SMOL_TRUE);
+}
+
+smol_size_t smol_utf8_utf32_length(const char* utf8, smol_size_t length) {
+	return smol__utf8_count((const unsigned char*)utf8, length, SMOL_FALSE);
+}
+
+smol_size_t smol_utf16_utf8_length(const unsigned short* utf16, smol_size_t length) {
+
+	smol_size_t count = 0;
+
+	for(smol_size_t i = 0; i < length; ) {
+
+		smol_size_t run = smol__utf16_ascii_prefix(utf16 + i, length - i);
+		count += run;
+		i += run;
+
+		for(; i < length && utf16[i] >= 0x80; i++) {
+			unsigned int value = utf16[i];
+			//Both halves of a surrogate pair count 2, 4 in total.
+			count += value < 0x800 ? 2 : (value & 0xF800) == 0xD800 ? 2 : 3;
+		}
+
+	}
+
+	return count;
+
+}
+
+smol_size_t smol_utf16_utf32_length(const unsigned short* utf16, smol_size_t length) {
+
+	smol_size_t count = length;
+
+	for(smol_size_t i = 0; i < length; i++) 
+		count -= (utf16[i] & 0xFC00) == 0xDC00;
+
+	return count;
+
+}
+
+smol_size_t smol_utf32_utf8_length(const unsigned int* utf32, smol_size_t length) {
+
+	smol_size_t count = 0;
+
+	for(smol_size_t i = 0; i < length; ) {
+
+		smol_size_t run = smol__utf32_ascii_prefix(utf32 + i, length - i);
+		count += run;
+		i += run;
+
+		for(; i < length && utf32[i] >= 0x80; i++) 
+			count += smol__utf8_encoded_length(utf32[i]);
+
+	}
+
+	return count;
+
+}
+
+smol_size_t smol_utf32_utf16_length(const unsigned int* utf32, smol_size_t length) {
+
+	smol_size_t count = length;
+
+	for(smol_size_t i = 0; i < length; i++) 
+		count += utf32[i] >= 0x10000;
+
+	return count;
+
+}
+
+smol_utf_result_t smol_utf8_to_utf16_buffer(const char* utf8, smol_size_t length, unsigned short* utf16, smol_size_t capacity) {
+
+	const unsigned char* src = (const unsigned char*)utf8;
+	smol_utf_result_t result = { SMOL_UTF_OK, 0, 0 };
+	smol_size_t i = 0, o = 0;
+	unsigned int codepoint;
+
+	while(i < length) {
+
+		if(o == capacity) {
+			result.status = SMOL_UTF_OUTPUT_FULL;
+			break;
+		}
+
+		if(src[i] < 0x80) {
+			smol_size_t run = smol__utf8_ascii_prefix(src + i, smol__min_size(smol__min_size(length - i, capacity - o), SMOL__UTF_ASCII_BLOCK));
+			smol__ascii_widen_u16(src + i, utf16 + o, run);
+			i += run;
+			o += run;
+			continue;
+		}
+
+		int size = smol__utf8_decode(src + i, length - i, &codepoint);
+		if(size <= 0) {
+			result.status = size ? SMOL_UTF_TRUNCATED : SMOL_UTF_INVALID;
+			break;
+		}
+
+		if(codepoint >= 0x10000) {
+			if(capacity - o < 2) {
+				result.status = SMOL_UTF_OUTPUT_FULL;
+				break;
+			}
+			codepoint -= 0x10000;
+			utf16[o++] = (unsigned short)(0xD800 + (codepoint >> 10));
+			utf16[o++] = (unsigned short)(0xDC00 + (codepoint & 0x3FF));
+		} else {
+			utf16[o++] = (unsigned short)codepoint;
+		}
+
+		i += size;
+
+	}
+
+	result.read = i;
+	result.written = o;
+
+	return result;
+
+}
+
+smol_utf_result_t smol_utf8_to_utf32_buffer(const char* utf8, smol_size_t length, unsigned int* utf32, smol_size_t capacity) {
+
+	const unsigned char* src = (const unsigned char*)utf8;
+	smol_utf_result_t result = { SMOL_UTF_OK, 0, 0 };
+	smol_size_t i = 0, o = 0;
+
+	while(i < length) {
+
+		if(o == capacity) {
+			result.status = SMOL_UTF_OUTPUT_FULL;
+			break;
+		}
+
+		if(src[i] < 0x80) {
+			smol_size_t run = smol__utf8_ascii_prefix(src + i, smol__min_size(smol__min_size(length - i, capacity - o), SMOL__UTF_ASCII_BLOCK));
+			smol__ascii_widen_u32(src + i, utf32 + o, run);
+			i += run;
+			o += run;
+			continue;
+		}
+
+		int size = smol__utf8_decode(src + i, length - i, &utf32[o]);
+		if(size <= 0) {
+			result.status = size ? SMOL_UTF_TRUNCATED : SMOL_UTF_INVALID;
+			break;
+		}
+
+		o++;
+		i += size;
+
+	}
+
+	result.read = i;
+	result.written = o;
+
+	return result;
+
+}
+
+smol_utf_result_t smol_utf16_to_utf8_buffer(const unsigned short* utf16, smol_size_t length, char* utf8, smol_size_t capacity) {
+
+	unsigned char* dst = (unsigned char*)utf8;
+	smol_utf_result_t result = { SMOL_UTF_OK, 0, 0 };
+	smol_size_t i = 0, o = 0;
+	unsigned int codepoint;
+
+	while(i < length) {
+
+		if(o == capacity) {
+			result.status = SMOL_UTF_OUTPUT_FULL;
+			break;
+		}
+
+		if(utf16[i] < 0x80) {
+			smol_size_t run = smol__utf16_ascii_prefix(utf16 + i, smol__min_size(smol__min_size(length - i, capacity - o), SMOL__UTF_ASCII_BLOCK));
+			smol__ascii_narrow_u16(utf16 + i, dst + o, run);
+			i += run;
+			o += run;
+			continue;
+		}
+
+		int size = smol__utf16_decode(utf16 + i, length - i, &codepoint);
+		if(size <= 0) {
+			result.status = size ? SMOL_UTF_TRUNCATED : SMOL_UTF_INVALID;
+			break;
+		}
+
+		int encoded_size = smol__utf8_encoded_length(codepoint);
+		if(capacity - o < (smol_size_t)encoded_size) {
+			result.status = SMOL_UTF_OUTPUT_FULL;
+			break;
+		}
+
+		smol__utf8_encode(codepoint, encoded_size, dst + o);
+		o += encoded_size;
+		i += size;
+
+	}
+
+	result.read = i;
+	result.written = o;
+
+	return result;
+
+}
+
+smol_utf_result_t smol_utf16_to_utf32_buffer(const unsigned short* utf16, smol_size_t length, unsigned int* utf32, smol_size_t capacity) {
+
+	smol_utf_result_t result = { SMOL_UTF_OK, 0, 0 };
+	smol_size_t i = 0, o = 0;
+
+	while(i < length) {
+
+		if(o == capacity) {
+			result.status = SMOL_UTF_OUTPUT_FULL;
+			break;
+		}
+
+		int size = smol__utf16_decode(utf16 + i, length - i, &utf32[o]);
+		if(size <= 0) {
+			result.status = size ? SMOL_UTF_TRUNCATED : SMOL_UTF_INVALID;
+			break;
+		}
+
+		o++;
+		i += size;
+
+	}
+
+	result.read = i;
+	result.written = o;
+
+	return result;
+
+}
+
+smol_utf_result_t smol_utf32_to_utf8_buffer(const unsigned int* utf32, smol_size_t length, char* utf8, smol_size_t capacity) {
+
+	unsigned char* dst = (unsigned char*)utf8;
+	smol_utf_result_t result = { SMOL_UTF_OK, 0, 0 };
+	smol_size_t i = 0, o = 0;
+
+	while(i < length) {
+
+		if(o == capacity) {
+			result.status = SMOL_UTF_OUTPUT_FULL;
+			break;
+		}
+
+		if(utf32[i] < 0x80) {
+			smol_size_t run = smol__utf32_ascii_prefix(utf32 + i, smol__min_size(smol__min_size(length - i, capacity - o), SMOL__UTF_ASCII_BLOCK));
+			smol__ascii_narrow_u32(utf32 + i, dst + o, run);
+			i += run;
+			o += run;
+			continue;
+		}
+
+		if(!smol__utf32_valid(utf32[i])) {
+			result.status = SMOL_UTF_INVALID;
+			break;
+		}
+
+		int encoded_size = smol__utf8_encoded_length(utf32[i]);
+		if(capacity - o < (smol_size_t)encoded_size) {
+			result.status = SMOL_UTF_OUTPUT_FULL;
+			break;
+		}
+
+		smol__utf8_encode(utf32[i], encoded_size, dst + o);
+		o += encoded_size;
+		i++;
+
+	}
+
+	result.read = i;
+	result.written = o;
+
+	return result;
+
+}
+
+smol_utf_result_t smol_utf32_to_utf16_buffer(const unsigned int* utf32, smol_size_t length, unsigned short* utf16, smol_size_t capacity) {
+
+	smol_utf_result_t result = { SMOL_UTF_OK, 0, 0 };
+	smol_size_t i = 0, o = 0;
+
+	for(; i < length; i++) {
+
+		unsigned int codepoint = utf32[i];
+
+		if(!smol__utf32_valid(codepoint)) {
+			result.status = SMOL_UTF_INVALID;
+			break;
+		}
+
+		if(capacity - o < (codepoint >= 0x10000 ? 2u : 1u)) {
+			result.status = SMOL_UTF_OUTPUT_FULL;
+			break;
+		}
+
+		if(codepoint >= 0x10000) {
+			codepoint -= 0x10000;
+			utf16[o++] = (unsigned short)(0xD800 + (codepoint >> 10));
+			utf16[o++] = (unsigned short)(0xDC00 + (codepoint & 0x3FF));
+		} else {
+			utf16[o++] = (unsigned short)codepoint;
+		}
+
+	}
+
+	result.read = i;
+	result.written = o;
+
+	return result;
+
+}
+
+//Shared by the utf8 streams, the output is either utf16 or utf32.
+static smol_utf_result_t smol__utf8_stream(smol_utf_stream_t* stream, const char* utf8, smol_size_t length, void* output, smol_size_t capacity, int last_chunk, int to_utf16) {
+
+	const unsigned char* src = (const unsigned char*)utf8;
+	smol_utf_result_t result = { SMOL_UTF_OK, 0, 0 };
+	smol_utf_result_t rest;
+
+	if(stream->pending_count) {
+
+		unsigned char sequence[4];
+		int count = stream->pending_count;
+		smol_size_t consumed = 0;
+		unsigned int codepoint;
+		int size;
+
+		memcpy(sequence, stream->pending, count);
+
+		while((size = smol__utf8_decode(sequence, count, &codepoint)) < 0 && consumed < length) 
+			sequence[count++] = src[consumed++];
+
+		if(size < 0) {
+			memcpy(stream->pending, sequence, count);
+			stream->pending_count = count;
+			result.read = length;
+			if(last_chunk) result.status = SMOL_UTF_TRUNCATED;
+			return result;
+		}
+
+		//The byte that broke the sequence isn't consumed, it may start the next one.
+		if(size == 0) {
+			stream->pending_count = 0;
+			result.status = SMOL_UTF_INVALID;
+			result.read = consumed ? consumed - 1 : 0;
+			return result;
+		}
+
+		int units = (to_utf16 && codepoint >= 0x10000) ? 2 : 1;
+		if(capacity < (smol_size_t)units) {
+			result.status = SMOL_UTF_OUTPUT_FULL;
+			return result;
+		}
+
+		if(!to_utf16) {
+			((unsigned int*)output)[0] = codepoint;
+		} else if(units == 2) {
+			((unsigned short*)output)[0] = (unsigned short)(0xD800 + ((codepoint - 0x10000) >> 10));
+			((unsigned short*)output)[1] = (unsigned short)(0xDC00 + ((codepoint - 0x10000) & 0x3FF));
+		} else {
+			((unsigned short*)output)[0] = (unsigned short)codepoint;
+		}
+
+		stream->pending_count = 0;
+		result.read = consumed;
+		result.written = units;
+
+	}
+
+	if(to_utf16) 
+		rest = smol_utf8_to_utf16_buffer(utf8 + result.read, length - result.read, (unsigned short*)output + result.written, capacity - result.written);
+	else 
+		rest = smol_utf8_to_utf32_buffer(utf8 + result.read, length - result.read, (unsigned int*)output + result.written, capacity - result.written);
+
+	result.status = rest.status;
+	result.read += rest.read;
+	result.written += rest.written;
+
+	if(result.status == SMOL_UTF_TRUNCATED && !last_chunk) {
+		stream->pending_count = (int)(length - result.read);
+		memcpy(stream->pending, src + result.read, stream->pending_count);
+		result.read = length;
+		result.status = SMOL_UTF_OK;
+	}
+
+	return result;
+
+}
+
+smol_utf_result_t smol_utf8_stream_to_utf16(smol_utf_stream_t* stream, const char* utf8, smol_size_t length, unsigned short* utf16, smol_size_t capacity, int last_chunk) {
+	return smol__utf8_stream(stream, utf8, length, utf16, capacity, last_chunk, SMOL_TRUE);
+}
+
+smol_utf_result_t smol_utf8_stream_to_utf32(smol_utf_stream_t* stream, const char* utf8, smol_size_t length, unsigned int* utf32, smol_size_t capacity, int last_chunk) {
+	return smol__utf8_stream(stream, utf8, length, utf32, capacity, last_chunk, SMOL_FALSE);
+}
+
+smol_utf_result_t smol_utf16_stream_to_utf8(smol_utf_stream_t* stream, const unsigned short* utf16, smol_size_t length, char* utf8, smol_size_t capacity, int last_chunk) {
+
+	smol_utf_result_t result = { SMOL_UTF_OK, 0, 0 };
+	smol_utf_result_t rest;
+
+	if(stream->pending_count) {
+
+		unsigned short pair[2];
+		unsigned int codepoint;
+
+		if(length == 0) {
+			if(last_chunk) result.status = SMOL_UTF_TRUNCATED;
+			return result;
+		}
+
+		pair[0] = stream->pending_surrogate;
+		pair[1] = utf16[0];
+
+		if(smol__utf16_decode(pair, 2, &codepoint) <= 0) {
+			stream->pending_count = 0;
+			result.status = SMOL_UTF_INVALID;
+			return result;
+		}
+
+		if(capacity < 4) {
+			result.status = SMOL_UTF_OUTPUT_FULL;
+			return result;
+		}
+
+		smol__utf8_encode(codepoint, 4, (unsigned char*)utf8);
+		stream->pending_count = 0;
+		result.read = 1;
+		result.written = 4;
+
+	}
+
+	rest = smol_utf16_to_utf8_buffer(utf16 + result.read, length - result.read, utf8 + result.written, capacity - result.written);
+
+	result.status = rest.status;
+	result.read += rest.read;
+	result.written += rest.written;
+
+	if(result.status == SMOL_UTF_TRUNCATED && !last_chunk) {
+		stream->pending_surrogate = utf16[result.read];
+		stream->pending_count = 1;
+		result.read = length;
+		result.status = SMOL_UTF_OK;
+	}
+
+	return result;
+
+}
+
+#pragma endregion
+
+#pragma region Sorting utilities
+
+
+void smol_sort(void* data, int num_elements, int element_size, smol_sort_proc compare, void* user_data) {
+
+	char* first = ((char*)data);
+	char* last =  first + (num_elements * element_size);
+
+#ifdef _MSC_VER
+#define SMOL_SORT_SWAP(a, b) { \
+	char* tmp = alloca(element_size); \
+	memcpy((void*)tmp, (const void*)a, element_size); \
+	memcpy((void*)a, (const void*)b, element_size); \
+	memcpy((void*)b, (const void*)tmp, element_size); \
+}
+#else 
+#define SMOL_SORT_SWAP(a, b) { \
+	char tmp[element_size]; \
+	memcpy(tmp, a, element_size); \
+	memcpy(a, b, element_size); \
+	memcpy(b, tmp, element_size); \
+}
+#endif 
+
+	if((last - first) > element_size) {
+		char* part_idx = first;
+		{
+			char* pivot = last - element_size;
+			for(char* it = first; it != last; it += element_size) {
+				if(compare((const void*)pivot, (const void*)it, user_data) > 0) {
+					SMOL_SORT_SWAP(part_idx, it);
+					part_idx += element_size;
+				}
+			}
+			SMOL_SORT_SWAP(part_idx, pivot);
+		}
+		smol_sort((void*)first, (part_idx - first) / element_size, element_size, compare, user_data);
+		smol_sort((void*)(part_idx + element_size), (last - (part_idx + element_size)) / element_size, element_size, compare, user_data);
+	}
+#undef SMOL_SORT_SWAP
+}
+
+#pragma endregion
+
+
+#pragma region Queues
+
+void smol__queue_grow(void** data, int* allocation, int first, int last, int element_size) {
+
+	int old_allocation = *allocation;
+	int new_allocation = old_allocation << 1;
+
+	char* buffer = (char*)SMOL_REALLOC(*data, (smol_size_t)element_size * new_allocation);
+	SMOL_ASSERT(buffer);
+
+	//Elements that had wrapped around to the beginning of the old buffer are moved
+	//right after the old end, so the queue stays contiguous from 'first' onwards.
+	if(last > old_allocation) {
+		memcpy(
+			buffer + (smol_size_t)old_allocation * element_size, 
+			buffer, 
+			(smol_size_t)(last - old_allocation) * element_size
+		);
+	}
+
+	(void)first;
+	*data = (void*)buffer;
+	*allocation = new_allocation;
+
+}
+
+static smol_size_t smol__next_pow2(smol_size_t value) {
+	smol_size_t res = 1;
+	while(res < value) res <<= 1;
+	return res;
+}
+
+int smol_mpmc_queue_init(smol_mpmc_queue_t* queue, int capacity, int element_size) {
+
+	memset(queue, 0, sizeof(*queue));
+
+	if(capacity < 2 || element_size <= 0) 
+		return SMOL_FALSE;
+
+	smol_size_t cell_count = smol__next_pow2((smol_size_t)capacity);
+
+	//Sequence number followed by the element payload, kept 8 byte aligned.
+	queue->cell_size = (int)((sizeof(smol_size_t) + element_size + 7) & ~7);
+	queue->element_size = element_size;
+	queue->mask = cell_count - 1;
+	queue->cells = (char*)SMOL_ALLOC(cell_count * queue->cell_size);
+
+	if(queue->cells == NULL) 
+		return SMOL_FALSE;
+
+	for(smol_size_t i = 0; i < cell_count; i++) {
+		volatile smol_size_t* seq = (volatile smol_size_t*)(queue->cells + i * queue->cell_size);
+		smol_atomic_store(seq, i);
+	}
+
+	smol_atomic_store(&queue->enqueue_pos, 0);
+	smol_atomic_store(&queue->dequeue_pos, 0);
+
+	return SMOL_TRUE;
+
+}
+
+void smol_mpmc_queue_free(smol_mpmc_queue_t* queue) {
+	if(queue->cells) SMOL_FREE(queue->cells);
+	queue->cells = NULL;
+	queue->mask = 0;
+}
+
+int smol_mpmc_queue_push(smol_mpmc_queue_t* queue, const void* element) {
+
+	char* cell;
+	smol_size_t pos = smol_atomic_load(&queue->enqueue_pos);
+
+	for(;;) {
+
+		cell = queue->cells + (pos & queue->mask) * queue->cell_size;
+		smol_size_t seq = smol_atomic_load((volatile smol_size_t*)cell);
+		smol_ssize_t diff = (smol_ssize_t)(seq - pos);
+
+		if(diff == 0) {
+			if(smol_atomic_cas(&queue->enqueue_pos, pos, pos + 1))
+				break;
+			pos = smol_atomic_load(&queue->enqueue_pos);
+		} else if(diff < 0) {
+			return SMOL_FALSE;
+		} else {
+			pos = smol_atomic_load(&queue->enqueue_pos);
+		}
+
+	}
+
+	memcpy(cell + sizeof(smol_size_t), element, queue->element_size);
+	smol_atomic_store((volatile smol_size_t*)cell, pos + 1);
+
+	return SMOL_TRUE;
+
+}
+
+int smol_mpmc_queue_pop(smol_mpmc_queue_t* queue, void* element) {
+
+	char* cell;
+	smol_size_t pos = smol_atomic_load(&queue->dequeue_pos);
+
+	for(;;) {
+
+		cell = queue->cells + (pos & queue->mask) * queue->cell_size;
+		smol_size_t seq = smol_atomic_load((volatile smol_size_t*)cell);
+		smol_ssize_t diff = (smol_ssize_t)(seq - (pos + 1));
+
+		if(diff == 0) {
+			if(smol_atomic_cas(&queue->dequeue_pos, pos, pos + 1))
+				break;
+			pos = smol_atomic_load(&queue->dequeue_pos);
+		} else if(diff < 0) {
+			return SMOL_FALSE;
+		} else {
+			pos = smol_atomic_load(&queue->dequeue_pos);
+		}
+
+	}
+
+	memcpy(element, cell + sizeof(smol_size_t), queue->element_size);
+	smol_atomic_store((volatile smol_size_t*)cell, pos + queue->mask + 1);
+
+	return SMOL_TRUE;
+
+}
+
+int smol_spsc_queue_init(smol_spsc_queue_t* queue, int capacity, int element_size) {
+
+	memset(queue, 0, sizeof(*queue));
+
+	if(capacity < 1 || element_size <= 0) 
+		return SMOL_FALSE;
+
+	smol_size_t count = smol__next_pow2((smol_size_t)capacity);
+
+	queue->element_size = element_size;
+	queue->mask = count - 1;
+	queue->data = (char*)SMOL_ALLOC(count * element_size);
+
+	return queue->data != NULL;
+
+}
+
+void smol_spsc_queue_free(smol_spsc_queue_t* queue) {
+	if(queue->data) SMOL_FREE(queue->data);
+	queue->data = NULL;
+	queue->mask = 0;
+}
+
+int smol_spsc_queue_push(smol_spsc_queue_t* queue, const void* element) {
+
+	smol_size_t tail = queue->tail;
+
+	if(tail - queue->cached_head > queue->mask) {
+		queue->cached_head = smol_atomic_load(&queue->head);
+		if(tail - queue->cached_head > queue->mask) 
+			return SMOL_FALSE;
+	}
+
+	memcpy(queue->data + (tail & queue->mask) * queue->element_size, element, queue->element_size);
+	smol_atomic_store(&queue->tail, tail + 1);
+
+	return SMOL_TRUE;
+
+}
+
+int smol_spsc_queue_pop(smol_spsc_queue_t* queue, void* element) {
+
+	smol_size_t head = queue->head;
+
+	if(head == queue->cached_tail) {
+		queue->cached_tail = smol_atomic_load(&queue->tail);
+		if(head == queue->cached_tail) 
+			return SMOL_FALSE;
+	}
+
+	memcpy(element, queue->data + (head & queue->mask) * queue->element_size, queue->element_size);
+	smol_atomic_store(&queue->head, head + 1);
+
+	return SMOL_TRUE;
+
+}
+
+#pragma endregion
+
+
+#pragma region Job system
+
+typedef struct _smol__job_t {
+	smol_job_proc proc;
+	void* user_data;
+	smol_job_counter_t* counter;
+} smol__job_t;
+
+//Chase-Lev work stealing deque, the owner pushes and takes from the bottom, thieves steal from the top.
+typedef struct _smol__job_worker_t {
+	volatile smol_size_t top;
+	char pad0[SMOL_CACHE_LINE_SIZE - sizeof(smol_size_t)];
+	volatile smol_size_t bottom;
+	char pad1[SMOL_CACHE_LINE_SIZE - sizeof(smol_size_t)];
+	smol__job_t jobs[SMOL_JOB_DEQUE_SIZE];
+	unsigned int steal_seed;
+	int index;
+#ifdef SMOL_HAS_THREADS
+	smol_thread_t thread;
+#endif 
+} smol__job_worker_t;
+
+typedef struct _smol__job_system_t {
+	smol__job_worker_t* workers;
+	int num_workers;
+	volatile smol_size_t running;
+	volatile smol_size_t pending;
+	volatile smol_size_t sleeping;
+#ifdef SMOL_HAS_THREADS
+	smol_mutex_t sleep_mutex;
+	smol_cond_t sleep_cond;
+#endif 
+} smol__job_system_t;
+
+static smol__job_system_t smol__job_system;
+static SMOL_THREAD_LOCAL int smol__job_worker_index = -1;
+
+static int smol__job_deque_push(smol__job_worker_t* worker, const smol__job_t* job) {
+
+	smol_size_t b = worker->bottom;
+	smol_size_t t = smol_atomic_load(&worker->top);
+
+	if((smol_ssize_t)(b - t) >= SMOL_JOB_DEQUE_SIZE)
+		return SMOL_FALSE;
+
+	worker->jobs[b & (SMOL_JOB_DEQUE_SIZE-1)] = *job;
+	smol_atomic_store(&worker->bottom, b + 1);
+
+	return SMOL_TRUE;
+
+}
+
+static int smol__job_deque_take(smol__job_worker_t* worker, smol__job_t* job) {
+
+	smol_size_t b = worker->bottom - 1;
+	smol_atomic_exchange(&worker->bottom, b); //Acts as a full fence too
+	smol_size_t t = smol_atomic_load(&worker->top);
+
+	if((smol_ssize_t)(b - t) < 0) {
+		smol_atomic_store(&worker->bottom, b + 1);
+		return SMOL_FALSE;
+	}
+
+	*job = worker->jobs[b & (SMOL_JOB_DEQUE_SIZE-1)];
+
+	if(b != t) 
+		return SMOL_TRUE;
+
+	//Last job, race against thieves
+	int won = smol_atomic_cas(&worker->top, t, t + 1);
+	smol_atomic_store(&worker->bottom, b + 1);
+
+	return won;
+
+}
+
+static int smol__job_deque_steal(smol__job_worker_t* worker, smol__job_t* job) {
+
+	smol_size_t t = smol_atomic_load(&worker->top);
+	smol_atomic_fence();
+	smol_size_t b = smol_atomic_load(&worker->bottom);
+
+	if((smol_ssize_t)(b - t) <= 0)
+		return SMOL_FALSE;
+
+	*job = worker->jobs[t & (SMOL_JOB_DEQUE_SIZE-1)];
+
+	//If somebody else got it first, the copy we just made may be stale, so it's discarded.
+	return smol_atomic_cas(&worker->top, t, t + 1);
+
+}
+
+static void smol__job_execute(const smol__job_t* job) {
+	job->proc(job->user_data);
+	if(job->counter) smol_atomic_fetch_add(&job->counter->value, (smol_size_t)-1);
+}
+
+static int smol__job_find(int worker_index, smol__job_t* job) {
+
+	smol__job_system_t* sys = &smol__job_system;
+	smol__job_worker_t* self = &sys->workers[worker_index];
+
+	if(smol_atomic_load(&sys->pending) == 0)
+		return SMOL_FALSE;
+
+	if(smol__job_deque_take(self, job))
+		goto found;
+
+	if(sys->num_workers > 1) {
+		//Xorshift to pick a random victim, then go through everyone once.
+		unsigned int x = self->steal_seed;
+		x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+		self->steal_seed = x;
+		int start = (int)(x % (unsigned int)sys->num_workers);
+		for(int i = 0; i < sys->num_workers; i++) {
+			int victim = (start + i) % sys->num_workers;
+			if(victim == worker_index) continue;
+			if(smol__job_deque_steal(&sys->workers[victim], job))
+				goto found;
+		}
+	}
+
+	return SMOL_FALSE;
+
+found:
+	smol_atomic_fetch_add(&sys->pending, (smol_size_t)-1);
+	return SMOL_TRUE;
+
+}
+
+#ifdef SMOL_HAS_THREADS
+static void smol__job_worker_proc(void* user_data) {
+
+	smol__job_system_t* sys = &smol__job_system;
+	smol__job_worker_t* self = (smol__job_worker_t*)user_data;
+	smol__job_worker_index = self->index;
+
+	int idle = 0;
+	smol__job_t job;
+
+	while(smol_atomic_load(&sys->running)) {
+
+		if(smol__job_find(self->index, &job)) {
+			smol__job_execute(&job);
+			idle = 0;
+			continue;
+		}
+
+		if(++idle < 64) {
+			smol_cpu_relax();
+		} else if(idle < 128) {
+			smol_thread_yield();
+		} else {
+			//Nothing to do for a while, so sleep until someone submits more jobs.
+			smol_mutex_lock(&sys->sleep_mutex);
+			smol_atomic_fetch_add(&sys->sleeping, 1);
+			while(smol_atomic_load(&sys->pending) == 0 && smol_atomic_load(&sys->running))
+				smol_cond_wait(&sys->sleep_cond, &sys->sleep_mutex);
+			smol_atomic_fetch_add(&sys->sleeping, (smol_size_t)-1);
+			smol_mutex_unlock(&sys->sleep_mutex);
+			idle = 0;
+		}
+
+	}
+
+	//Jobs that were still running at shutdown may have pushed more work into our deque
+	while(smol__job_deque_take(self, &job)) {
+		smol_atomic_fetch_add(&sys->pending, (smol_size_t)-1);
+		smol__job_execute(&job);
+	}
+
+}
+#endif 
+
+int smol_job_system_init(int num_threads) {
+
+	smol__job_system_t* sys = &smol__job_system;
+
+	if(sys->workers) 
+		return SMOL_FALSE;
+
+#ifdef SMOL_HAS_THREADS
+	if(num_threads < 0) 
+		num_threads = smol_get_num_cpus() - 1;
+	if(num_threads > SMOL_JOB_MAX_WORKERS-1) 
+		num_threads = SMOL_JOB_MAX_WORKERS-1;
+#else 
+	num_threads = 0;
+#endif 
+
+	sys->num_workers = num_threads + 1;
+	sys->workers = (smol__job_worker_t*)SMOL_ALLOC(sizeof(smol__job_worker_t) * sys->num_workers);
+	if(sys->workers == NULL) 
+		return SMOL_FALSE;
+
+	memset(sys->workers, 0, sizeof(smol__job_worker_t) * sys->num_workers);
+
+	for(int i = 0; i < sys->num_workers; i++) {
+		sys->workers[i].index = i;
+		sys->workers[i].steal_seed = 0x9E3779B9u * (unsigned int)(i + 1);
+	}
+
+	smol_atomic_store(&sys->pending, 0);
+	smol_atomic_store(&sys->sleeping, 0);
+	smol_atomic_store(&sys->running, 1);
+	smol__job_worker_index = 0;
+
+#ifdef SMOL_HAS_THREADS
+	smol_mutex_init(&sys->sleep_mutex);
+	smol_cond_init(&sys->sleep_cond);
+
+	for(int i = 1; i < sys->num_workers; i++) {
+		if(!smol_thread_create(&sys->workers[i].thread, &smol__job_worker_proc, &sys->workers[i])) {
+			sys->num_workers = i;
+			break;
+		}
+	}
+#endif 
+
+	return SMOL_TRUE;
+
+}
+
+void smol_job_system_shutdown(void) {
+
+	smol__job_system_t* sys = &smol__job_system;
+
+	if(sys->workers == NULL) 
+		return;
+
+	//Finish what's left in every queue, the workers keep helping until nothing is pending
+	smol__job_t job;
+	while(smol_atomic_load(&sys->pending) != 0) {
+		if(smol__job_find(0, &job))
+			smol__job_execute(&job);
+		else {
+#ifdef SMOL_HAS_THREADS
+			smol_thread_yield();
+#else 
+			break; //Everything is in our own deque, so find can't miss
+#endif 
+		}
+	}
+
+	smol_atomic_store(&sys->running, 0);
+
+#ifdef SMOL_HAS_THREADS
+	smol_mutex_lock(&sys->sleep_mutex);
+	smol_cond_broadcast(&sys->sleep_cond);
+	smol_mutex_unlock(&sys->sleep_mutex);
+
+	for(int i = 1; i < sys->num_workers; i++)
+		smol_thread_join(sys->workers[i].thread);
+
+	smol_cond_destroy(&sys->sleep_cond);
+	smol_mutex_destroy(&sys->sleep_mutex);
+#endif 
+
+	SMOL_FREE(sys->workers);
+	sys->workers = NULL;
+	sys->num_workers = 0;
+	smol__job_worker_index = -1;
+
+}
+
+int smol_job_system_num_workers(void) {
+	return smol__job_system.num_workers;
+}
+
+void smol_job_submit(smol_job_proc proc, void* user_data, smol_job_counter_t* counter) {
+
+	smol__job_system_t* sys = &smol__job_system;
+	smol__job_t job = { proc, user_data, counter };
+
+	if(counter) 
+		smol_atomic_fetch_add(&counter->value, 1);
+
+	if(
+		sys->workers == NULL || 
+		smol__job_worker_index < 0 || 
+		!smol__job_deque_push(&sys->workers[smol__job_worker_index], &job)
+	) {
+		smol__job_execute(&job);
+		return;
+	}
+
+	smol_atomic_fetch_add(&sys->pending, 1);
+
+#ifdef SMOL_HAS_THREADS
+	if(smol_atomic_load(&sys->sleeping)) {
+		smol_mutex_lock(&sys->sleep_mutex);
+		smol_cond_signal(&sys->sleep_cond);
+		smol_mutex_unlock(&sys->sleep_mutex);
+	}
+#endif 
+
+}
+
+void smol_job_wait(smol_job_counter_t* counter) {
+
+	smol__job_t job;
+	int idle = 0;
+
+	while(smol_atomic_load(&counter->value)) {
+
+		if(smol__job_worker_index >= 0 && smol__job_system.workers && smol__job_find(smol__job_worker_index, &job)) {
+			smol__job_execute(&job);
+			idle = 0;
+			continue;
+		}
+
+#ifdef SMOL_HAS_THREADS
+		if(++idle < 64) smol_cpu_relax();
+		else smol_thread_yield();
+#endif 
+
+	}
+
+}
+
+typedef struct _smol__parallel_for_t {
+	volatile smol_size_t next;
+	int last;
+	int grain_size;
+	smol_parallel_for_proc proc;
+	void* user_data;
+} smol__parallel_for_t;
+
+static void smol__parallel_for_job(void* user_data) {
+
+	smol__parallel_for_t* pf = (smol__parallel_for_t*)user_data;
+
+	for(;;) {
+		smol_ssize_t first = (smol_ssize_t)smol_atomic_fetch_add(&pf->next, (smol_size_t)pf->grain_size);
+		if(first >= pf->last) break;
+		smol_ssize_t last = first + pf->grain_size;
+		if(last > pf->last) last = pf->last;
+		pf->proc((int)first, (int)last, pf->user_data);
+	}
+
+}
+
+void smol_parallel_for(int first, int last, int grain_size, smol_parallel_for_proc proc, void* user_data) {
+
+	if(last <= first) 
+		return;
+
+	if(grain_size < 1) 
+		grain_size = 1;
+
+	int num_chunks = (last - first + grain_size - 1) / grain_size;
+	int num_jobs = smol__job_system.num_workers;
+
+	if(num_jobs > num_chunks) num_jobs = num_chunks;
+	if(num_jobs <= 1 || smol__job_worker_index < 0) {
+		proc(first, last, user_data);
+		return;
+	}
+
+	//Chunks are handed out from a shared counter, so faster workers simply grab more of them.
+	smol__parallel_for_t pf = { 0 };
+	pf.next = (smol_size_t)first;
+	pf.last = last;
+	pf.grain_size = grain_size;
+	pf.proc = proc;
+	pf.user_data = user_data;
+
+	smol_job_counter_t counter = { 0 };
+	for(int i = 1; i < num_jobs; i++) 
+		smol_job_submit(&smol__parallel_for_job, &pf, &counter);
+
+	smol__parallel_for_job(&pf);
+	smol_job_wait(&counter);
+
+}
+
+#pragma endregion
+
+
+#pragma region Timing and profiling
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#	define smol__rdtsc() __rdtsc()
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#	define smol__rdtsc() __builtin_ia32_rdtsc()
+#endif 
+
+unsigned long long smol_cycles(void) {
+#ifdef smol__rdtsc
+	return (unsigned long long)smol__rdtsc();
+#else 
+	return (unsigned long long)(smol_timer() * 1e9);
+#endif 
+}
+
+static double smol__cycles_frequency;
+
+double smol_cycles_frequency(void) {
+
+	if(smol__cycles_frequency == 0.0) {
+#ifdef smol__rdtsc
+		double t0 = smol_timer();
+		unsigned long long c0 = smol_cycles();
+		double t1;
+		while((t1 = smol_timer()) - t0 < 0.01) 
+			smol_cpu_relax();
+		unsigned long long c1 = smol_cycles();
+		smol__cycles_frequency = (double)(c1 - c0) / (t1 - t0);
+#else 
+		smol__cycles_frequency = 1e9;
+#endif 
+	}
+
+	return smol__cycles_frequency;
+
+}
+
+typedef struct _smol__profile_event_t {
+	const char* name; //NULL for end events
+	unsigned long long cycles;
+} smol__profile_event_t;
+
+typedef struct _smol__profile_buffer_t {
+	struct _smol__profile_buffer_t* next;
+	int thread_id;
+	volatile smol_size_t count;
+	smol__profile_event_t events[SMOL_PROFILE_RING_SIZE];
+} smol__profile_buffer_t;
+
+static volatile smol_size_t smol__profile_buffers; //Linked list of every thread's ring buffer
+static volatile smol_size_t smol__profile_thread_count;
+static volatile smol_size_t smol__profile_start_cycles;
+static SMOL_THREAD_LOCAL smol__profile_buffer_t* smol__profile_thread_buffer;
+
+static smol__profile_buffer_t* smol__profile_get_buffer(void) {
+
+	smol__profile_buffer_t* buffer = smol__profile_thread_buffer;
+	if(buffer) return buffer;
+
+	buffer = (smol__profile_buffer_t*)SMOL_ALLOC(sizeof(smol__profile_buffer_t));
+	buffer->count = 0;
+	buffer->thread_id = (int)smol_atomic_fetch_add(&smol__profile_thread_count, 1);
+
+	if(smol_atomic_load(&smol__profile_start_cycles) == 0)
+		smol_atomic_cas(&smol__profile_start_cycles, 0, (smol_size_t)smol_cycles());
+
+	smol_size_t head;
+	do {
+		head = smol_atomic_load(&smol__profile_buffers);
+		buffer->next = (smol__profile_buffer_t*)head;
+	} while(!smol_atomic_cas(&smol__profile_buffers, head, (smol_size_t)buffer));
+
+	smol__profile_thread_buffer = buffer;
+	return buffer;
+
+}
+
+static SMOL_INLINE void smol__profile_record(const char* name) {
+	smol__profile_buffer_t* buffer = smol__profile_get_buffer();
+	smol_size_t index = buffer->count;
+	smol__profile_event_t* event = &buffer->events[index & (SMOL_PROFILE_RING_SIZE-1)];
+	event->name = name;
+	event->cycles = smol_cycles();
+	smol_atomic_store(&buffer->count, index + 1);
+}
+
+void smol_profile_begin(const char* name) {
+	smol__profile_record(name);
+}
+
+void smol_profile_end(void) {
+	smol__profile_record(NULL);
+}
+
+void smol_profile_reset(void) {
+	for(
+		smol__profile_buffer_t* buffer = (smol__profile_buffer_t*)smol_atomic_load(&smol__profile_buffers); 
+		buffer; 
+		buffer = buffer->next
+	) {
+		smol_atomic_store(&buffer->count, 0);
+	}
+}
+
+static void smol__profile_write_json_string(FILE* file, const char* str) {
+	fputc('"', file);
+	for(; *str; str++) {
+		if(*str == '"' || *str == '\\') fputc('\\', file);
+		if((unsigned char)*str < 0x20) continue;
+		fputc(*str, file);
+	}
+	fputc('"', file);
+}
+
+int smol_profile_export_chrome_trace(const char* file_path) {
+
+	FILE* file = fopen(file_path, "w");
+	if(file == NULL) 
+		return SMOL_FALSE;
+
+	double to_us = 1e6 / smol_cycles_frequency();
+	unsigned long long start = (unsigned long long)smol_atomic_load(&smol__profile_start_cycles);
+	int first = SMOL_TRUE;
+
+	fputs("{\"traceEvents\":[\n", file);
+
+	for(
+		smol__profile_buffer_t* buffer = (smol__profile_buffer_t*)smol_atomic_load(&smol__profile_buffers); 
+		buffer; 
+		buffer = buffer->next
+	) {
+
+		smol_size_t count = smol_atomic_load(&buffer->count);
+		smol_size_t begin = count > SMOL_PROFILE_RING_SIZE ? count - SMOL_PROFILE_RING_SIZE : 0;
+
+		//The open zones are tracked, so the zones which beginnings were overwritten can be skipped.
+		const char* stack[256];
+		int depth = 0;
+		int skipped = 0; //Begins too deep for the stack, their ends are skipped too
+
+		for(smol_size_t i = begin; i < count; i++) {
+
+			const smol__profile_event_t* event = &buffer->events[i & (SMOL_PROFILE_RING_SIZE-1)];
+			const char* name = event->name;
+
+			if(name == NULL) {
+				if(skipped) { skipped--; continue; }
+				if(depth == 0) continue;
+				name = stack[--depth];
+			} else if(depth < 256) {
+				stack[depth++] = name;
+			} else {
+				skipped++;
+				continue;
+			}
+
+			if(!first) fputs(",\n", file);
+			first = SMOL_FALSE;
+
+			fputs("{\"name\":", file);
+			smol__profile_write_json_string(file, name);
+			fprintf(
+				file, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%d}", 
+				event->name ? 'B' : 'E', 
+				(double)(long long)(event->cycles - start) * to_us, 
+				buffer->thread_id
+			);
+
+		}
+
+	}
+
+	fputs("\n]}\n", file);
+	fclose(file);
+
+	return SMOL_TRUE;
+
+}
+
+#pragma endregion
+
+
+#pragma region Asynchronous file loading
+
+typedef struct _smol__file_op_t {
+	smol_file_completion_t completion;
+	smol_size_t offset;
+	smol_size_t remaining;
+	int owns_buffer;
+#if defined(SMOL_PLATFORM_WINDOWS)
+	HANDLE handle;
+#elif defined(SMOL_PLATFORM_LINUX)
+	int fd;
+#else 
+	FILE* file;
+#endif 
+} smol__file_op_t;
+
+//These are implemented per platform
+static int smol__file_op_open(smol__file_op_t* op, const smol_file_request_t* request);
+static void smol__file_op_read(smol__file_op_t* op);
+static void smol__file_op_close(smol__file_op_t* op);
+
+//Called by smol__file_op_open once the file size is known, works out how much 
+//is read and where, allocating the buffer if the caller didn't provide one.
+static int smol__file_op_setup(smol__file_op_t* op, const smol_file_request_t* request, smol_size_t file_size) {
+
+	smol_size_t available = file_size > request->offset ? file_size - request->offset : 0;
+	smol_size_t size = request->size ? request->size : available;
+	if(size > available) size = available;
+
+	op->offset = request->offset;
+	op->completion.file_path = request->file_path;
+	op->completion.user_data = request->user_data;
+	op->completion.size = 0;
+
+	if(request->buffer) {
+		op->owns_buffer = SMOL_FALSE;
+		op->completion.buffer = request->buffer;
+		op->remaining = size < request->buffer_size ? size : request->buffer_size;
+	} else {
+		op->owns_buffer = SMOL_TRUE;
+		op->completion.buffer = SMOL_ALLOC(size + 1);
+		op->remaining = size;
+		if(op->completion.buffer == NULL) 
+			return SMOL_FALSE;
+		((char*)op->completion.buffer)[size] = 0;
+	}
+
+	return SMOL_TRUE;
+
+}
+
+static void smol__file_op_finish(smol__file_op_t* op) {
+
+	op->completion.owns_buffer = op->owns_buffer;
+
+	if(op->owns_buffer && op->completion.buffer) {
+		if(op->completion.error) {
+			SMOL_FREE(op->completion.buffer);
+			op->completion.buffer = NULL;
+		} else {
+			((char*)op->completion.buffer)[op->completion.size] = 0;
+		}
+	}
+
+}
+
+struct _smol_file_loader_t {
+	smol_mpmc_queue_t requests;
+	smol_mpmc_queue_t completions;
+	smol_file_completion_proc callback;
+	void* callback_user_data;
+	volatile smol_size_t running;
+	volatile smol_size_t queued;
+	volatile smol_size_t in_flight;
+#ifdef SMOL_HAS_THREADS
+	int num_threads;
+	smol_thread_t threads[SMOL_FILE_LOADER_MAX_THREADS];
+	smol_mutex_t mutex;
+	smol_cond_t cond;
+#endif 
+#ifdef SMOL__HAS_IO_URING
+	struct _smol__io_uring_t* ring;
+#endif 
+};
+
+//smol__file_loader_complete - Delivers a completion, returns SMOL_FALSE if it had to be dropped
+static int smol__file_loader_complete(smol_file_loader_t* loader, smol__file_op_t* op) {
+
+	int delivered = SMOL_TRUE;
+
+	smol__file_op_finish(op);
+
+	if(loader->callback) {
+		loader->callback(&op->completion, loader->callback_user_data);
+	} else {
+		while(!smol_mpmc_queue_push(&loader->completions, &op->completion)) {
+			//Waiting for the caller to poll only makes sense from an I/O thread of a running loader, 
+			//a stopping loader discards the completions anyway.
+#ifdef SMOL_HAS_THREADS
+			if(loader->num_threads && smol_atomic_load(&loader->running)) {
+				smol_thread_yield();
+				continue;
+			}
+#endif 
+			if(op->completion.owns_buffer && op->completion.buffer)
+				SMOL_FREE(op->completion.buffer);
+			delivered = SMOL_FALSE;
+			break;
+		}
+	}
+
+	smol_atomic_fetch_add(&loader->in_flight, (smol_size_t)-1);
+
+	return delivered;
+
+}
+
+static void smol__file_loader_process(smol_file_loader_t* loader, const smol_file_request_t* request) {
+
+	smol__file_op_t op = { 0 };
+
+	if(smol__file_op_open(&op, request)) {
+		smol__file_op_read(&op);
+		smol__file_op_close(&op);
+	}
+
+	smol__file_loader_complete(loader, &op);
+
+}
+
+//smol__file_loader_next_request - Pops a request, if 'wait' is set, blocks until there's one or the loader is stopped
+static int smol__file_loader_next_request(smol_file_loader_t* loader, smol_file_request_t* request, int wait) {
+
+	for(;;) {
+
+		if(smol_mpmc_queue_pop(&loader->requests, request)) {
+			smol_atomic_fetch_add(&loader->queued, (smol_size_t)-1);
+			return SMOL_TRUE;
+		}
+
+		if(!wait || !smol_atomic_load(&loader->running)) 
+			return SMOL_FALSE;
+
+#ifdef SMOL_HAS_THREADS
+		smol_mutex_lock(&loader->mutex);
+		while(smol_atomic_load(&loader->queued) == 0 && smol_atomic_load(&loader->running))
+			smol_cond_wait(&loader->cond, &loader->mutex);
+		smol_mutex_unlock(&loader->mutex);
+#else 
+		return SMOL_FALSE;
+#endif 
+
+	}
+
+}
+
+#ifdef SMOL_HAS_THREADS
+static void smol__file_loader_thread_proc(void* user_data) {
+
+	smol_file_loader_t* loader = (smol_file_loader_t*)user_data;
+	smol_file_request_t request;
+
+	while(smol__file_loader_next_request(loader, &request, SMOL_TRUE))
+		smol__file_loader_process(loader, &request);
+
+}
+#endif 
+
+#ifdef SMOL__HAS_IO_URING
+static struct _smol__io_uring_t* smol__io_uring_create(unsigned int entries);
+static void smol__io_uring_destroy(struct _smol__io_uring_t* ring);
+static void smol__file_loader_io_uring_proc(void* user_data);
+#endif 
+
+smol_file_loader_t* smol_file_loader_create(int num_threads, int queue_size, smol_file_completion_proc callback, void* callback_user_data) {
+
+	smol_file_loader_t* loader = (smol_file_loader_t*)SMOL_ALLOC(sizeof(smol_file_loader_t));
+	if(loader == NULL) 
+		return NULL;
+
+	memset(loader, 0, sizeof(*loader));
+
+	if(queue_size < 2) queue_size = 2;
+
+	if(
+		!smol_mpmc_queue_init(&loader->requests, queue_size, sizeof(smol_file_request_t)) ||
+		!smol_mpmc_queue_init(&loader->completions, queue_size, sizeof(smol_file_completion_t))
+	) {
+		smol_mpmc_queue_free(&loader->requests);
+		SMOL_FREE(loader);
+		return NULL;
+	}
+
+	loader->callback = callback;
+	loader->callback_user_data = callback_user_data;
+	smol_atomic_store(&loader->running, 1);
+
+#ifdef SMOL_HAS_THREADS
+	smol_mutex_init(&loader->mutex);
+	smol_cond_init(&loader->cond);
+
+	if(num_threads <= 0) num_threads = 1;
+	if(num_threads > SMOL_FILE_LOADER_MAX_THREADS) num_threads = SMOL_FILE_LOADER_MAX_THREADS;
+
+	smol_thread_proc thread_proc = &smol__file_loader_thread_proc;
+
+#ifdef SMOL__HAS_IO_URING
+	//One thread keeps the ring fed, the kernel does the rest.
+	if((loader->ring = smol__io_uring_create(64)) != NULL) {
+		thread_proc = &smol__file_loader_io_uring_proc;
+		num_threads = 1;
+	}
+#endif 
+
+	for(int i = 0; i < num_threads; i++) {
+		if(!smol_thread_create(&loader->threads[i], thread_proc, loader))
+			break;
+		loader->num_threads++;
+	}
+#else 
+	(void)num_threads;
+#endif 
+
+	return loader;
+
+}
+
+int smol_file_loader_submit(smol_file_loader_t* loader, const smol_file_request_t* requests, int count) {
+
+	int num_submitted = 0;
+
+	for(; num_submitted < count; num_submitted++) {
+		smol_atomic_fetch_add(&loader->in_flight, 1);
+		if(!smol_mpmc_queue_push(&loader->requests, &requests[num_submitted])) {
+			smol_atomic_fetch_add(&loader->in_flight, (smol_size_t)-1);
+			break;
+		}
+		smol_atomic_fetch_add(&loader->queued, 1);
+	}
+
+#ifdef SMOL_HAS_THREADS
+	if(num_submitted && loader->num_threads) {
+		smol_mutex_lock(&loader->mutex);
+		smol_cond_broadcast(&loader->cond);
+		smol_mutex_unlock(&loader->mutex);
+		return num_submitted;
+	}
+#endif 
+
+	//No I/O threads, with a callback they're processed right here, otherwise by smol_file_loader_poll
+	if(loader->callback) {
+		smol_file_request_t request;
+		while(smol__file_loader_next_request(loader, &request, SMOL_FALSE))
+			smol__file_loader_process(loader, &request);
+	}
+
+	return num_submitted;
+
+}
+
+int smol_file_loader_poll(smol_file_loader_t* loader, smol_file_completion_t* completion) {
+
+	if(smol_mpmc_queue_pop(&loader->completions, completion))
+		return SMOL_TRUE;
+
+#ifdef SMOL_HAS_THREADS
+	if(loader->num_threads)
+		return SMOL_FALSE;
+#endif 
+
+	//No I/O threads, process one request at a time, so its completion always fits the queue
+	smol_file_request_t request;
+	if(!smol__file_loader_next_request(loader, &request, SMOL_FALSE))
+		return SMOL_FALSE;
+
+	smol__file_loader_process(loader, &request);
+	return smol_mpmc_queue_pop(&loader->completions, completion);
+
+}
+
+int smol_file_loader_in_flight(smol_file_loader_t* loader) {
+	return (int)smol_atomic_load(&loader->in_flight);
+}
+
+void smol_file_loader_destroy(smol_file_loader_t* loader) {
+
+	if(loader == NULL) 
+		return;
+
+	//The threads finish the queued requests before they exit, and as the loader is stopping, 
+	//they drop completions that don't fit rather than wait for them to be polled.
+	smol_atomic_store(&loader->running, 0);
+
+	smol_file_completion_t completion;
+	smol_file_request_t request;
+
+#ifdef SMOL_HAS_THREADS
+	smol_mutex_lock(&loader->mutex);
+	smol_cond_broadcast(&loader->cond);
+	smol_mutex_unlock(&loader->mutex);
+#endif 
+
+	while(smol_atomic_load(&loader->in_flight)) {
+
+		//Completions nobody polled, free only what the loader allocated. 
+		while(smol_mpmc_queue_pop(&loader->completions, &completion)) {
+			if(completion.owns_buffer && completion.buffer) 
+				SMOL_FREE(completion.buffer);
+		}
+
+#ifdef SMOL_HAS_THREADS
+		if(loader->num_threads) {
+			smol_thread_yield();
+			continue;
+		}
+#endif 
+
+		//No I/O threads, so what's left is processed here
+		if(!smol__file_loader_next_request(loader, &request, SMOL_FALSE))
+			break;
+		smol__file_loader_process(loader, &request);
+
+	}
+
+#ifdef SMOL_HAS_THREADS
+	for(int i = 0; i < loader->num_threads; i++)
+		smol_thread_join(loader->threads[i]);
+
+	smol_cond_destroy(&loader->cond);
+	smol_mutex_destroy(&loader->mutex);
+#endif 
+
+#ifdef SMOL__HAS_IO_URING
+	if(loader->ring) smol__io_uring_destroy(loader->ring);
+#endif 
+
+	while(smol_mpmc_queue_pop(&loader->completions, &completion)) {
+		if(completion.owns_buffer && completion.buffer) 
+			SMOL_FREE(completion.buffer);
+	}
+
+	smol_mpmc_queue_free(&loader->requests);
+	smol_mpmc_queue_free(&loader->completions);
+	SMOL_FREE(loader);
+
+}
+
+#pragma endregion
+
+
+#pragma region Memory mapped files
+
+//Clamps the range into the view, returns SMOL_FALSE if nothing is left of it.
+static int smol__file_view_range(const smol_file_view_t* view, smol_size_t* offset, smol_size_t* size) {
+
+	if(view->data == NULL || *offset >= view->size) 
+		return SMOL_FALSE;
+
+	if(*size == 0 || *size > view->size - *offset) 
+		*size = view->size - *offset;
+
+	return SMOL_TRUE;
+
+}
+
+#pragma endregion
+
+#pragma region Directory scanning
+
+//Upper limit for sub folders queued to the job system at once, beyond that they're scanned inline.
+//Keeps the number of open directory handles bounded on wide trees.
+#define SMOL__DIR_SCAN_MAX_PENDING 256
+
+typedef struct _smol__dir_scan_t {
+	const char* root_path;
+	int flags;
+	smol_dir_scan_proc callback;
+	void* user_data;
+	smol_job_counter_t counter;
+	volatile smol_size_t pending;
+#ifdef SMOL_HAS_THREADS
+	smol_mutex_t callback_mutex;
+#endif 
+} smol__dir_scan_t;
+
+//Entries are gathered into batches, paths are stored into the text block of the batch.
+typedef struct _smol__dir_batch_t {
+	int count;
+	int text_used;
+	smol_dir_entry_t entries[SMOL_DIR_SCAN_BATCH_SIZE];
+	char text[SMOL_DIR_SCAN_BATCH_SIZE * 64];
+} smol__dir_batch_t;
+
+typedef struct _smol__dir_job_t {
+	smol__dir_scan_t* scan;
+	int dir_fd;
+	int rel_length;
+	char* rel_path;
+} smol__dir_job_t;
+
+//These are implemented per platform, dir_fd is the opened folder on platforms that have openat, -1 elsewhere.
+//smol__dir_scan_folder takes the ownership of dir_fd, smol__dir_scan_release just closes it.
+static int smol__dir_scan_open_root(smol__dir_scan_t* scan, int* dir_fd);
+static void smol__dir_scan_folder(smol__dir_scan_t* scan, smol__dir_batch_t* batch, int dir_fd, const char* rel_path, int rel_length);
+static void smol__dir_scan_release(int dir_fd);
+
+//Copies a name into smol_file_info_t, truncating it if it doesn't fit.
+static void smol__file_info_set_name(smol_file_info_t* info, const char* name) {
+	size_t length = strlen(name);
+	if(length >= sizeof(info->file_path)) length = sizeof(info->file_path) - 1;
+	memcpy(info->file_path, name, length);
+	info->file_path[length] = '\0';
+}
+
+static void smol__dir_batch_flush(smol__dir_scan_t* scan, smol__dir_batch_t* batch) {
+
+	if(batch->count == 0) 
+		return;
+
+#ifdef SMOL_HAS_THREADS
+	smol_mutex_lock(&scan->callback_mutex);
+#endif 
+	scan->callback(batch->entries, batch->count, scan->user_data);
+#ifdef SMOL_HAS_THREADS
+	smol_mutex_unlock(&scan->callback_mutex);
+#endif 
+
+	batch->count = 0;
+	batch->text_used = 0;
+
+}
+
+static void smol__dir_batch_add(
+	smol__dir_scan_t* scan,
+	smol__dir_batch_t* batch,
+	const char* rel_path, int rel_length, 
+	const char* name, int name_length, 
+	smol_size_t size, long long mtime_ns, int is_folder
+) {
+
+	int length = rel_length + (rel_length ? 1 : 0) + name_length;
+
+	//Paths that don't fit even into an empty batch get truncated.
+	if(length >= (int)sizeof(batch->text)) 
+		length = (int)sizeof(batch->text) - 1;
+
+	if(batch->count == SMOL_DIR_SCAN_BATCH_SIZE || batch->text_used + length + 1 > (int)sizeof(batch->text)) 
+		smol__dir_batch_flush(scan, batch);
+
+	char* path = batch->text + batch->text_used;
+	int at = 0;
+
+	if(rel_length) {
+		memcpy(path, rel_path, rel_length < length ? rel_length : length);
+		at = rel_length < length ? rel_length : length;
+		if(at < length) path[at++] = '/';
+	}
+	if(at < length) 
+		memcpy(path + at, name, length - at);
+	path[length] = '\0';
+
+	smol_dir_entry_t* entry = &batch->entries[batch->count++];
+	entry->path = path;
+	entry->size = size;
+	entry->mtime_ns = mtime_ns;
+	entry->is_folder = is_folder;
+
+	batch->text_used += length + 1;
+
+}
+
+static void smol__dir_scan_job(void* user_data) {
+
+	smol__dir_job_t* job = (smol__dir_job_t*)user_data;
+	smol__dir_scan_t* scan = job->scan;
+	smol__dir_batch_t* batch = (smol__dir_batch_t*)SMOL_ALLOC(sizeof(smol__dir_batch_t));
+
+	if(batch) {
+		batch->count = 0;
+		batch->text_used = 0;
+		smol__dir_scan_folder(scan, batch, job->dir_fd, job->rel_path, job->rel_length);
+		smol__dir_batch_flush(scan, batch);
+		SMOL_FREE(batch);
+	} else {
+		smol__dir_scan_release(job->dir_fd);
+	}
+
+	smol_atomic_fetch_add(&scan->pending, (smol_size_t)-1);
+	SMOL_FREE(job);
+
+}
+
+//Hands a sub folder to an idle worker if the job system is running, otherwise scans it right away into the current batch.
+//The folder takes the ownership of dir_fd.
+static void smol__dir_scan_subfolder(
+	smol__dir_scan_t* scan, 
+	smol__dir_batch_t* batch, 
+	int dir_fd,
+	const char* rel_path, int rel_length,
+	const char* name, int name_length
+) {
+
+	int length = rel_length + (rel_length ? 1 : 0) + name_length;
+	smol__dir_job_t* job = (smol__dir_job_t*)SMOL_ALLOC(sizeof(smol__dir_job_t) + length + 1);
+
+	if(job == NULL) {
+		smol__dir_scan_release(dir_fd);
+		return;
+	}
+
+	job->scan = scan;
+	job->dir_fd = dir_fd;
+	job->rel_length = length;
+	job->rel_path = (char*)(job + 1);
+
+	if(rel_length) {
+		memcpy(job->rel_path, rel_path, rel_length);
+		job->rel_path[rel_length] = '/';
+		memcpy(job->rel_path + rel_length + 1, name, name_length);
+	} else {
+		memcpy(job->rel_path, name, name_length);
+	}
+	job->rel_path[length] = '\0';
+
+	if(
+		smol__job_system.workers && 
+		smol__job_system.num_workers > 1 && 
+		smol__job_worker_index >= 0 &&
+		smol_atomic_load(&scan->pending) < SMOL__DIR_SCAN_MAX_PENDING
+	) {
+		smol_atomic_fetch_add(&scan->pending, 1);
+		smol_job_submit(&smol__dir_scan_job, job, &scan->counter);
+		return;
+	}
+
+	smol__dir_scan_folder(scan, batch, job->dir_fd, job->rel_path, job->rel_length);
+	SMOL_FREE(job);
+
+}
+
+int smol_scan_directory(const char* root_path, int flags, smol_dir_scan_proc callback, void* user_data) {
+
+	smol__dir_scan_t scan;
+	int dir_fd = -1;
+
+	memset(&scan, 0, sizeof(scan));
+	scan.root_path = root_path;
+	scan.flags = flags;
+	scan.callback = callback;
+	scan.user_data = user_data;
+
+	if(!smol__dir_scan_open_root(&scan, &dir_fd)) 
+		return SMOL_FALSE;
+
+	smol__dir_batch_t* batch = (smol__dir_batch_t*)SMOL_ALLOC(sizeof(smol__dir_batch_t));
+	if(batch == NULL) {
+		smol__dir_scan_release(dir_fd);
+		return SMOL_FALSE;
+	}
+
+	batch->count = 0;
+	batch->text_used = 0;
+
+#ifdef SMOL_HAS_THREADS
+	smol_mutex_init(&scan.callback_mutex);
+#endif 
+
+	smol__dir_scan_folder(&scan, batch, dir_fd, "", 0);
+	smol__dir_batch_flush(&scan, batch);
+	smol_job_wait(&scan.counter);
+
+#ifdef SMOL_HAS_THREADS
+	smol_mutex_destroy(&scan.callback_mutex);
+#endif 
+
+	SMOL_FREE(batch);
+
+	return SMOL_TRUE;
+
+}
+
+#pragma endregion
+
+#pragma region Hashing
+
+#define SMOL__XXH_PRIME1 0x9E3779B185EBCA87ULL
+#define SMOL__XXH_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define SMOL__XXH_PRIME3 0x165667B19E3779F9ULL
+#define SMOL__XXH_PRIME4 0x85EBCA77C2B2AE63ULL
+#define SMOL__XXH_PRIME5 0x27D4EB2F165667C5ULL
+
+#define smol__rotl64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+SMOL_INLINE unsigned long long smol__xxh64_round(unsigned long long acc, unsigned long long input) {
+	acc += input * SMOL__XXH_PRIME2;
+	acc = smol__rotl64(acc, 31);
+	return acc * SMOL__XXH_PRIME1;
+}
+
+SMOL_INLINE unsigned long long smol__xxh64_merge(unsigned long long acc, unsigned long long value) {
+	acc ^= smol__xxh64_round(0, value);
+	return acc * SMOL__XXH_PRIME1 + SMOL__XXH_PRIME4;
+}
+
+//Unaligned little endian reads, compilers turn the memcpy into a single load.
+SMOL_INLINE unsigned long long smol__read_u64(const unsigned char* ptr) {
+	unsigned long long value;
+	memcpy(&value, ptr, sizeof(value));
+	return value;
+}
+
+SMOL_INLINE unsigned int smol__read_u32(const unsigned char* ptr) {
+	unsigned int value;
+	memcpy(&value, ptr, sizeof(value));
+	return value;
+}
+
+unsigned long long smol_hash64(const void* data, smol_size_t size, unsigned long long seed) {
+
+	const unsigned char* ptr = (const unsigned char*)data;
+	const unsigned char* end = ptr + size;
+	unsigned long long hash;
+
+	if(size >= 32) {
+
+		unsigned long long v1 = seed + SMOL__XXH_PRIME1 + SMOL__XXH_PRIME2;
+		unsigned long long v2 = seed + SMOL__XXH_PRIME2;
+		unsigned long long v3 = seed;
+		unsigned long long v4 = seed - SMOL__XXH_PRIME1;
+		const unsigned char* limit = end - 32;
+
+		do {
+			v1 = smol__xxh64_round(v1, smol__read_u64(ptr));
+			v2 = smol__xxh64_round(v2, smol__read_u64(ptr + 8));
+			v3 = smol__xxh64_round(v3, smol__read_u64(ptr + 16));
+			v4 = smol__xxh64_round(v4, smol__read_u64(ptr + 24));
+			ptr += 32;
+		} while(ptr <= limit);
+
+		hash = smol__rotl64(v1, 1) + smol__rotl64(v2, 7) + smol__rotl64(v3, 12) + smol__rotl64(v4, 18);
+		hash = smol__xxh64_merge(hash, v1);
+		hash = smol__xxh64_merge(hash, v2);
+		hash = smol__xxh64_merge(hash, v3);
+		hash = smol__xxh64_merge(hash, v4);
+
+	} else {
+		hash = seed + SMOL__XXH_PRIME5;
+	}
+
+	hash += (unsigned long long)size;
+
+	for(; ptr + 8 <= end; ptr += 8) {
+		hash ^= smol__xxh64_round(0, smol__read_u64(ptr));
+		hash = smol__rotl64(hash, 27) * SMOL__XXH_PRIME1 + SMOL__XXH_PRIME4;
+	}
+
+	if(ptr + 4 <= end) {
+		hash ^= (unsigned long long)smol__read_u32(ptr) * SMOL__XXH_PRIME1;
+		hash = smol__rotl64(hash, 23) * SMOL__XXH_PRIME2 + SMOL__XXH_PRIME3;
+		ptr += 4;
+	}
+
+	for(; ptr < end; ptr++) {
+		hash ^= (*ptr) * SMOL__XXH_PRIME5;
+		hash = smol__rotl64(hash, 11) * SMOL__XXH_PRIME1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= SMOL__XXH_PRIME2;
+	hash ^= hash >> 29;
+	hash *= SMOL__XXH_PRIME3;
+	hash ^= hash >> 32;
+
+	return hash;
+
+}
+
+#pragma endregion
+
+#pragma region Asset manifest
+
+typedef struct _smol__manifest_header_t {
+	char magic[4];
+	unsigned int version;
+	unsigned int entry_size;
+	unsigned int count;
+	unsigned long long paths_size;
+	unsigned long long reserved;
+} smol__manifest_header_t;
+
+typedef struct _smol__manifest_build_t {
+	smol_vector(smol_manifest_entry_t) entries;
+	smol_vector(char) paths;
+	smol_vector(int) dirty;
+	const smol_manifest_t* previous;
+	const char* root_path;
+	int failed;
+} smol__manifest_build_t;
+
+int smol_manifest_load(smol_manifest_t* manifest, const char* manifest_path) {
+
+	memset(manifest, 0, sizeof(*manifest));
+
+	if(!smol_map_file(manifest_path, &manifest->view)) 
+		return SMOL_FALSE;
+
+	const smol__manifest_header_t* header = (const smol__manifest_header_t*)manifest->view.data;
+	smol_size_t size = manifest->view.size;
+
+	if(
+		size < sizeof(smol__manifest_header_t) ||
+		memcmp(header->magic, "SMAF", 4) != 0 ||
+		header->version != SMOL_MANIFEST_VERSION ||
+		header->entry_size != sizeof(smol_manifest_entry_t) ||
+		(size - sizeof(smol__manifest_header_t)) / sizeof(smol_manifest_entry_t) < header->count ||
+		size - sizeof(smol__manifest_header_t) - header->count * sizeof(smol_manifest_entry_t) != header->paths_size
+	) {
+		smol_manifest_free(manifest);
+		return SMOL_FALSE;
+	}
+
+	const smol_manifest_entry_t* entries = (const smol_manifest_entry_t*)(header + 1);
+	const char* paths = (const char*)(entries + header->count);
+
+	//Every path has to be inside the file and terminated, as they're handed out as C strings.
+	for(unsigned int i = 0; i < header->count; i++) {
+		if(
+			(unsigned long long)entries[i].path_offset + entries[i].path_length >= header->paths_size || 
+			paths[entries[i].path_offset + entries[i].path_length] != '\0'
+		) {
+			smol_manifest_free(manifest);
+			return SMOL_FALSE;
+		}
+	}
+
+	manifest->entries = entries;
+	manifest->paths = paths;
+	manifest->count = (int)header->count;
+
+	return SMOL_TRUE;
+
+}
+
+void smol_manifest_free(smol_manifest_t* manifest) {
+	if(manifest->view.data) 
+		smol_unmap_file(&manifest->view);
+	memset(manifest, 0, sizeof(*manifest));
+}
+
+const char* smol_manifest_entry_path(const smol_manifest_t* manifest, const smol_manifest_entry_t* entry) {
+	return manifest->paths + entry->path_offset;
+}
+
+static const smol_manifest_entry_t* smol__manifest_search(
+	const smol_manifest_entry_t* entries, int count, const char* paths, 
+	const char* path, int length, unsigned long long path_hash
+) {
+
+	int first = 0, last = count;
+
+	while(first < last) {
+		int middle = first + (last - first) / 2;
+		if(entries[middle].path_hash < path_hash) first = middle + 1;
+		else last = middle;
+	}
+
+	for(; first < count && entries[first].path_hash == path_hash; first++) {
+		if((int)entries[first].path_length == length && memcmp(paths + entries[first].path_offset, path, length) == 0) 
+			return &entries[first];
+	}
+
+	return NULL;
+
+}
+
+const smol_manifest_entry_t* smol_manifest_find(const smol_manifest_t* manifest, const char* path) {
+
+	if(manifest->count == 0) 
+		return NULL;
+
+	int length = (int)strlen(path);
+
+	return smol__manifest_search(manifest->entries, manifest->count, manifest->paths, path, length, smol_hash64(path, length, 0));
+
+}
+
+//Batches are handed out one at a time, so no locking is needed here.
+static void smol__manifest_scan_proc(const smol_dir_entry_t* entries, int count, void* user_data) {
+
+	smol__manifest_build_t* build = (smol__manifest_build_t*)user_data;
+
+	for(int i = 0; i < count && !build->failed; i++) {
+
+		if(entries[i].is_folder) 
+			continue;
+
+		smol_manifest_entry_t entry;
+		int length = (int)strlen(entries[i].path);
+		int offset = build->paths.count;
+
+		entry.path_hash = smol_hash64(entries[i].path, length, 0);
+		entry.size = entries[i].size;
+		entry.mtime_ns = entries[i].mtime_ns;
+		entry.content_hash = 0;
+		entry.path_offset = (unsigned int)offset;
+		entry.path_length = (unsigned int)length;
+
+		const smol_manifest_entry_t* old = NULL;
+		if(build->previous->count) 
+			old = smol__manifest_search(build->previous->entries, build->previous->count, build->previous->paths, entries[i].path, length, entry.path_hash);
+
+		if(old && old->size == entry.size && old->mtime_ns == entry.mtime_ns) 
+			entry.content_hash = old->content_hash;
+		else 
+			smol_vector_push(&build->dirty, build->entries.count);
+
+		int paths_size = offset + length + 1;
+		smol_vector_resize(&build->paths, paths_size);
+		if(build->paths.data == NULL) {
+			build->failed = SMOL_TRUE;
+			return;
+		}
+
+		memcpy(build->paths.data + offset, entries[i].path, length + 1);
+		smol_vector_push(&build->entries, entry);
+
+	}
+
+}
+
+static void smol__manifest_hash_proc(int first, int last, void* user_data) {
+
+	smol__manifest_build_t* build = (smol__manifest_build_t*)user_data;
+	int root_length = (int)strlen(build->root_path);
+	char* path = NULL;
+	int path_allocation = 0;
+
+	for(int i = first; i < last; i++) {
+
+		smol_manifest_entry_t* entry = &build->entries.data[build->dirty.data[i]];
+		int length = root_length + 1 + (int)entry->path_length + 1;
+
+		if(length > path_allocation) {
+			SMOL_FREE(path);
+			path_allocation = length * 2;
+			if((path = (char*)SMOL_ALLOC(path_allocation)) == NULL) 
+				return;
+		}
+
+		memcpy(path, build->root_path, root_length);
+		path[root_length] = '/';
+		memcpy(path + root_length + 1, build->paths.data + entry->path_offset, entry->path_length + 1);
+
+		smol_file_view_t view;
+		if(smol_map_file(path, &view)) {
+			smol_file_view_advise(&view, 0, 0, SMOL_FILE_VIEW_HINT_SEQUENTIAL);
+			entry->content_hash = smol_hash64(view.data, view.size, 0);
+			smol_unmap_file(&view);
+		}
+
+	}
+
+	SMOL_FREE(path);
+
+}
+
+static int smol__manifest_compare(const void* a, const void* b, void* user_data) {
+
+	const smol_manifest_entry_t* lhs = (const smol_manifest_entry_t*)a;
+	const smol_manifest_entry_t* rhs = (const smol_manifest_entry_t*)b;
+
+	if(lhs->path_hash != rhs->path_hash) 
+		return lhs->path_hash < rhs->path_hash ? -1 : 1;
+
+	return strcmp((const char*)user_data + lhs->path_offset, (const char*)user_data + rhs->path_offset);
+
+}
+
+static int smol__manifest_write(const char* manifest_path, const smol__manifest_build_t* build) {
+
+	smol__manifest_header_t header;
+	int length = (int)strlen(manifest_path);
+	char* temp_path = (char*)SMOL_ALLOC(length + 5);
+
+	if(temp_path == NULL) 
+		return SMOL_FALSE;
+
+	memcpy(temp_path, manifest_path, length);
+	memcpy(temp_path + length, ".tmp", 5);
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "SMAF", 4);
+	header.version = SMOL_MANIFEST_VERSION;
+	header.entry_size = sizeof(smol_manifest_entry_t);
+	header.count = (unsigned int)build->entries.count;
+	header.paths_size = (unsigned long long)build->paths.count;
+
+	//Written next to the old one and renamed over it, so a crash never leaves a half written manifest behind.
+	FILE* file = fopen(temp_path, "wb");
+	int success = file != NULL;
+
+	if(file) {
+		success &= fwrite(&header, sizeof(header), 1, file) == 1;
+		if(build->entries.count)
+			success &= fwrite(build->entries.data, sizeof(smol_manifest_entry_t), build->entries.count, file) == (size_t)build->entries.count;
+		if(build->paths.count) 
+			success &= fwrite(build->paths.data, 1, build->paths.count, file) == (size_t)build->paths.count;
+		success &= fclose(file) == 0;
+	}
+
+	//The old manifest is replaced in one step, so it's never missing if the process dies here. 
+#ifdef SMOL_PLATFORM_WINDOWS
+	if(success) 
+		success = MoveFileExA(temp_path, manifest_path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else 
+	if(success) 
+		success = rename(temp_path, manifest_path) == 0;
+#endif 
+
+	if(!success && file) 
+		remove(temp_path);
+
+	SMOL_FREE(temp_path);
+
+	return success;
+
+}
+
+int smol_manifest_update(smol_manifest_t* manifest, const char* manifest_path, const char* root_path, smol_manifest_change_proc callback, void* user_data) {
+
+	smol__manifest_build_t build;
+	int num_changes = 0;
+
+	build.previous = manifest;
+	build.root_path = root_path;
+	build.failed = SMOL_FALSE;
+	smol_vector_init(&build.entries, 256);
+	smol_vector_init(&build.paths, 4096);
+	smol_vector_init(&build.dirty, 256);
+
+	if(!smol_scan_directory(root_path, SMOL_DIR_SCAN_DEFAULT, &smol__manifest_scan_proc, &build) || build.failed) {
+		SMOL_FREE(build.entries.data);
+		SMOL_FREE(build.paths.data);
+		SMOL_FREE(build.dirty.data);
+		return -1;
+	}
+
+	smol_parallel_for(0, build.dirty.count, 16, &smol__manifest_hash_proc, &build);
+	smol_sort(build.entries.data, build.entries.count, sizeof(smol_manifest_entry_t), &smol__manifest_compare, build.paths.data);
+
+	for(int i = 0; i < build.entries.count; i++) {
+
+		const smol_manifest_entry_t* entry = &build.entries.data[i];
+		const char* path = build.paths.data + entry->path_offset;
+		const smol_manifest_entry_t* old = NULL;
+
+		if(manifest->count) 
+			old = smol__manifest_search(manifest->entries, manifest->count, manifest->paths, path, entry->path_length, entry->path_hash);
+
+		//A touched file with the same contents isn't a change.
+		if(old && old->content_hash == entry->content_hash && old->size == entry->size) 
+			continue;
+
+		if(callback) 
+			callback(path, entry, old ? SMOL_MANIFEST_CHANGED : SMOL_MANIFEST_ADDED, user_data);
+		num_changes++;
+
+	}
+
+	for(int i = 0; i < manifest->count; i++) {
+
+		const smol_manifest_entry_t* old = &manifest->entries[i];
+		const char* path = manifest->paths + old->path_offset;
+
+		if(smol__manifest_search(build.entries.data, build.entries.count, build.paths.data, path, old->path_length, old->path_hash)) 
+			continue;
+
+		if(callback) 
+			callback(path, old, SMOL_MANIFEST_REMOVED, user_data);
+		num_changes++;
+
+	}
+
+	//The old mapping has to go before the file can be replaced on Windows.
+	smol_manifest_free(manifest);
+
+	if(!smol__manifest_write(manifest_path, &build) || !smol_manifest_load(manifest, manifest_path)) 
+		num_changes = -1;
+
+	SMOL_FREE(build.entries.data);
+	SMOL_FREE(build.paths.data);
+	SMOL_FREE(build.dirty.data);
+
+	return num_changes;
+
+}
+
+int smol_asset_cache_path(char* buffer, int buffer_size, const char* cache_folder, unsigned long long content_hash, const char* extension) {
+
+	int length = snprintf(buffer, buffer_size, "%s/%016llx%s", cache_folder, content_hash, extension ? extension : "");
+
+	return length >= 0 && length < buffer_size;
+
+}
+
+#pragma endregion
+
+#pragma region Random number generators
+
+SMOL_INLINE unsigned long long smol__splitmix64(unsigned long long* state) {
+	unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+//Turns the top 23 bits into a float between [0..1)
+SMOL_INLINE float smol__u32_to_unit_float(unsigned int value) {
+	unsigned int bits = 0x3F800000U | (value >> 9);
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result - 1.f;
+}
+
+//https://prng.di.unimi.it/xoshiro256starstar.c
+void smol_xoshiro256_seed(smol_xoshiro256_t* rng, unsigned long long seed) {
+	for(int i = 0; i < 4; i++) 
+		rng->s[i] = smol__splitmix64(&seed);
+}
+
+unsigned long long smol_xoshiro256_next(smol_xoshiro256_t* rng) {
+
+	unsigned long long* s = rng->s;
+	unsigned long long result = smol__rotl64(s[1] * 5, 7) * 9;
+	unsigned long long t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = smol__rotl64(s[3], 45);
+
+	return result;
+
+}
+
+static void smol__xoshiro256_jump(smol_xoshiro256_t* rng, const unsigned long long polynomial[4]) {
+
+	unsigned long long s[4] = { 0, 0, 0, 0 };
+
+	for(int i = 0; i < 4; i++) {
+		for(int b = 0; b < 64; b++) {
+			if(polynomial[i] & (1ULL << b)) {
+				s[0] ^= rng->s[0];
+				s[1] ^= rng->s[1];
+				s[2] ^= rng->s[2];
+				s[3] ^= rng->s[3];
+			}
+			smol_xoshiro256_next(rng);
+		}
+	}
+
+	memcpy(rng->s, s, sizeof(s));
+
+}
+
+void smol_xoshiro256_jump(smol_xoshiro256_t* rng) {
+	static const unsigned long long jump[4] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+	smol__xoshiro256_jump(rng, jump);
+}
+
+void smol_xoshiro256_long_jump(smol_xoshiro256_t* rng) {
+	static const unsigned long long jump[4] = { 0x76E15D3EFEFDCBBFULL, 0xC5004E441C522FB3ULL, 0x77710069854EE241ULL, 0x39109BB02ACBE635ULL };
+	smol__xoshiro256_jump(rng, jump);
+}
+
+//Lemire's multiply and reject, the retry happens very rarely: https://arxiv.org/abs/1805.10941
+#define SMOL__BOUNDED_RANDOM(next_u32, bound) { \
+	unsigned long long product = (unsigned long long)(next_u32) * (bound); \
+	unsigned int low = (unsigned int)product; \
+	if(low < (bound)) { \
+		unsigned int threshold = (0U - (bound)) % (bound); \
+		while(low < threshold) { \
+			product = (unsigned long long)(next_u32) * (bound); \
+			low = (unsigned int)product; \
+		} \
+	} \
+	return (unsigned int)(product >> 32); \
+}
+
+unsigned int smol_xoshiro256_bounded(smol_xoshiro256_t* rng, unsigned int bound) {
+	SMOL__BOUNDED_RANDOM((unsigned int)(smol_xoshiro256_next(rng) >> 32), bound);
+}
+
+float smol_xoshiro256_float(smol_xoshiro256_t* rng) {
+	return smol__u32_to_unit_float((unsigned int)(smol_xoshiro256_next(rng) >> 32));
+}
+
+//https://www.pcg-random.org/download.html
+#define SMOL__PCG32_MULTIPLIER 6364136223846793005ULL
+
+void smol_pcg32_seed(smol_pcg32_t* rng, unsigned long long seed, unsigned long long stream) {
+	rng->state = 0;
+	rng->inc = (stream << 1) | 1;
+	smol_pcg32_next(rng);
+	rng->state += seed;
+	smol_pcg32_next(rng);
+}
+
+unsigned int smol_pcg32_next(smol_pcg32_t* rng) {
+	unsigned long long old_state = rng->state;
+	rng->state = old_state * SMOL__PCG32_MULTIPLIER + rng->inc;
+	unsigned int xor_shifted = (unsigned int)(((old_state >> 18) ^ old_state) >> 27);
+	unsigned int rotation = (unsigned int)(old_state >> 59);
+	return (xor_shifted >> rotation) | (xor_shifted << ((0U - rotation) & 31));
+}
+
+void smol_pcg32_advance(smol_pcg32_t* rng, unsigned long long delta) {
+
+	unsigned long long multiplier = SMOL__PCG32_MULTIPLIER, increment = rng->inc;
+	unsigned long long total_multiplier = 1, total_increment = 0;
+
+	while(delta) {
+		if(delta & 1) {
+			total_multiplier *= multiplier;
+			total_increment = total_increment * multiplier + increment;
+		}
+		increment = (multiplier + 1) * increment;
+		multiplier *= multiplier;
+		delta >>= 1;
+	}
+
+	rng->state = total_multiplier * rng->state + total_increment;
+
+}
+
+unsigned int smol_pcg32_bounded(smol_pcg32_t* rng, unsigned int bound) {
+	SMOL__BOUNDED_RANDOM(smol_pcg32_next(rng), bound);
+}
+
+float smol_pcg32_float(smol_pcg32_t* rng) {
+	return smol__u32_to_unit_float(smol_pcg32_next(rng));
+}
+
+//Splitmix64 expansion of the seed 0, so the global generator works before smol_randomize is called.
+static smol_xoshiro256_t smol__rand_state = { { 0xE220A8397B1DCDAFULL, 0x6E789E6AA1B965F4ULL, 0x06C45D188009454FULL, 0xF88BB8A8724C81ECULL } };
+
+//Below this many values the SIMD lane setup isn't worth it.
+#define SMOL__RAND_FILL_MIN_SIMD 64
+
+#if defined(SMOL__HAS_SSE2)
+#	define SMOL__ROTL64_X2(x, k) _mm_or_si128(_mm_slli_epi64(x, k), _mm_srli_epi64(x, 64 - (k)))
+#	define SMOL__XOSHIRO_X2_STEP(s0, s1, s2, s3, out) { \
+		__m128i times5 = _mm_add_epi64(_mm_slli_epi64(s1, 2), s1); \
+		__m128i rotated = SMOL__ROTL64_X2(times5, 7); \
+		out = _mm_add_epi64(_mm_slli_epi64(rotated, 3), rotated); \
+		__m128i t = _mm_slli_epi64(s1, 17); \
+		s2 = _mm_xor_si128(s2, s0); \
+		s3 = _mm_xor_si128(s3, s1); \
+		s1 = _mm_xor_si128(s1, s2); \
+		s0 = _mm_xor_si128(s0, s3); \
+		s2 = _mm_xor_si128(s2, t); \
+		s3 = SMOL__ROTL64_X2(s3, 45); \
+	}
+#elif defined(SMOL__HAS_NEON)
+#	define SMOL__ROTL64_X2(x, k) vorrq_u64(vshlq_n_u64(x, k), vshrq_n_u64(x, 64 - (k)))
+#	define SMOL__XOSHIRO_X2_STEP(s0, s1, s2, s3, out) { \
+		uint64x2_t times5 = vaddq_u64(vshlq_n_u64(s1, 2), s1); \
+		uint64x2_t rotated = SMOL__ROTL64_X2(times5, 7); \
+		out = vaddq_u64(vshlq_n_u64(rotated, 3), rotated); \
+		uint64x2_t t = vshlq_n_u64(s1, 17); \
+		s2 = veorq_u64(s2, s0); \
+		s3 = veorq_u64(s3, s1); \
+		s1 = veorq_u64(s1, s2); \
+		s0 = veorq_u64(s0, s3); \
+		s2 = veorq_u64(s2, t); \
+		s3 = SMOL__ROTL64_X2(s3, 45); \
+	}
+#endif 
+
+//Runs 4 xoshiro256** generators side by side (two per vector register), each seeded off the main generator.
+static void smol__xoshiro256_fill_x4(smol_xoshiro256_t* rng, unsigned int* values, smol_size_t count) {
+
+	unsigned long long lanes[4][4];
+	smol_size_t i = 0;
+
+	for(int lane = 0; lane < 4; lane++) {
+		unsigned long long seed = smol_xoshiro256_next(rng);
+		for(int j = 0; j < 4; j++) 
+			lanes[j][lane] = smol__splitmix64(&seed);
+	}
+
+#if defined(SMOL__HAS_SSE2)
+	__m128i a0 = _mm_loadu_si128((const __m128i*)&lanes[0][0]), b0 = _mm_loadu_si128((const __m128i*)&lanes[0][2]);
+	__m128i a1 = _mm_loadu_si128((const __m128i*)&lanes[1][0]), b1 = _mm_loadu_si128((const __m128i*)&lanes[1][2]);
+	__m128i a2 = _mm_loadu_si128((const __m128i*)&lanes[2][0]), b2 = _mm_loadu_si128((const __m128i*)&lanes[2][2]);
+	__m128i a3 = _mm_loadu_si128((const __m128i*)&lanes[3][0]), b3 = _mm_loadu_si128((const __m128i*)&lanes[3][2]);
+	__m128i out_a, out_b;
+
+	for(; i + 8 <= count; i += 8) {
+		SMOL__XOSHIRO_X2_STEP(a0, a1, a2, a3, out_a);
+		SMOL__XOSHIRO_X2_STEP(b0, b1, b2, b3, out_b);
+		_mm_storeu_si128((__m128i*)(values + i), out_a);
+		_mm_storeu_si128((__m128i*)(values + i + 4), out_b);
+	}
+
+	_mm_storeu_si128((__m128i*)&lanes[0][0], a0); _mm_storeu_si128((__m128i*)&lanes[0][2], b0);
+	_mm_storeu_si128((__m128i*)&lanes[1][0], a1); _mm_storeu_si128((__m128i*)&lanes[1][2], b1);
+	_mm_storeu_si128((__m128i*)&lanes[2][0], a2); _mm_storeu_si128((__m128i*)&lanes[2][2], b2);
+	_mm_storeu_si128((__m128i*)&lanes[3][0], a3); _mm_storeu_si128((__m128i*)&lanes[3][2], b3);
+#elif defined(SMOL__HAS_NEON)
+	uint64x2_t a0 = vld1q_u64(&lanes[0][0]), b0 = vld1q_u64(&lanes[0][2]);
+	uint64x2_t a1 = vld1q_u64(&lanes[1][0]), b1 = vld1q_u64(&lanes[1][2]);
+	uint64x2_t a2 = vld1q_u64(&lanes[2][0]), b2 = vld1q_u64(&lanes[2][2]);
+	uint64x2_t a3 = vld1q_u64(&lanes[3][0]), b3 = vld1q_u64(&lanes[3][2]);
+	uint64x2_t out_a, out_b;
+
+	for(; i + 8 <= count; i += 8) {
+		SMOL__XOSHIRO_X2_STEP(a0, a1, a2, a3, out_a);
+		SMOL__XOSHIRO_X2_STEP(b0, b1, b2, b3, out_b);
+		vst1q_u32(values + i, vreinterpretq_u32_u64(out_a));
+		vst1q_u32(values + i + 4, vreinterpretq_u32_u64(out_b));
+	}
+
+	vst1q_u64(&lanes[0][0], a0); vst1q_u64(&lanes[0][2], b0);
+	vst1q_u64(&lanes[1][0], a1); vst1q_u64(&lanes[1][2], b1);
+	vst1q_u64(&lanes[2][0], a2); vst1q_u64(&lanes[2][2], b2);
+	vst1q_u64(&lanes[3][0], a3); vst1q_u64(&lanes[3][2], b3);
+#else 
+	//Independent lanes, so the compiler can vectorize or at least interleave them.
+	for(; i + 8 <= count; i += 8) {
+		unsigned long long out[4];
+		for(int lane = 0; lane < 4; lane++) {
+			out[lane] = smol__rotl64(lanes[1][lane] * 5, 7) * 9;
+			unsigned long long t = lanes[1][lane] << 17;
+			lanes[2][lane] ^= lanes[0][lane];
+			lanes[3][lane] ^= lanes[1][lane];
+			lanes[1][lane] ^= lanes[2][lane];
+			lanes[0][lane] ^= lanes[3][lane];
+			lanes[2][lane] ^= t;
+			lanes[3][lane] = smol__rotl64(lanes[3][lane], 45);
+		}
+		memcpy(values + i, out, sizeof(out));
+	}
+#endif 
+
+	if(i < count) {
+		smol_xoshiro256_t tail;
+		for(int j = 0; j < 4; j++) 
+			tail.s[j] = lanes[j][0];
+		for(; i < count; i++) 
+			values[i] = (unsigned int)(smol_xoshiro256_next(&tail) >> 32);
+	}
+
+}
+
+void smol_rand_fill_u32(smol_xoshiro256_t* rng, unsigned int* values, smol_size_t count) {
+
+	if(rng == NULL) 
+		rng = &smol__rand_state;
+
+	if(count >= SMOL__RAND_FILL_MIN_SIMD) {
+		smol__xoshiro256_fill_x4(rng, values, count);
+		return;
+	}
+
+	for(smol_size_t i = 0; i < count; i++) 
+		values[i] = (unsigned int)(smol_xoshiro256_next(rng) >> 32);
+
+}
+
+//Converts the random bits in place into floats, with the same exponent trick as smol__u32_to_unit_float.
+static void smol__rand_bits_to_f32(float* values, smol_size_t count, float minimum, float range) {
+
+	smol_size_t i = 0;
+
+#if defined(SMOL__HAS_SSE2)
+	const __m128i one_bits = _mm_set1_epi32(0x3F800000);
+	const __m128 one = _mm_set1_ps(1.f), scale = _mm_set1_ps(range), offset = _mm_set1_ps(minimum);
+	for(; i + 4 <= count; i += 4) {
+		__m128i bits = _mm_or_si128(_mm_srli_epi32(_mm_loadu_si128((const __m128i*)(values + i)), 9), one_bits);
+		__m128 unit = _mm_sub_ps(_mm_castsi128_ps(bits), one);
+		_mm_storeu_ps(values + i, _mm_add_ps(_mm_mul_ps(unit, scale), offset));
+	}
+#elif defined(SMOL__HAS_NEON)
+	const uint32x4_t one_bits = vdupq_n_u32(0x3F800000);
+	const float32x4_t one = vdupq_n_f32(1.f), scale = vdupq_n_f32(range), offset = vdupq_n_f32(minimum);
+	for(; i + 4 <= count; i += 4) {
+		uint32x4_t bits = vorrq_u32(vshrq_n_u32(vld1q_u32((const unsigned int*)(values + i)), 9), one_bits);
+		float32x4_t unit = vsubq_f32(vreinterpretq_f32_u32(bits), one);
+		vst1q_f32(values + i, vmlaq_f32(offset, unit, scale));
+	}
+#endif 
+
+	for(; i < count; i++) {
+		unsigned int bits;
+		memcpy(&bits, values + i, sizeof(bits));
+		values[i] = minimum + smol__u32_to_unit_float(bits) * range;
+	}
+
+}
+
+void smol_rand_fill_f32(smol_xoshiro256_t* rng, float* values, smol_size_t count, float minimum, float maximum) {
+
+	//Done in blocks, so the bits are still in the cache when they're converted.
+	for(smol_size_t i = 0; i < count; i += 2048) {
+		smol_size_t block = count - i < 2048 ? count - i : 2048;
+		smol_rand_fill_u32(rng, (unsigned int*)(values + i), block);
+		smol__rand_bits_to_f32(values + i, block, minimum, maximum - minimum);
+	}
+
+}
+
+void smol_randomize(unsigned int seed) {
+	smol_xoshiro256_seed(&smol__rand_state, seed);
+}
+
+unsigned int smol_rand() {
+	return (unsigned int)(smol_xoshiro256_next(&smol__rand_state) >> 33);
+}
+
+float smol_randf() {
+	return smol_xoshiro256_float(&smol__rand_state);
+}
+
+int smol_rnd(int minimum, int maximum) {
+	if(maximum <= minimum) 
+		return minimum;
+	return minimum + (int)smol_xoshiro256_bounded(&smol__rand_state, (unsigned int)(maximum - minimum));
+}
+
+float smol_rndf(float minimum, float maximum) {
+	return minimum + smol_randf() * (maximum - minimum);
+}
+
+#pragma endregion
+
+#if defined(SMOL_PLATFORM_WINDOWS)
+
+//A nasty global :|
+double smol__perf_freq;
+
+double smol_timer(void) {
+
+	if(smol__perf_freq == 0.0) {
+		LARGE_INTEGER freq;
+		if(QueryPerformanceFrequency(&freq) == TRUE) {
+			smol__perf_freq = 1.0 / (double)freq.QuadPart;
+		} else {
+			SMOL_ASSERT(!"Failed to query perfomance frequency!");
+			return 0.;
+		}
+	}
+
+	LARGE_INTEGER ctr = {0};
+	SMOL_ASSERT("Failed to query performance counter!" && QueryPerformanceCounter(&ctr));
+
+	return (double)ctr.QuadPart * smol__perf_freq;
+
+}
+
+typedef struct _smol__thread_start_t {
+	smol_thread_proc proc;
+	void* user_data;
+} smol__thread_start_t;
+
+static DWORD WINAPI smol__thread_entry(LPVOID param) {
+	smol__thread_start_t start = *(smol__thread_start_t*)param;
+	SMOL_FREE(param);
+	start.proc(start.user_data);
+	return 0;
+}
+
+int smol_thread_create(smol_thread_t* thread, smol_thread_proc proc, void* user_data) {
+	smol__thread_start_t* start = (smol__thread_start_t*)SMOL_ALLOC(sizeof(smol__thread_start_t));
+	start->proc = proc;
+	start->user_data = user_data;
+	*thread = CreateThread(NULL, 0, &smol__thread_entry, start, 0, NULL);
+	if(*thread == NULL) {
+		SMOL_FREE(start);
+		return SMOL_FALSE;
+	}
+	return SMOL_TRUE;
+}
+
+void smol_thread_join(smol_thread_t thread) {
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+}
+
+void smol_thread_yield(void) {
+	SwitchToThread();
+}
+
+void smol_mutex_init(smol_mutex_t* mutex) { InitializeCriticalSection(mutex); }
+void smol_mutex_destroy(smol_mutex_t* mutex) { DeleteCriticalSection(mutex); }
+void smol_mutex_lock(smol_mutex_t* mutex) { EnterCriticalSection(mutex); }
+void smol_mutex_unlock(smol_mutex_t* mutex) { LeaveCriticalSection(mutex); }
+
+void smol_cond_init(smol_cond_t* cond) { InitializeConditionVariable(cond); }
+void smol_cond_destroy(smol_cond_t* cond) { (void)cond; }
+void smol_cond_wait(smol_cond_t* cond, smol_mutex_t* mutex) { SleepConditionVariableCS(cond, mutex, INFINITE); }
+void smol_cond_signal(smol_cond_t* cond) { WakeConditionVariable(cond); }
+void smol_cond_broadcast(smol_cond_t* cond) { WakeAllConditionVariable(cond); }
+
+int smol_get_num_cpus(void) {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+}
+
+static int smol__file_op_open(smol__file_op_t* op, const smol_file_request_t* request) {
+
+	op->completion.file_path = request->file_path;
+	op->completion.user_data = request->user_data;
+
+#	ifdef UNICODE
+	wchar_t path[512] = { 0 };
+	MultiByteToWideChar(CP_UTF8, MB_COMPOSITE, request->file_path, strlen(request->file_path), path, 512);
+	op->handle = CreateFile(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+#	else 
+	op->handle = CreateFile(request->file_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+#	endif 
+
+	if(op->handle == INVALID_HANDLE_VALUE) {
+		op->completion.error = (int)GetLastError();
+		return SMOL_FALSE;
+	}
+
+	LARGE_INTEGER file_size;
+	if(!GetFileSizeEx(op->handle, &file_size)) {
+		op->completion.error = (int)GetLastError();
+		smol__file_op_close(op);
+		return SMOL_FALSE;
+	}
+
+	if(!smol__file_op_setup(op, request, (smol_size_t)file_size.QuadPart)) {
+		op->completion.error = ERROR_NOT_ENOUGH_MEMORY;
+		smol__file_op_close(op);
+		return SMOL_FALSE;
+	}
+
+	return SMOL_TRUE;
+
+}
+
+static void smol__file_op_read(smol__file_op_t* op) {
+
+	BYTE* byte_ptr = (BYTE*)op->completion.buffer + op->completion.size;
+
+	while(op->remaining) {
+
+		OVERLAPPED overlapped = { 0 };
+		overlapped.Offset = (DWORD)(op->offset & 0xFFFFFFFF);
+		overlapped.OffsetHigh = (DWORD)((unsigned long long)op->offset >> 32);
+
+		DWORD bytes_read = 0;
+		DWORD bytes_to_read = op->remaining > 0x40000000 ? 0x40000000 : (DWORD)op->remaining;
+
+		if(!ReadFile(op->handle, byte_ptr, bytes_to_read, &bytes_read, &overlapped)) {
+			DWORD error = GetLastError();
+			if(error != ERROR_HANDLE_EOF) op->completion.error = (int)error;
+			break;
+		}
+
+		if(bytes_read == 0) 
+			break;
+
+		byte_ptr += bytes_read;
+		op->offset += bytes_read;
+		op->remaining -= bytes_read;
+		op->completion.size += bytes_read;
+
+	}
+
+}
+
+static void smol__file_op_close(smol__file_op_t* op) {
+	if(op->handle && op->handle != INVALID_HANDLE_VALUE) CloseHandle(op->handle);
+	op->handle = INVALID_HANDLE_VALUE;
+}
+
+int smol_map_file(const char* file_path, smol_file_view_t* view) {
+
+	memset(view, 0, sizeof(*view));
+
+#	ifdef UNICODE
+	wchar_t path[512] = { 0 };
+	MultiByteToWideChar(CP_UTF8, MB_COMPOSITE, file_path, strlen(file_path), path, 512);
+	HANDLE file = CreateFile(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+#	else 
+	HANDLE file = CreateFile(file_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+#	endif 
+
+	if(file == INVALID_HANDLE_VALUE) 
+		return SMOL_FALSE;
+
+	LARGE_INTEGER file_size;
+	if(!GetFileSizeEx(file, &file_size)) {
+		CloseHandle(file);
+		return SMOL_FALSE;
+	}
+
+	view->size = (smol_size_t)file_size.QuadPart;
+
+	//Zero length mappings aren't allowed
+	if(view->size == 0) {
+		CloseHandle(file);
+		view->data = "";
+		return SMOL_TRUE;
+	}
+
+	//The view keeps the mapping alive, so both handles can be closed right away.
+	HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+
+	if(mapping == NULL) 
+		return SMOL_FALSE;
+
+	view->data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+
+	return view->data != NULL;
+
+}
+
+void smol_unmap_file(smol_file_view_t* view) {
+
+	if(view->is_copy) {
+		SMOL_FREE((void*)view->data);
+	} else if(view->data && view->size) {
+		UnmapViewOfFile(view->data);
+	}
+
+	memset(view, 0, sizeof(*view));
+
+}
+
+void smol_file_view_advise(const smol_file_view_t* view, smol_size_t offset, smol_size_t size, smol_file_view_hint hint) {
+	//Only prefetching has a counterpart for file views on Windows.
+	if(hint == SMOL_FILE_VIEW_HINT_WILLNEED)
+		smol_file_view_prefetch(view, offset, size);
+}
+
+typedef struct _smol__win32_memory_range_t {
+	PVOID address;
+	SIZE_T size;
+} smol__win32_memory_range_t;
+
+typedef BOOL (WINAPI *smol__prefetch_virtual_memory_proc)(HANDLE, ULONG_PTR, smol__win32_memory_range_t*, ULONG);
+
+void smol_file_view_prefetch(const smol_file_view_t* view, smol_size_t offset, smol_size_t size) {
+
+	//PrefetchVirtualMemory is Windows 8+, so it's looked up at runtime
+	static smol__prefetch_virtual_memory_proc prefetch_virtual_memory = NULL;
+	static int looked_up = SMOL_FALSE;
+
+	if(!looked_up) {
+		HMODULE kernel32 = GetModuleHandleA("kernel32.dll");
+		if(kernel32) prefetch_virtual_memory = (smol__prefetch_virtual_memory_proc)GetProcAddress(kernel32, "PrefetchVirtualMemory");
+		looked_up = SMOL_TRUE;
+	}
+
+	if(view->is_copy || prefetch_virtual_memory == NULL || !smol__file_view_range(view, &offset, &size))
+		return;
+
+	smol__win32_memory_range_t range = { (PVOID)((const char*)view->data + offset), (SIZE_T)size };
+	prefetch_virtual_memory(GetCurrentProcess(), 1, &range, 0);
+
+}
+
+const char* smol_get_current_directory(void) {
+	
+	static char buffer[512] = { 0 };
+	
+#ifdef UNICODE 
+	{
+		wchar_t buf[512];
+		GetCurrentDirectory(512, buf);
+		BOOL subst = FALSE;
+		WideCharToMultiByte(CP_UTF8, 0, buf, lstrlenW(buf), buffer, 1024, "?", &subst);
+	}
+#else 
+	GetCurrentDirectory(512, buffer);
+#endif 
+	
+	return buffer;
 
 }
 
 int smol_change_directory(const char* dir) {
 
-#ifdef UNICODE
-	wchar_t path[512] = { 0 };
-	MultiByteToWideChar(CP_UTF8, MB_COMPOSITE, dir, strlen(dir), path, 512);
-#else 
-	const char* path = dir;
-#endif 
+#ifdef UNICODE
+	wchar_t path[512] = { 0 };
+	MultiByteToWideChar(CP_UTF8, MB_COMPOSITE, dir, strlen(dir), path, 512);
+#else 
+	const char* path = dir;
+#endif 
+
+	return SetCurrentDirectory(path);
+}
+
+static void smol__file_info_from_find_data(smol_file_info_t* info, const WIN32_FIND_DATA* file_data) {
+
+#ifdef UNICODE 
+	BOOL subst = FALSE;
+	if(!WideCharToMultiByte(CP_UTF8, 0, file_data->cFileName, -1, info->file_path, sizeof(info->file_path), "?", &subst))
+		info->file_path[sizeof(info->file_path) - 1] = '\0';
+#else 
+	smol__file_info_set_name(info, file_data->cFileName);
+#endif 
+	info->is_folder = (file_data->dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? SMOL_TRUE : SMOL_FALSE;
+
+}
+
+smol_file_scan_session_t smol_start_file_scan_session(smol_file_info_t* info) {
+
+	smol_file_scan_session_t session;
+	WIN32_FIND_DATA file_data;
+	session = (smol_file_scan_session_t)FindFirstFile(TEXT(".\\*"), &file_data);
+
+	if(session == INVALID_HANDLE_VALUE) 
+		return NULL;
+
+	smol__file_info_from_find_data(info, &file_data);
+
+	return session;
+}
+
+int smol_file_scan_session_next(smol_file_scan_session_t session, smol_file_info_t* info) {
+
+	WIN32_FIND_DATA file_data;
+	if(FindNextFile(session, &file_data) == FALSE) {
+		FindClose(session);
+		return SMOL_FALSE;
+	}
+
+	smol__file_info_from_find_data(info, &file_data);
+
+	return SMOL_TRUE;
+}
+
+//Builds "root\rel_path\*" as a wide string, the caller frees it.
+static wchar_t* smol__dir_scan_pattern(const smol__dir_scan_t* scan, const char* rel_path, int rel_length) {
+
+	int root_length = (int)strlen(scan->root_path);
+	int length = root_length + 1 + rel_length + 3;
+	char* path = (char*)SMOL_ALLOC(length);
+	wchar_t* wide_path = NULL;
+
+	if(path == NULL) 
+		return NULL;
+
+	memcpy(path, scan->root_path, root_length);
+	length = root_length;
+	if(length && path[length - 1] != '/' && path[length - 1] != '\\') 
+		path[length++] = '\\';
+	memcpy(path + length, rel_path, rel_length);
+	length += rel_length;
+	if(rel_length) 
+		path[length++] = '\\';
+	path[length++] = '*';
+	path[length] = '\0';
+
+	int wide_length = MultiByteToWideChar(CP_UTF8, 0, path, -1, NULL, 0);
+	if(wide_length > 0 && (wide_path = (wchar_t*)SMOL_ALLOC(wide_length * sizeof(wchar_t))) != NULL)
+		MultiByteToWideChar(CP_UTF8, 0, path, -1, wide_path, wide_length);
+
+	SMOL_FREE(path);
+
+	return wide_path;
+
+}
+
+static int smol__dir_scan_open_root(smol__dir_scan_t* scan, int* dir_fd) {
+
+	wchar_t* pattern = smol__dir_scan_pattern(scan, "", 0);
+	*dir_fd = -1;
+
+	if(pattern == NULL) 
+		return SMOL_FALSE;
+
+	//Strip the "*" to query the root folder itself.
+	pattern[wcslen(pattern) - 1] = L'\0';
+
+	DWORD attributes = GetFileAttributesW(pattern);
+	SMOL_FREE(pattern);
+
+	return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+
+}
+
+static void smol__dir_scan_release(int dir_fd) {
+	(void)dir_fd;
+}
+
+//FindFirstFileEx gives out the sizes and times with the names, so no separate stat is needed here.
+static void smol__dir_scan_folder(smol__dir_scan_t* scan, smol__dir_batch_t* batch, int dir_fd, const char* rel_path, int rel_length) {
+
+	WIN32_FIND_DATAW file_data;
+	char name[MAX_PATH * 3];
+	(void)dir_fd;
+
+	wchar_t* pattern = smol__dir_scan_pattern(scan, rel_path, rel_length);
+	if(pattern == NULL) 
+		return;
+
+	HANDLE find = FindFirstFileExW(pattern, FindExInfoBasic, &file_data, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+	SMOL_FREE(pattern);
+
+	if(find == INVALID_HANDLE_VALUE) 
+		return;
+
+	int recursive = scan->flags & SMOL_DIR_SCAN_RECURSIVE;
+	int want_stats = scan->flags & SMOL_DIR_SCAN_STATS;
+	int include_folders = scan->flags & SMOL_DIR_SCAN_INCLUDE_FOLDERS;
+
+	do {
+
+		const wchar_t* file_name = file_data.cFileName;
+		if(file_name[0] == L'.' && (file_name[1] == L'\0' || (file_name[1] == L'.' && file_name[2] == L'\0'))) 
+			continue;
+
+		int name_length = WideCharToMultiByte(CP_UTF8, 0, file_name, -1, name, sizeof(name), "?", NULL) - 1;
+		if(name_length <= 0) 
+			continue;
+
+		int is_folder = (file_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? SMOL_TRUE : SMOL_FALSE;
+
+		if(!is_folder || include_folders) {
+
+			//FILETIME counts 100ns intervals since 1601-01-01.
+			long long file_time = ((long long)file_data.ftLastWriteTime.dwHighDateTime << 32) | file_data.ftLastWriteTime.dwLowDateTime;
+
+			smol__dir_batch_add(
+				scan, batch, 
+				rel_path, rel_length, 
+				name, name_length, 
+				(want_stats && !is_folder) ? (smol_size_t)(((unsigned long long)file_data.nFileSizeHigh << 32) | file_data.nFileSizeLow) : 0,
+				want_stats ? (file_time - 116444736000000000LL) * 100 : 0,
+				is_folder
+			);
+
+		}
+
+		//Junctions and symbolic links aren't followed.
+		if(is_folder && recursive && !(file_data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) 
+			smol__dir_scan_subfolder(scan, batch, -1, rel_path, rel_length, name, name_length);
+
+	} while(FindNextFileW(find, &file_data));
+
+	FindClose(find);
+
+}
+
+void* smol_read_entire_file(const char* file_path, smol_size_t* size) {
+
+	void* buffer = NULL;
+
+#	ifdef UNICODE
+	wchar_t path[512] = { 0 };
+	MultiByteToWideChar(CP_UTF8, MB_COMPOSITE, file_path, strlen(file_path), path, 512);
+	HANDLE file = CreateFile(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+#	else 
+	HANDLE file = CreateFile(file_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+#endif 
+	
+	if(file == INVALID_HANDLE_VALUE) {
+		fprintf(stderr, "FILE '%s' NOT FOUND!\n", file_path);
+		return NULL;
+	}
+		
+	DWORD high = 0;
+	DWORD low = GetFileSize(file, &high);
+	*size = ((smol_size_t)low | ((smol_size_t)high << 32ULL));
+		
+	buffer = malloc(size[0]+1);
+		
+	BYTE* byte_ptr = (BYTE*)buffer;
+	DWORD bytes_to_read = *size;
+	DWORD bytes_read = 0;
+	while(ReadFile(file, byte_ptr, (bytes_to_read - bytes_read), &bytes_read, NULL) && bytes_to_read) {
+		byte_ptr += bytes_read;
+		bytes_to_read -= bytes_read;
+	}
+	*byte_ptr = 0;
+	CloseHandle(file);
+
+	return buffer;
+
+}
+
+#endif 
+
+#if defined(SMOL_PLATFORM_LINUX)
+
+#ifdef SMOL__HAS_IO_URING
+#	include <linux/io_uring.h>
+#	include <sys/syscall.h>
+long syscall(long number, ...);
+#endif 
+
+double smol_timer(void) {
+#ifdef SMOL__TIMESPEC_SHIM
+	struct { time_t tv_sec; long tv_nsec; } spec;
+	clock_gettime(CLOCK_MONOTONIC, (struct timespec*)&spec);
+#else 
+	struct timespec spec;
+	clock_gettime(CLOCK_MONOTONIC, &spec);
+#endif 
+	return (double)spec.tv_sec + (double)spec.tv_nsec * 1e-9;
+}
+
+typedef struct _smol__thread_start_t {
+	smol_thread_proc proc;
+	void* user_data;
+} smol__thread_start_t;
+
+static void* smol__thread_entry(void* param) {
+	smol__thread_start_t start = *(smol__thread_start_t*)param;
+	SMOL_FREE(param);
+	start.proc(start.user_data);
+	return NULL;
+}
+
+int smol_thread_create(smol_thread_t* thread, smol_thread_proc proc, void* user_data) {
+	smol__thread_start_t* start = (smol__thread_start_t*)SMOL_ALLOC(sizeof(smol__thread_start_t));
+	start->proc = proc;
+	start->user_data = user_data;
+	if(pthread_create(thread, NULL, &smol__thread_entry, start) != 0) {
+		SMOL_FREE(start);
+		return SMOL_FALSE;
+	}
+	return SMOL_TRUE;
+}
+
+void smol_thread_join(smol_thread_t thread) {
+	pthread_join(thread, NULL);
+}
+
+void smol_thread_yield(void) {
+	sched_yield();
+}
+
+void smol_mutex_init(smol_mutex_t* mutex) { pthread_mutex_init(mutex, NULL); }
+void smol_mutex_destroy(smol_mutex_t* mutex) { pthread_mutex_destroy(mutex); }
+void smol_mutex_lock(smol_mutex_t* mutex) { pthread_mutex_lock(mutex); }
+void smol_mutex_unlock(smol_mutex_t* mutex) { pthread_mutex_unlock(mutex); }
+
+void smol_cond_init(smol_cond_t* cond) { pthread_cond_init(cond, NULL); }
+void smol_cond_destroy(smol_cond_t* cond) { pthread_cond_destroy(cond); }
+void smol_cond_wait(smol_cond_t* cond, smol_mutex_t* mutex) { pthread_cond_wait(cond, mutex); }
+void smol_cond_signal(smol_cond_t* cond) { pthread_cond_signal(cond); }
+void smol_cond_broadcast(smol_cond_t* cond) { pthread_cond_broadcast(cond); }
+
+int smol_get_num_cpus(void) {
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
+}
+
+static int smol__file_op_open(smol__file_op_t* op, const smol_file_request_t* request) {
+
+	struct stat file_stat;
+
+	op->completion.file_path = request->file_path;
+	op->completion.user_data = request->user_data;
+
+	if((op->fd = open(request->file_path, O_RDONLY)) < 0) {
+		op->completion.error = errno;
+		return SMOL_FALSE;
+	}
+
+	if(fstat(op->fd, &file_stat) == -1) {
+		op->completion.error = errno;
+		smol__file_op_close(op);
+		return SMOL_FALSE;
+	}
+
+	if(!smol__file_op_setup(op, request, (smol_size_t)file_stat.st_size)) {
+		op->completion.error = ENOMEM;
+		smol__file_op_close(op);
+		return SMOL_FALSE;
+	}
+
+	return SMOL_TRUE;
+
+}
+
+static void smol__file_op_read(smol__file_op_t* op) {
+
+	unsigned char* byte_ptr = (unsigned char*)op->completion.buffer + op->completion.size;
+
+	//Every op has it's own descriptor, so seek + read is as good as pread here (and it's available in strict C99 mode too).
+	if(lseek(op->fd, (off_t)op->offset, SEEK_SET) == (off_t)-1) {
+		op->completion.error = errno;
+		return;
+	}
+
+	while(op->remaining) {
+
+		ssize_t bytes_read = read(op->fd, byte_ptr, op->remaining > 0x40000000 ? 0x40000000 : (size_t)op->remaining);
+
+		if(bytes_read < 0) {
+			if(errno == EINTR) continue;
+			op->completion.error = errno;
+			break;
+		}
+
+		if(bytes_read == 0) 
+			break;
+
+		byte_ptr += bytes_read;
+		op->offset += bytes_read;
+		op->remaining -= bytes_read;
+		op->completion.size += bytes_read;
+
+	}
+
+}
+
+static void smol__file_op_close(smol__file_op_t* op) {
+	if(op->fd >= 0) close(op->fd);
+	op->fd = -1;
+}
+
+#ifdef SMOL__HAS_IO_URING
+
+typedef struct _smol__io_uring_t {
+	int fd;
+	unsigned int entries;
+	unsigned int to_submit;
+	unsigned int* sq_head;
+	unsigned int* sq_tail;
+	unsigned int* sq_mask;
+	unsigned int* sq_array;
+	unsigned int* cq_head;
+	unsigned int* cq_tail;
+	unsigned int* cq_mask;
+	struct io_uring_sqe* sqes;
+	struct io_uring_cqe* cqes;
+	void* sq_ring;
+	void* cq_ring;
+	size_t sq_ring_size;
+	size_t cq_ring_size;
+	size_t sqes_size;
+	smol__file_op_t* ops;
+	int* free_ops;
+	int num_free;
+} smol__io_uring_t;
+
+static smol__io_uring_t* smol__io_uring_create(unsigned int entries) {
+
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	//Fails with ENOSYS on old kernels, and EPERM if it's disabled, the thread pool is used then.
+	int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+	if(fd < 0) 
+		return NULL;
+
+	smol__io_uring_t* ring = (smol__io_uring_t*)SMOL_ALLOC(sizeof(smol__io_uring_t));
+	memset(ring, 0, sizeof(*ring));
+
+	ring->fd = fd;
+	ring->entries = params.sq_entries;
+	ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	if(params.features & IORING_FEAT_SINGLE_MMAP) {
+		if(ring->cq_ring_size > ring->sq_ring_size) ring->sq_ring_size = ring->cq_ring_size;
+		ring->cq_ring_size = ring->sq_ring_size;
+	}
+
+	ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, IORING_OFF_SQ_RING);
+	ring->cq_ring = MAP_FAILED;
+	ring->sqes = (struct io_uring_sqe*)MAP_FAILED;
+
+	if(ring->sq_ring != MAP_FAILED) {
+		ring->cq_ring = (params.features & IORING_FEAT_SINGLE_MMAP) ? 
+			ring->sq_ring : 
+			mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, IORING_OFF_CQ_RING);
+		ring->sqes = (struct io_uring_sqe*)mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, IORING_OFF_SQES);
+	}
+
+	if(ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED || ring->sqes == (struct io_uring_sqe*)MAP_FAILED) {
+		smol__io_uring_destroy(ring);
+		return NULL;
+	}
+
+	char* sq = (char*)ring->sq_ring;
+	char* cq = (char*)ring->cq_ring;
+
+	ring->sq_head = (unsigned int*)(sq + params.sq_off.head);
+	ring->sq_tail = (unsigned int*)(sq + params.sq_off.tail);
+	ring->sq_mask = (unsigned int*)(sq + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned int*)(sq + params.sq_off.array);
+	ring->cq_head = (unsigned int*)(cq + params.cq_off.head);
+	ring->cq_tail = (unsigned int*)(cq + params.cq_off.tail);
+	ring->cq_mask = (unsigned int*)(cq + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+	ring->ops = (smol__file_op_t*)SMOL_ALLOC(sizeof(smol__file_op_t) * ring->entries);
+	ring->free_ops = (int*)SMOL_ALLOC(sizeof(int) * ring->entries);
+	for(unsigned int i = 0; i < ring->entries; i++)
+		ring->free_ops[ring->num_free++] = (int)(ring->entries - 1 - i);
+
+	return ring;
+
+}
+
+static void smol__io_uring_destroy(smol__io_uring_t* ring) {
+
+	if(ring->sqes && ring->sqes != (struct io_uring_sqe*)MAP_FAILED) munmap(ring->sqes, ring->sqes_size);
+	if(ring->cq_ring && ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring) munmap(ring->cq_ring, ring->cq_ring_size);
+	if(ring->sq_ring && ring->sq_ring != MAP_FAILED) munmap(ring->sq_ring, ring->sq_ring_size);
+	if(ring->ops) SMOL_FREE(ring->ops);
+	if(ring->free_ops) SMOL_FREE(ring->free_ops);
+
+	close(ring->fd);
+	SMOL_FREE(ring);
+
+}
+
+static void smol__io_uring_queue_read(smol__io_uring_t* ring, int slot) {
+
+	smol__file_op_t* op = &ring->ops[slot];
+	unsigned int tail = *ring->sq_tail;
+	unsigned int index = tail & *ring->sq_mask;
+	struct io_uring_sqe* sqe = &ring->sqes[index];
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = op->fd;
+	sqe->addr = (unsigned long long)(size_t)((char*)op->completion.buffer + op->completion.size);
+	sqe->len = (unsigned int)(op->remaining > 0x40000000 ? 0x40000000 : op->remaining);
+	sqe->off = op->offset;
+	sqe->user_data = (unsigned long long)slot;
+
+	ring->sq_array[index] = index;
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	ring->to_submit++;
+
+}
+
+static void smol__io_uring_finish(smol_file_loader_t* loader, smol__io_uring_t* ring, int slot) {
+	smol__file_op_close(&ring->ops[slot]);
+	smol__file_loader_complete(loader, &ring->ops[slot]);
+	ring->free_ops[ring->num_free++] = slot;
+}
+
+//The ring failed, so the reads that are still active are finished with plain reads
+static void smol__io_uring_abandon(smol_file_loader_t* loader, smol__io_uring_t* ring) {
+
+	int num_free = ring->num_free;
+
+	for(unsigned int slot = 0; slot < ring->entries; slot++) {
+
+		int is_free = SMOL_FALSE;
+		for(int i = 0; i < num_free && !is_free; i++)
+			is_free = ring->free_ops[i] == (int)slot;
+
+		if(is_free) 
+			continue;
+
+		smol__file_op_read(&ring->ops[slot]);
+		smol__io_uring_finish(loader, ring, (int)slot);
+
+	}
+
+	ring->to_submit = 0;
 
-	return SetCurrentDirectory(path);
 }
 
-smol_file_scan_session_t smol_start_file_scan_session(smol_file_info_t* info) {
+static void smol__file_loader_io_uring_proc(void* user_data) {
 
-	smol_file_scan_session_t session;
-	WIN32_FIND_DATA file_data;
-	session = (smol_file_scan_session_t)FindFirstFile(TEXT(".\\*"), &file_data);
+	smol_file_loader_t* loader = (smol_file_loader_t*)user_data;
+	smol__io_uring_t* ring = loader->ring;
+	smol_file_request_t request;
+	int active = 0;
 
-#ifdef UNICODE 
-	BOOL subst = FALSE;
-	WideCharToMultiByte(CP_UTF8, 0, file_data.cFileName, lstrlenW(file_data.cFileName), info->file_path, 512, "?", &subst);
-#else 
-	memcpy(info->file_path, file_data.cFileName, strlen(file_data.cFileName));
-#endif 
-	info->is_folder = (file_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? SMOL_TRUE : SMOL_FALSE;
+	for(;;) {
+
+		//Fill the free slots, but block for new requests only when the ring is idle. 
+		//NOTE: while reads are in flight, new requests are picked up after the next completion.
+		while(ring->num_free > 0 && smol__file_loader_next_request(loader, &request, active == 0)) {
+
+			int slot = ring->free_ops[--ring->num_free];
+			smol__file_op_t* op = &ring->ops[slot];
+			memset(op, 0, sizeof(*op));
+
+			if(!smol__file_op_open(op, &request) || op->remaining == 0) {
+				smol__io_uring_finish(loader, ring, slot);
+				continue;
+			}
+
+			smol__io_uring_queue_read(ring, slot);
+			active++;
+
+		}
+
+		if(active == 0) {
+			if(!smol_atomic_load(&loader->running)) break;
+			continue;
+		}
+
+		int submitted = (int)syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+		if(submitted < 0) {
+			if(errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+			//Fatal, carry on as a thread pool thread
+			smol__io_uring_abandon(loader, ring);
+			smol__file_loader_thread_proc(loader);
+			return;
+		}
+		ring->to_submit -= (unsigned int)submitted;
+
+		unsigned int head = *ring->cq_head;
+		unsigned int tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+		for(; head != tail; head++) {
+
+			struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+			int slot = (int)cqe->user_data;
+			int res = cqe->res;
+			smol__file_op_t* op = &ring->ops[slot];
+
+			if(res == -EINTR || res == -EAGAIN) {
+				smol__io_uring_queue_read(ring, slot);
+				continue;
+			}
+
+			if(res == -EINVAL || res == -EOPNOTSUPP) {
+				//IORING_OP_READ needs Linux 5.6, read it the old way.
+				smol__file_op_read(op);
+			} else if(res < 0) {
+				op->completion.error = -res;
+			} else if(res > 0) {
+				op->offset += res;
+				op->remaining -= res;
+				op->completion.size += res;
+				if(op->remaining) {
+					smol__io_uring_queue_read(ring, slot);
+					continue;
+				}
+			}
+
+			smol__io_uring_finish(loader, ring, slot);
+			active--;
+
+		}
+
+		__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+	}
 
-	return session;
 }
 
-int smol_file_scan_session_next(smol_file_scan_session_t session, smol_file_info_t* info) {
+#endif 
 
-	WIN32_FIND_DATA file_data;
-	if(FindNextFile(session, &file_data) == FALSE)
+int smol_map_file(const char* file_path, smol_file_view_t* view) {
+
+	struct stat file_stat;
+	memset(view, 0, sizeof(*view));
+
+	int fd = open(file_path, O_RDONLY);
+	if(fd < 0) 
 		return SMOL_FALSE;
 
-#ifdef UNICODE 
-	BOOL subst = FALSE;
-	WideCharToMultiByte(CP_UTF8, 0, file_data.cFileName, lstrlenW(file_data.cFileName), info->file_path, 512, "?", &subst);
-#else 
-	memcpy(info->file_path, file_data.cFileName, strlen(file_data.cFileName));
-#endif 
-	info->is_folder = (file_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? SMOL_TRUE : SMOL_FALSE;
+	if(fstat(fd, &file_stat) == -1) {
+		close(fd);
+		return SMOL_FALSE;
+	}
 
-	return SMOL_TRUE;
-}
+	view->size = (smol_size_t)file_stat.st_size;
 
-void* smol_read_entire_file(const char* file_path, smol_size_t* size) {
+	//Zero length mappings aren't allowed
+	if(view->size == 0) {
+		close(fd);
+		view->data = "";
+		return SMOL_TRUE;
+	}
 
-	void* buffer = NULL;
+	void* data = mmap(NULL, (size_t)view->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
 
-#	ifdef UNICODE
-	wchar_t path[512] = { 0 };
-	MultiByteToWideChar(CP_UTF8, MB_COMPOSITE, file_path, strlen(file_path), path, 512);
-	HANDLE file = CreateFile(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-#	else 
-	HANDLE file = CreateFile(file_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-#endif 
-	
-	if(file == INVALID_HANDLE_VALUE) {
-		fprintf(stderr, "FILE '%s' NOT FOUND!\n", file_path);
-		return NULL;
+	if(data == MAP_FAILED) {
+		view->data = smol_read_entire_file(file_path, &view->size);
+		view->is_copy = SMOL_TRUE;
+		return view->data != NULL;
 	}
-		
-	DWORD high = 0;
-	DWORD low = GetFileSize(file, &high);
-	*size = ((smol_size_t)low | ((smol_size_t)high << 32ULL));
-		
-	buffer = malloc(size[0]+1);
-		
-	BYTE* byte_ptr = (BYTE*)buffer;
-	DWORD bytes_to_read = *size;
-	DWORD bytes_read = 0;
-	while(ReadFile(file, byte_ptr, (bytes_to_read - bytes_read), &bytes_read, NULL) && bytes_to_read) {
-		byte_ptr += bytes_read;
-		bytes_to_read -= bytes_read;
+
+	view->data = data;
+	return SMOL_TRUE;
+
+}
+
+void smol_unmap_file(smol_file_view_t* view) {
+
+	if(view->is_copy) {
+		SMOL_FREE((void*)view->data);
+	} else if(view->data && view->size) {
+		munmap((void*)view->data, (size_t)view->size);
 	}
-	*byte_ptr = 0;
-	CloseHandle(file);
 
-	return buffer;
+	memset(view, 0, sizeof(*view));
 
 }
 
-#endif 
+void smol_file_view_advise(const smol_file_view_t* view, smol_size_t offset, smol_size_t size, smol_file_view_hint hint) {
 
-#if defined(SMOL_PLATFORM_LINUX)
+	if(view->is_copy || !smol__file_view_range(view, &offset, &size))
+		return;
 
-double smol_timer(void) {
-	struct timeval tval;
-	gettimeofday(&tval, NULL);
-	return (double)tval.tv_sec + (double)tval.tv_usec * 1e-6; 
+	static const int advice[] = { MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED, MADV_DONTNEED };
+
+	//madvise wants page aligned addresses
+	smol_size_t page_size = (smol_size_t)sysconf(_SC_PAGESIZE);
+	smol_size_t aligned = offset & ~(page_size - 1);
+
+	madvise((char*)view->data + aligned, (size_t)(size + (offset - aligned)), advice[hint]);
+
+}
+
+void smol_file_view_prefetch(const smol_file_view_t* view, smol_size_t offset, smol_size_t size) {
+	smol_file_view_advise(view, offset, size, SMOL_FILE_VIEW_HINT_WILLNEED);
 }
 
 const char* smol_get_current_directory(void) {
@@ -1035,18 +5510,36 @@ int smol_change_directory(const char* directory) {
 	return chdir(directory) == 0;
 }
 
+//Fills the info from the next entry, the type comes from d_type, stat is needed only if the file system doesn't provide it.
+static int smol__file_scan_session_read(DIR* dir, smol_file_info_t* info) {
+
+	struct dirent* ent;
+	if((ent = readdir(dir)) == NULL) 
+		return SMOL_FALSE;
+
+	smol__file_info_set_name(info, ent->d_name);
+
+	if(ent->d_type == DT_UNKNOWN || ent->d_type == DT_LNK) {
+		struct stat status;
+		info->is_folder = stat(ent->d_name, &status) == 0 && S_ISDIR(status.st_mode);
+	} else {
+		info->is_folder = ent->d_type == DT_DIR;
+	}
+
+	return SMOL_TRUE;
+
+}
+
 smol_file_scan_session_t smol_start_file_scan_session(smol_file_info_t* info) {
 
 	DIR* dir;
 	if((dir = opendir(".")) == NULL)
 		return NULL;
-	struct dirent* ent = readdir(dir);
-	if(ent == NULL) return NULL;
 
-	memcpy(info->file_path, ent->d_name, strlen(ent->d_name));
-	struct stat status;
-	stat(ent->d_name, &status);
-	info->is_folder = S_ISDIR(status.st_mode);
+	if(!smol__file_scan_session_read(dir, info)) {
+		closedir(dir);
+		return NULL;
+	}
 
 	return (smol_file_scan_session_t)dir;
 
@@ -1055,51 +5548,139 @@ smol_file_scan_session_t smol_start_file_scan_session(smol_file_info_t* info) {
 int smol_file_scan_session_next(smol_file_scan_session_t session, smol_file_info_t* info) {
 
 	DIR* dir = (DIR*)session;
-	struct dirent* ent;
 
-	if((ent = readdir(dir)) == NULL) {
+	if(!smol__file_scan_session_read(dir, info)) {
 		closedir(dir);
 		return SMOL_FALSE;
 	} 
 
-	memcpy(info->file_path, ent->d_name, strlen(ent->d_name));
+	return SMOL_TRUE; 
+}
+
+#if defined(O_DIRECTORY) && defined(O_CLOEXEC)
+#	define SMOL__DIR_OPEN_FLAGS (O_RDONLY | O_DIRECTORY | O_CLOEXEC)
+#else 
+#	define SMOL__DIR_OPEN_FLAGS O_RDONLY
+#endif 
+
+static long long smol__stat_mtime_ns(const struct stat* status) {
+#ifdef st_mtime //st_mtim is there, if st_mtime is a macro for it
+	return (long long)status->st_mtim.tv_sec * 1000000000LL + (long long)status->st_mtim.tv_nsec;
+#else 
+	return (long long)status->st_mtime * 1000000000LL;
+#endif 
+}
+
+static int smol__dir_scan_open_root(smol__dir_scan_t* scan, int* dir_fd) {
+
 	struct stat status;
-	stat(ent->d_name, &status);
-	info->is_folder = S_ISDIR(status.st_mode);
 
-	return SMOL_TRUE; 
+	if((*dir_fd = open(scan->root_path, SMOL__DIR_OPEN_FLAGS)) < 0) 
+		return SMOL_FALSE;
+
+	if(fstat(*dir_fd, &status) != 0 || !S_ISDIR(status.st_mode)) {
+		close(*dir_fd);
+		*dir_fd = -1;
+		return SMOL_FALSE;
+	}
+
+	return SMOL_TRUE;
+
 }
 
-void* smol_read_entire_file(const char* file_path, smol_size_t* size) {
+static void smol__dir_scan_release(int dir_fd) {
+	if(dir_fd >= 0) close(dir_fd);
+}
 
-	struct stat file_stat; 
-	void* buffer = NULL;
+//Everything is opened and stat'd relative to the folder's fd, so the kernel doesn't walk the full path for every entry.
+static void smol__dir_scan_folder(smol__dir_scan_t* scan, smol__dir_batch_t* batch, int dir_fd, const char* rel_path, int rel_length) {
 
-	int fd = open(file_path, O_RDONLY);
-	
-	if(!fd) return NULL;
+	DIR* dir = fdopendir(dir_fd);
+	struct dirent* ent;
 
-	if(fstat(fd, &file_stat) == -1) {
-		close(fd);
-		return NULL;
+	if(dir == NULL) {
+		close(dir_fd);
+		return;
 	}
 
-	buffer = malloc(file_stat.st_size+1);
-	unsigned char* byte_ptr = (unsigned char*)buffer;
+	int recursive = scan->flags & SMOL_DIR_SCAN_RECURSIVE;
+	int want_stats = scan->flags & SMOL_DIR_SCAN_STATS;
+	int include_folders = scan->flags & SMOL_DIR_SCAN_INCLUDE_FOLDERS;
+
+	while((ent = readdir(dir)) != NULL) {
+
+		const char* name = ent->d_name;
+		if(name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) 
+			continue;
+
+		struct stat status;
+		int has_status = SMOL_FALSE;
+		int type = ent->d_type;
+		int is_folder, descend;
+
+		if(type == DT_UNKNOWN) {
+			if(fstatat(dir_fd, name, &status, AT_SYMLINK_NOFOLLOW) != 0) 
+				continue;
+			type = S_ISLNK(status.st_mode) ? DT_LNK : S_ISDIR(status.st_mode) ? DT_DIR : DT_REG;
+			has_status = type != DT_LNK;
+		}
+
+		//Symbolic links are reported as what they point to, but never followed.
+		if(type == DT_LNK) {
+			if(fstatat(dir_fd, name, &status, 0) != 0) 
+				continue;
+			has_status = SMOL_TRUE;
+			is_folder = S_ISDIR(status.st_mode);
+			descend = SMOL_FALSE;
+		} else {
+			is_folder = type == DT_DIR;
+			descend = is_folder && recursive;
+		}
+
+		int name_length = (int)strlen(name);
+
+		if(!is_folder || include_folders) {
+			if(want_stats && !has_status) 
+				has_status = fstatat(dir_fd, name, &status, AT_SYMLINK_NOFOLLOW) == 0;
+			smol__dir_batch_add(
+				scan, batch, 
+				rel_path, rel_length, 
+				name, name_length, 
+				(want_stats && has_status && !is_folder) ? (smol_size_t)status.st_size : 0,
+				(want_stats && has_status) ? smol__stat_mtime_ns(&status) : 0,
+				is_folder
+			);
+		}
+
+		if(descend) {
+			int child_fd = openat(dir_fd, name, SMOL__DIR_OPEN_FLAGS);
+			if(child_fd >= 0) 
+				smol__dir_scan_subfolder(scan, batch, child_fd, rel_path, rel_length, name, name_length);
+		}
 
-	ssize_t bytes_to_read = file_stat.st_size;
-	ssize_t bytes_read;
-	while((bytes_read = read(fd, byte_ptr, bytes_to_read)) > 0 && bytes_to_read) {
-		byte_ptr += bytes_read;
-		bytes_to_read -= bytes_read;
 	}
 
-	close(fd);
+	closedir(dir);
 
-	*byte_ptr = 0;
+}
 
-	return buffer;
+void* smol_read_entire_file(const char* file_path, smol_size_t* size) {
+
+	smol_file_request_t request = { 0 };
+	smol__file_op_t op = { 0 };
 
+	request.file_path = file_path;
+
+	if(!smol__file_op_open(&op, &request)) 
+		return NULL;
+
+	smol__file_op_read(&op);
+	smol__file_op_close(&op);
+	smol__file_op_finish(&op);
+
+	if(size) *size = op.completion.size;
+
+	return op.completion.buffer;
 
 }
 
@@ -1108,29 +5689,88 @@ void* smol_read_entire_file(const char* file_path, smol_size_t* size) {
 
 #if defined(SMOL_PLATFORM_WEB)
 
-void* smol_read_entire_file(const char* file_path, smol_size_t* size) {
+#include <errno.h>
 
-	void* buffer = NULL;
+static int smol__file_op_open(smol__file_op_t* op, const smol_file_request_t* request) {
 
-	FILE* file = NULL;
-	if((file = fopen(file_path, "r")) != NULL) {
-		
-		fseek(file, 0, SEEK_END);
-		
-		smol_size_t size = ftell(file);
-		
-		fseek(file, 0, SEEK_SET);
-		
-		buffer = malloc(size+1);
-		fread((char*)buffer, 1, size, file);
+	op->completion.file_path = request->file_path;
+	op->completion.user_data = request->user_data;
 
-		fclose(file);
-		((char*)buffer)[size] = 0;
+	if((op->file = fopen(request->file_path, "rb")) == NULL) {
+		op->completion.error = errno;
+		return SMOL_FALSE;
 	}
 
+	fseek(op->file, 0, SEEK_END);
+	smol_size_t file_size = (smol_size_t)ftell(op->file);
 
-	return buffer;
+	if(!smol__file_op_setup(op, request, file_size)) {
+		op->completion.error = ENOMEM;
+		smol__file_op_close(op);
+		return SMOL_FALSE;
+	}
+
+	return SMOL_TRUE;
+
+}
+
+static void smol__file_op_read(smol__file_op_t* op) {
+
+	fseek(op->file, (long)op->offset, SEEK_SET);
+
+	size_t bytes_read = fread((char*)op->completion.buffer + op->completion.size, 1, (size_t)op->remaining, op->file);
+	if(bytes_read < op->remaining && ferror(op->file)) 
+		op->completion.error = EIO;
+
+	op->offset += bytes_read;
+	op->remaining -= bytes_read;
+	op->completion.size += bytes_read;
+
+}
+
+static void smol__file_op_close(smol__file_op_t* op) {
+	if(op->file) fclose(op->file);
+	op->file = NULL;
+}
+
+void* smol_read_entire_file(const char* file_path, smol_size_t* size) {
+
+	smol_file_request_t request = { 0 };
+	smol__file_op_t op = { 0 };
+
+	request.file_path = file_path;
+
+	if(!smol__file_op_open(&op, &request)) 
+		return NULL;
+
+	smol__file_op_read(&op);
+	smol__file_op_close(&op);
+	smol__file_op_finish(&op);
+
+	if(size) *size = op.completion.size;
+
+	return op.completion.buffer;
+
+}
+
+int smol_map_file(const char* file_path, smol_file_view_t* view) {
+	memset(view, 0, sizeof(*view));
+	view->data = smol_read_entire_file(file_path, &view->size);
+	view->is_copy = SMOL_TRUE;
+	return view->data != NULL;
+}
 
+void smol_unmap_file(smol_file_view_t* view) {
+	if(view->data) SMOL_FREE((void*)view->data);
+	memset(view, 0, sizeof(*view));
+}
+
+void smol_file_view_advise(const smol_file_view_t* view, smol_size_t offset, smol_size_t size, smol_file_view_hint hint) {
+	(void)view; (void)offset; (void)size; (void)hint;
+}
+
+void smol_file_view_prefetch(const smol_file_view_t* view, smol_size_t offset, smol_size_t size) {
+	(void)view; (void)offset; (void)size;
 }
 
 double smol_timer(void) {
@@ -1141,6 +5781,10 @@ double smol_timer(void) {
 
 
 
+int smol_get_num_cpus(void) {
+	return 1;
+}
+
 const char* smol_get_current_directory(void) {
 
 	static char buffer[512] = { 0 };
@@ -1154,7 +5798,7 @@ const char* smol_get_current_directory(void) {
 		var encodedString = encoder.encode(path);
 
 		var buffer = Module.HEAPU8.subarray(bufferPtr, bufferPtr + 512);
-		var byteLength = Math.min(encodedString.length, 512);
+		var byteLength = Math.min(encodedString.length, 511);
 
 		for(var i = 0; i < byteLength; i++) {
 			buffer[i] = encodedString[i];
@@ -1193,7 +5837,7 @@ smol_file_scan_session_t smol_start_file_scan_session(smol_file_info_t* info) {
 		var encodedString = encoder.encode(fileScanSession.files[fileScanSession.file_index]);
 
 		var buffer = Module.HEAPU8.subarray(bufferPtr, bufferPtr + 512);
-		var byteLength = Math.min(encodedString.length, 512);
+		var byteLength = Math.min(encodedString.length, 511);
 
 		for(var i = 0; i < byteLength && i < 512; i++) {
 			buffer[i] = encodedString[i];
@@ -1256,7 +5900,7 @@ int smol_file_scan_session_next(smol_file_scan_session_t session, smol_file_info
 		var encodedString = encoder.encode(session.files[session.file_index]);
 
 		var buffer = Module.HEAPU8.subarray(bufferPtr, bufferPtr + 512);
-		var byteLength = Math.min(encodedString.length, 512);
+		var byteLength = Math.min(encodedString.length, 511);
 		console.log(byteLength);
 
 		for(var i = 0; i < byteLength && i < 512; i++) {
@@ -1275,6 +5919,96 @@ int smol_file_scan_session_next(smol_file_scan_session_t session, smol_file_info
 	return finished;
 }
 
+#include <dirent.h>
+#include <sys/stat.h>
+
+//Joins the root and a relative path, the caller frees it.
+static char* smol__dir_scan_join(const smol__dir_scan_t* scan, const char* rel_path, int rel_length, const char* name) {
+
+	int root_length = (int)strlen(scan->root_path);
+	int name_length = name ? (int)strlen(name) : 0;
+	char* path = (char*)SMOL_ALLOC(root_length + rel_length + name_length + 3);
+	int length = root_length;
+
+	if(path == NULL) 
+		return NULL;
+
+	memcpy(path, scan->root_path, root_length);
+	if(rel_length) {
+		path[length++] = '/';
+		memcpy(path + length, rel_path, rel_length);
+		length += rel_length;
+	}
+	if(name_length) {
+		path[length++] = '/';
+		memcpy(path + length, name, name_length);
+		length += name_length;
+	}
+	path[length] = '\0';
+
+	return path;
+
+}
+
+static int smol__dir_scan_open_root(smol__dir_scan_t* scan, int* dir_fd) {
+	struct stat status;
+	*dir_fd = -1;
+	return stat(scan->root_path, &status) == 0 && S_ISDIR(status.st_mode);
+}
+
+static void smol__dir_scan_release(int dir_fd) {
+	(void)dir_fd;
+}
+
+static void smol__dir_scan_folder(smol__dir_scan_t* scan, smol__dir_batch_t* batch, int dir_fd, const char* rel_path, int rel_length) {
+
+	char* folder_path = smol__dir_scan_join(scan, rel_path, rel_length, NULL);
+	DIR* dir = folder_path ? opendir(folder_path) : NULL;
+	struct dirent* ent;
+	(void)dir_fd;
+
+	SMOL_FREE(folder_path);
+
+	if(dir == NULL) 
+		return;
+
+	while((ent = readdir(dir)) != NULL) {
+
+		const char* name = ent->d_name;
+		if(name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) 
+			continue;
+
+		char* path = smol__dir_scan_join(scan, rel_path, rel_length, name);
+		struct stat status;
+		int found = path && stat(path, &status) == 0;
+
+		SMOL_FREE(path);
+
+		if(!found) 
+			continue;
+
+		int is_folder = S_ISDIR(status.st_mode);
+		int name_length = (int)strlen(name);
+
+		if(!is_folder || (scan->flags & SMOL_DIR_SCAN_INCLUDE_FOLDERS)) 
+			smol__dir_batch_add(
+				scan, batch, 
+				rel_path, rel_length, 
+				name, name_length, 
+				is_folder ? 0 : (smol_size_t)status.st_size, 
+				(long long)status.st_mtime * 1000000000LL, 
+				is_folder
+			);
+
+		if(is_folder && (scan->flags & SMOL_DIR_SCAN_RECURSIVE)) 
+			smol__dir_scan_subfolder(scan, batch, -1, rel_path, rel_length, name, name_length);
+
+	}
+
+	closedir(dir);
+
+}
+
 #endif 
 
 #endif 